@@ -10,12 +10,14 @@
 #ifdef WIN32
 #define SSE_ALIGN __declspec(align(16))
 #define AVX_ALIGN __declspec(align(32))
+#define CACHE_ALIGN __declspec(align(64))
 
 #define constexpr
 #define noexcept throw()
 #else
 #define SSE_ALIGN alignas(16)
 #define AVX_ALIGN alignas(32)
+#define CACHE_ALIGN alignas(64)
 //#define constexpr
 #endif
 
@@ -32,6 +34,14 @@ namespace std_dsp {
 	double* get_ptr(double* x) {
 		return x;
 	}
+	inline
+	const float* get_ptr(const float* x) {
+		return x;
+	}
+	inline
+	float* get_ptr(float* x) {
+		return x;
+	}
 
 	template <typename I>
 	inline
@@ -51,6 +61,14 @@ namespace std_dsp {
 	bool supports_fast_processing(double*) {
 		return true;
 	}
+	inline
+	bool supports_fast_processing(const float*) {
+		return true;
+	}
+	inline
+	bool supports_fast_processing(float*) {
+		return true;
+	}
 
 	template <typename T1, typename T2>
 	inline
@@ -85,6 +103,22 @@ namespace std_dsp {
 	integer_t fast_reverse_count(double*, integer_t n) {
 		return n;
 	}
+	inline
+	integer_t fast_count(const float*, integer_t n) {
+		return n;
+	}
+	inline
+	integer_t fast_count(float*, integer_t n) {
+		return n;
+	}
+	inline
+	integer_t fast_reverse_count(const float*, integer_t n) {
+		return n;
+	}
+	inline
+	integer_t fast_reverse_count(float*, integer_t n) {
+		return n;
+	}
 /*
 	template <typename T>
 	inline
@@ -2,6 +2,8 @@
 #ifndef STD_DSP_COMPARE_GUARD
 #define STD_DSP_COMPARE_GUARD
 
+#include <cmath>
+
 namespace std_dsp {
 	template <typename I1, typename I2, typename N>
 	inline
@@ -6,9 +6,19 @@
 #define ALWAYS_INLINE __forceinline
 #define NEVER_INLINE __declspec(noinline)
 
+//MSVC accepts any intrinsic in any function, no per-function target is needed
+#define STD_DSP_TARGET_AVX2
+#define STD_DSP_TARGET_AVX512
+
 #else
 
 #define ALWAYS_INLINE inline __attribute__((__always_inline__))
 #define NEVER_INLINE __attribute__((__noinline__))
 
+//Marks a function as compiled for AVX2/FMA regardless of the global compiler flags,
+//so that wide kernels can live in a baseline build and be selected at runtime.
+//Such functions must only be reached through the dispatcher in std_dsp_cpu_features.h
+#define STD_DSP_TARGET_AVX2 __attribute__((__target__("avx2,fma")))
+#define STD_DSP_TARGET_AVX512 __attribute__((__target__("avx512f,avx512dq,avx2,fma")))
+
 #endif
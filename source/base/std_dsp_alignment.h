@@ -13,6 +13,10 @@ namespace std_dsp {
 	std::size_t get_alignment(const double* first) {
 		return reinterpret_cast<std::size_t>(first) & 15;
 	}
+	inline
+	std::size_t get_alignment(const float* first) {
+		return reinterpret_cast<std::size_t>(first) & 15;
+	}
 
 	template <typename I>
 	inline
@@ -54,6 +58,22 @@ namespace std_dsp {
 		return alignment1 == alignment2 && alignment1 == alignment3;
 	}
 
+	//Elements to process one at a time before first is aligned to ALIGNMENT bytes, at most n.
+	//first must be aligned to its element size, as any valid pointer is.
+	template <std::size_t ALIGNMENT, typename T, typename N>
+	inline
+	N alignment_head(const T* first, N n) {
+		const std::size_t misalignment = reinterpret_cast<std::size_t>(first) & (ALIGNMENT - 1);
+		const N head = misalignment ? N((ALIGNMENT - misalignment) / sizeof(T)) : N(0);
+		return head < n ? head : n;
+	}
+
+	template <std::size_t ALIGNMENT, typename T>
+	inline
+	bool is_aligned_to(const T* first) {
+		return (reinterpret_cast<std::size_t>(first) & (ALIGNMENT - 1)) == 0;
+	}
+
 	inline
 	std::pair<std::size_t, std::size_t> unroll_partition_2(std::size_t n) {
 		std::size_t n_remainder = n & 1;
@@ -3,14 +3,29 @@
 #define STD_DSP_COMPUTATIONAL_BASIS_GUARD
 
 #define STD_DSP_SSE
+#define STD_DSP_AVX
 
 #ifdef STD_DSP_SSE
 #include <emmintrin.h>
 #include <pmmintrin.h>
 #endif
 
+#ifdef STD_DSP_AVX
+#include <immintrin.h>
+#endif
+
+#include "defines.h"
 #include "std_dsp_mem.h"
 
+//The intrinsic types carry may_alias, which GCC drops with a warning wherever they are
+//template arguments. Under GCC the vector types are spelled without it; they convert to
+//and from the intrinsic types implicitly and their lanes still alias the element type.
+#if defined(__GNUC__) && !defined(__clang__)
+#define STD_DSP_VECTOR_TYPE(NAME, ELEMENT, BYTES, INTRINSIC) typedef ELEMENT NAME __attribute__((__vector_size__(BYTES)))
+#else
+#define STD_DSP_VECTOR_TYPE(NAME, ELEMENT, BYTES, INTRINSIC) using NAME = INTRINSIC
+#endif
+
 namespace std_dsp {
 	using scalar_t = double;
 
@@ -23,7 +38,7 @@ namespace std_dsp {
 	void store1(scalar_t* x, N n, scalar_t value) { *(x + n) = value; } 
 
 #ifdef STD_DSP_SSE
-	using double2_t = __m128d;
+	STD_DSP_VECTOR_TYPE(double2_t, double, 16, __m128d);
 
 	template <typename N>
 	inline
@@ -79,6 +94,8 @@ namespace std_dsp {
 	inline
 	double2_t multiply(double2_t x, double2_t y) { return _mm_mul_pd(x, y); }
 	inline
+	double2_t multiply_add(double2_t x, double2_t y, double2_t z) { return _mm_add_pd(_mm_mul_pd(x, y), z); }
+	inline
 	double2_t maximum(double2_t x, double2_t y) { return _mm_max_pd(x, y); }
 	inline
 	double2_t minimum(double2_t x, double2_t y) { return _mm_min_pd(x, y); }
@@ -87,7 +104,82 @@ namespace std_dsp {
 	inline
 	void swap(double2_t& x, double2_t& y) { double2_t tmp = x; x = y; y = tmp; }
 	inline
-	double2_t abs(double2_t x, double2_t sign_bit_mask) { return _mm_andnot_pd(x, sign_bit_mask); }
+	double2_t abs(double2_t x, double2_t sign_bit_mask) { return _mm_andnot_pd(sign_bit_mask, x); }
+
+	//
+	//  Single precision SSE basis. Loads and stores are overloaded on the pointer type,
+	//  the broadcasts and constants carry an f suffix since they cannot be told apart
+	//  from the double ones by their arguments.
+	//
+	STD_DSP_VECTOR_TYPE(float4_t, float, 16, __m128);
+
+	template <typename N>
+	inline
+	float4_t load4(const float* x, N n) { return _mm_load_ps(x + n); }
+
+	inline
+	float4_t load4u(const float* x) { return _mm_loadu_ps(x); }
+
+	template <typename N>
+	inline
+	float4_t load4u(const float* x, N n) { return _mm_loadu_ps(x + n); }
+
+	inline
+	float4_t load4f(float x) { return _mm_set1_ps(x); }
+
+	inline
+	void store4(float* x, float4_t value) { _mm_store_ps(x, value); }
+
+	template <typename N>
+	inline
+	void store4(float* x, N n, float4_t value) { _mm_store_ps(x + n, value); }
+
+	inline
+	void store4u(float* x, float4_t value) { _mm_storeu_ps(x, value); }
+
+	template <typename N>
+	inline
+	void store4u(float* x, N n, float4_t value) { _mm_storeu_ps(x + n, value); }
+
+	inline
+	float4_t zero4f() { return _mm_setzero_ps(); }
+	inline
+	float4_t negate(float4_t x) { return _mm_sub_ps(zero4f(), x); }
+	inline
+	float4_t add(float4_t x, float4_t y) { return _mm_add_ps(x, y); }
+	inline
+	float4_t subtract(float4_t x, float4_t y) { return _mm_sub_ps(x, y); }
+	inline
+	float4_t multiply(float4_t x, float4_t y) { return _mm_mul_ps(x, y); }
+	inline
+	float4_t multiply_add(float4_t x, float4_t y, float4_t z) { return _mm_add_ps(_mm_mul_ps(x, y), z); }
+	inline
+	float4_t maximum(float4_t x, float4_t y) { return _mm_max_ps(x, y); }
+	inline
+	float4_t minimum(float4_t x, float4_t y) { return _mm_min_ps(x, y); }
+	inline
+	float4_t abs(float4_t x, float4_t sign_bit_mask) { return _mm_andnot_ps(sign_bit_mask, x); }
+	inline
+	float4_t interleave_lo(float4_t x, float4_t y) { return _mm_unpacklo_ps(x, y); }
+	inline
+	float4_t interleave_hi(float4_t x, float4_t y) { return _mm_unpackhi_ps(x, y); }
+	//[x0, x2, y0, y2] and [x1, x3, y1, y3]
+	inline
+	float4_t even_lanes(float4_t x, float4_t y) { return _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0)); }
+	inline
+	float4_t odd_lanes(float4_t x, float4_t y) { return _mm_shuffle_ps(x, y, _MM_SHUFFLE(3, 1, 3, 1)); }
+	//Pairwise operations on interleaved stereo frames [l0, r0, l1, r1]
+	inline
+	float4_t rotate(float4_t x) { return _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1)); }
+	inline
+	float4_t duplicate_even(float4_t x) { return _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 2, 0, 0)); }
+	inline
+	float4_t duplicate_odd(float4_t x) { return _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 1, 1)); }
+	//Widening to double precision, used by the reductions which always accumulate in double
+	inline
+	double2_t lower_double(float4_t x) { return _mm_cvtps_pd(x); }
+	inline
+	double2_t upper_double(float4_t x) { return _mm_cvtps_pd(_mm_movehl_ps(x, x)); }
 #else
 	using double2_t = double[2];
 
@@ -99,6 +191,200 @@ namespace std_dsp {
 	inline
 	void store2(double* x, N n, double2_t value) { x[n] = value[0]; x[n+1] = value[1]; } 
 #endif
+
+#ifdef STD_DSP_AVX
+	//
+	//  AVX2/FMA basis. Compiled with a per-function target so that a baseline build
+	//  carries it; only reach it through the runtime dispatch (std_dsp_cpu_features.h).
+	//
+	STD_DSP_VECTOR_TYPE(double4_t, double, 32, __m256d);
+
+	template <typename N>
+	inline STD_DSP_TARGET_AVX2
+	double4_t load4(const scalar_t* x, N n) { return _mm256_load_pd(x + n); }
+
+	inline STD_DSP_TARGET_AVX2
+	double4_t load4u(const scalar_t* x) { return _mm256_loadu_pd(x); }
+
+	template <typename N>
+	inline STD_DSP_TARGET_AVX2
+	double4_t load4u(const scalar_t* x, N n) { return _mm256_loadu_pd(x + n); }
+
+	inline STD_DSP_TARGET_AVX2
+	double4_t load4(scalar_t x) { return _mm256_set1_pd(x); }
+
+	inline STD_DSP_TARGET_AVX2
+	void store4(scalar_t* x, double4_t value) { _mm256_store_pd(x, value); }
+
+	template <typename N>
+	inline STD_DSP_TARGET_AVX2
+	void store4(scalar_t* x, N n, double4_t value) { _mm256_store_pd(x + n, value); }
+
+	inline STD_DSP_TARGET_AVX2
+	void store4u(scalar_t* x, double4_t value) { _mm256_storeu_pd(x, value); }
+
+	template <typename N>
+	inline STD_DSP_TARGET_AVX2
+	void store4u(scalar_t* x, N n, double4_t value) { _mm256_storeu_pd(x + n, value); }
+
+	inline STD_DSP_TARGET_AVX2
+	double4_t zero4() { return _mm256_setzero_pd(); }
+	inline STD_DSP_TARGET_AVX2
+	double4_t negate(double4_t x) { return _mm256_sub_pd(zero4(), x); }
+	inline STD_DSP_TARGET_AVX2
+	double4_t add(double4_t x, double4_t y) { return _mm256_add_pd(x, y); }
+	inline STD_DSP_TARGET_AVX2
+	double4_t hadd(double4_t x, double4_t y) { return _mm256_hadd_pd(x, y); }
+	inline STD_DSP_TARGET_AVX2
+	double4_t subtract(double4_t x, double4_t y) { return _mm256_sub_pd(x, y); }
+	inline STD_DSP_TARGET_AVX2
+	double4_t multiply(double4_t x, double4_t y) { return _mm256_mul_pd(x, y); }
+	inline STD_DSP_TARGET_AVX2
+	double4_t multiply_add(double4_t x, double4_t y, double4_t z) { return _mm256_fmadd_pd(x, y, z); }
+	inline STD_DSP_TARGET_AVX2
+	double4_t maximum(double4_t x, double4_t y) { return _mm256_max_pd(x, y); }
+	inline STD_DSP_TARGET_AVX2
+	double4_t minimum(double4_t x, double4_t y) { return _mm256_min_pd(x, y); }
+	inline STD_DSP_TARGET_AVX2
+	double4_t abs(double4_t x, double4_t sign_bit_mask) { return _mm256_andnot_pd(sign_bit_mask, x); }
+	inline STD_DSP_TARGET_AVX2
+	double2_t lower_half(double4_t x) { return _mm256_castpd256_pd128(x); }
+	inline STD_DSP_TARGET_AVX2
+	double2_t upper_half(double4_t x) { return _mm256_extractf128_pd(x, 1); }
+
+	STD_DSP_VECTOR_TYPE(float8_t, float, 32, __m256);
+
+	template <typename N>
+	inline STD_DSP_TARGET_AVX2
+	float8_t load8(const float* x, N n) { return _mm256_load_ps(x + n); }
+
+	inline STD_DSP_TARGET_AVX2
+	float8_t load8u(const float* x) { return _mm256_loadu_ps(x); }
+
+	template <typename N>
+	inline STD_DSP_TARGET_AVX2
+	float8_t load8u(const float* x, N n) { return _mm256_loadu_ps(x + n); }
+
+	inline STD_DSP_TARGET_AVX2
+	float8_t load8f(float x) { return _mm256_set1_ps(x); }
+
+	template <typename N>
+	inline STD_DSP_TARGET_AVX2
+	void store8(float* x, N n, float8_t value) { _mm256_store_ps(x + n, value); }
+
+	inline STD_DSP_TARGET_AVX2
+	void store8u(float* x, float8_t value) { _mm256_storeu_ps(x, value); }
+
+	template <typename N>
+	inline STD_DSP_TARGET_AVX2
+	void store8u(float* x, N n, float8_t value) { _mm256_storeu_ps(x + n, value); }
+
+	inline STD_DSP_TARGET_AVX2
+	float8_t zero8f() { return _mm256_setzero_ps(); }
+	inline STD_DSP_TARGET_AVX2
+	float8_t negate(float8_t x) { return _mm256_sub_ps(zero8f(), x); }
+	inline STD_DSP_TARGET_AVX2
+	float8_t add(float8_t x, float8_t y) { return _mm256_add_ps(x, y); }
+	inline STD_DSP_TARGET_AVX2
+	float8_t subtract(float8_t x, float8_t y) { return _mm256_sub_ps(x, y); }
+	inline STD_DSP_TARGET_AVX2
+	float8_t multiply(float8_t x, float8_t y) { return _mm256_mul_ps(x, y); }
+	inline STD_DSP_TARGET_AVX2
+	float8_t multiply_add(float8_t x, float8_t y, float8_t z) { return _mm256_fmadd_ps(x, y, z); }
+	inline STD_DSP_TARGET_AVX2
+	float8_t maximum(float8_t x, float8_t y) { return _mm256_max_ps(x, y); }
+	inline STD_DSP_TARGET_AVX2
+	float8_t minimum(float8_t x, float8_t y) { return _mm256_min_ps(x, y); }
+	inline STD_DSP_TARGET_AVX2
+	float8_t abs(float8_t x, float8_t sign_bit_mask) { return _mm256_andnot_ps(sign_bit_mask, x); }
+	inline STD_DSP_TARGET_AVX2
+	double4_t lower_double(float8_t x) { return _mm256_cvtps_pd(_mm256_castps256_ps128(x)); }
+	inline STD_DSP_TARGET_AVX2
+	double4_t upper_double(float8_t x) { return _mm256_cvtps_pd(_mm256_extractf128_ps(x, 1)); }
+
+	//
+	//  AVX-512 basis. The mask type selects lanes for partial loads and stores,
+	//  which replaces the scalar head/tail loops in the AVX-512 kernels.
+	//
+	STD_DSP_VECTOR_TYPE(double8_t, double, 64, __m512d);
+	using mask8_t = __mmask8;
+
+	//GCC 12 fills the unused lanes of several AVX-512 intrinsics from a self-initialized
+	//_mm512_undefined_pd and reports it as uninitialized once they are inlined here
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+	template <typename N>
+	inline STD_DSP_TARGET_AVX512
+	double8_t load8(const scalar_t* x, N n) { return _mm512_load_pd(x + n); }
+
+	inline STD_DSP_TARGET_AVX512
+	double8_t load8u(const scalar_t* x) { return _mm512_loadu_pd(x); }
+
+	template <typename N>
+	inline STD_DSP_TARGET_AVX512
+	double8_t load8u(const scalar_t* x, N n) { return _mm512_loadu_pd(x + n); }
+
+	//Lanes outside the mask are set to zero and their memory is not touched
+	inline STD_DSP_TARGET_AVX512
+	double8_t load8u(const scalar_t* x, mask8_t mask) { return _mm512_maskz_loadu_pd(mask, x); }
+
+	inline STD_DSP_TARGET_AVX512
+	double8_t load8(scalar_t x) { return _mm512_set1_pd(x); }
+
+	template <typename N>
+	inline STD_DSP_TARGET_AVX512
+	void store8(scalar_t* x, N n, double8_t value) { _mm512_store_pd(x + n, value); }
+
+	inline STD_DSP_TARGET_AVX512
+	void store8u(scalar_t* x, double8_t value) { _mm512_storeu_pd(x, value); }
+
+	template <typename N>
+	inline STD_DSP_TARGET_AVX512
+	void store8u(scalar_t* x, N n, double8_t value) { _mm512_storeu_pd(x + n, value); }
+
+	//Only the lanes in the mask are written
+	inline STD_DSP_TARGET_AVX512
+	void store8u(scalar_t* x, mask8_t mask, double8_t value) { _mm512_mask_storeu_pd(x, mask, value); }
+
+	//Mask selecting the n lowest lanes, 0 <= n <= 8
+	template <typename N>
+	inline
+	mask8_t tail_mask8(N n) { return static_cast<mask8_t>((1u << static_cast<unsigned>(n)) - 1u); }
+
+	inline STD_DSP_TARGET_AVX512
+	double8_t zero8() { return _mm512_setzero_pd(); }
+	inline STD_DSP_TARGET_AVX512
+	double8_t negate(double8_t x) { return _mm512_sub_pd(zero8(), x); }
+	inline STD_DSP_TARGET_AVX512
+	double8_t add(double8_t x, double8_t y) { return _mm512_add_pd(x, y); }
+	inline STD_DSP_TARGET_AVX512
+	double8_t subtract(double8_t x, double8_t y) { return _mm512_sub_pd(x, y); }
+	inline STD_DSP_TARGET_AVX512
+	double8_t multiply(double8_t x, double8_t y) { return _mm512_mul_pd(x, y); }
+	inline STD_DSP_TARGET_AVX512
+	double8_t multiply_add(double8_t x, double8_t y, double8_t z) { return _mm512_fmadd_pd(x, y, z); }
+	inline STD_DSP_TARGET_AVX512
+	double8_t maximum(double8_t x, double8_t y) { return _mm512_max_pd(x, y); }
+	inline STD_DSP_TARGET_AVX512
+	double8_t minimum(double8_t x, double8_t y) { return _mm512_min_pd(x, y); }
+	inline STD_DSP_TARGET_AVX512
+	double8_t abs(double8_t x, double8_t sign_bit_mask) { return _mm512_andnot_pd(sign_bit_mask, x); }
+	//Lanes in the mask are taken from x, the others from y
+	inline STD_DSP_TARGET_AVX512
+	double8_t select(mask8_t mask, double8_t x, double8_t y) { return _mm512_mask_blend_pd(mask, y, x); }
+	inline STD_DSP_TARGET_AVX512
+	double4_t lower_half(double8_t x) { return _mm512_castpd512_pd256(x); }
+	inline STD_DSP_TARGET_AVX512
+	double4_t upper_half(double8_t x) { return _mm512_extractf64x4_pd(x, 1); }
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
 }
 
 #endif
@@ -0,0 +1,114 @@
+
+#ifndef STD_DSP_CPU_FEATURES_GUARD
+#define STD_DSP_CPU_FEATURES_GUARD
+
+#ifdef WIN32
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+#include "std_dsp_computational_basis.h"
+
+//
+//  Runtime instruction set selection.
+//
+//  The wide kernels are compiled into every build (see STD_DSP_TARGET_AVX2) and the
+//  algorithms pick the widest path the host supports on each call. The detected level
+//  is computed once; set_simd_level can lower it to benchmark or test the narrower paths.
+//
+
+namespace std_dsp {
+	//Ordered from narrowest to widest
+	enum class simd_level : int {
+		sse2 = 0,
+		avx2 = 1,
+		avx512 = 2
+	};
+
+	namespace detail {
+		inline
+		simd_level detect_simd_level() {
+#if !defined(STD_DSP_AVX)
+			return simd_level::sse2;
+#elif defined(WIN32)
+			int info[4];
+			__cpuid(info, 0);
+			if(info[0] < 7)
+				return simd_level::sse2;
+
+			__cpuid(info, 1);
+			const bool fma = (info[2] & (1 << 12)) != 0;
+			const bool osxsave = (info[2] & (1 << 27)) != 0;
+			const bool avx = (info[2] & (1 << 28)) != 0;
+			if(!fma || !osxsave || !avx)
+				return simd_level::sse2;
+
+			//The OS must save the ymm registers on context switches
+			if((_xgetbv(0) & 6) != 6)
+				return simd_level::sse2;
+
+			__cpuidex(info, 7, 0);
+			const bool avx2 = (info[1] & (1 << 5)) != 0;
+			const bool avx512f = (info[1] & (1 << 16)) != 0;
+			const bool avx512dq = (info[1] & (1 << 17)) != 0;
+			if(!avx2)
+				return simd_level::sse2;
+
+			//The OS must also save the opmask and zmm registers
+			if(!avx512f || !avx512dq || (_xgetbv(0) & 0xE6) != 0xE6)
+				return simd_level::avx2;
+			return simd_level::avx512;
+#elif defined(__GNUC__)
+			__builtin_cpu_init();
+			if(!__builtin_cpu_supports("avx2") || !__builtin_cpu_supports("fma"))
+				return simd_level::sse2;
+			if(!__builtin_cpu_supports("avx512f") || !__builtin_cpu_supports("avx512dq"))
+				return simd_level::avx2;
+			return simd_level::avx512;
+#else
+			return simd_level::sse2;
+#endif
+		}
+
+		inline
+		simd_level& simd_level_setting() {
+			static simd_level level = detect_simd_level();
+			return level;
+		}
+	}
+
+	//The widest instruction set supported by the host CPU and OS
+	inline
+	simd_level max_simd_level() {
+		static const simd_level level = detail::detect_simd_level();
+		return level;
+	}
+
+	//The instruction set the dispatching algorithms currently use
+	inline
+	simd_level active_simd_level() {
+		return detail::simd_level_setting();
+	}
+
+	//Restricts the dispatching algorithms to at most the given level.
+	//The level is clamped to what the host supports. Not synchronized,
+	//so do not call while other threads are processing.
+	inline
+	void set_simd_level(simd_level level) {
+		if(static_cast<int>(level) > static_cast<int>(max_simd_level()))
+			level = max_simd_level();
+		detail::simd_level_setting() = level;
+	}
+
+	inline
+	bool use_avx2() {
+		return static_cast<int>(active_simd_level()) >= static_cast<int>(simd_level::avx2);
+	}
+
+	inline
+	bool use_avx512() {
+		return static_cast<int>(active_simd_level()) >= static_cast<int>(simd_level::avx512);
+	}
+}
+
+#endif
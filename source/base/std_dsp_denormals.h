@@ -0,0 +1,94 @@
+
+#ifndef STD_DSP_DENORMALS_GUARD
+#define STD_DSP_DENORMALS_GUARD
+
+#include <xmmintrin.h>
+
+//
+//  Denormal handling in hardware.
+//
+//  Recursive filters and reverb tails decaying towards silence produce denormal numbers,
+//  which x86 handles in microcode at a large cost per operation. Flush to zero (FTZ)
+//  makes the SSE and AVX units write zero instead of a denormal result and denormals
+//  are zero (DAZ) makes them read denormal inputs as zero. Both are bits of MXCSR, which
+//  belongs to the thread.
+//
+//  {
+//      scoped_denormal_flush guard;
+//      ... process the block ...
+//  }
+//
+//  The guard sets both bits and puts the control bits of MXCSR back as it found them,
+//  so guards nest and a host's own setting survives.
+//
+//  The library also has software passes, undenormalize and the filter states zeroing
+//  values below 1e-15. They run by default; with
+//  set_undenormalize_policy(undenormalize_policy::unless_flushed) they return straight
+//  away on threads running with both bits set.
+//
+
+namespace std_dsp {
+	namespace detail {
+		static const unsigned int mxcsr_daz = 0x0040u;
+		static const unsigned int mxcsr_ftz = 0x8000u;
+		//The sticky exception flags, the rest of MXCSR is control
+		static const unsigned int mxcsr_status = 0x003Fu;
+	}
+
+	//True when this thread flushes denormal results and inputs to zero
+	inline
+	bool denormals_flushed() {
+		const unsigned int flags = detail::mxcsr_daz | detail::mxcsr_ftz;
+		return (_mm_getcsr() & flags) == flags;
+	}
+
+	class scoped_denormal_flush {
+	private:
+		unsigned int saved;
+	public:
+		scoped_denormal_flush() : saved(_mm_getcsr()) {
+			_mm_setcsr(saved | detail::mxcsr_daz | detail::mxcsr_ftz);
+		}
+		//Restores the control bits, keeping the exceptions raised in the scope
+		~scoped_denormal_flush() {
+			_mm_setcsr((saved & ~detail::mxcsr_status) | (_mm_getcsr() & detail::mxcsr_status));
+		}
+
+		scoped_denormal_flush(const scoped_denormal_flush&) = delete;
+		scoped_denormal_flush& operator=(const scoped_denormal_flush&) = delete;
+	};
+
+	enum class undenormalize_policy : int {
+		//Always run the software passes
+		always = 0,
+		//Skip them on threads that flush denormals in hardware
+		unless_flushed = 1
+	};
+
+	namespace detail {
+		inline
+		undenormalize_policy& undenormalize_policy_setting() {
+			static undenormalize_policy policy = undenormalize_policy::always;
+			return policy;
+		}
+	}
+
+	inline
+	undenormalize_policy active_undenormalize_policy() {
+		return detail::undenormalize_policy_setting();
+	}
+
+	//Not synchronized, set it before processing starts
+	inline
+	void set_undenormalize_policy(undenormalize_policy policy) {
+		detail::undenormalize_policy_setting() = policy;
+	}
+
+	//Whether a software undenormalize pass has anything to do on this thread
+	inline
+	bool undenormalize_needed() {
+		return active_undenormalize_policy() == undenormalize_policy::always || !denormals_flushed();
+	}
+}
+
+#endif
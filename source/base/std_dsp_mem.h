@@ -5,6 +5,8 @@
 #include <cstdint>
 #include <cstdlib>
 #include <cassert>
+#include <new>
+#include <type_traits>
 
 #ifdef WIN32
 #include <Windows.h>
@@ -15,15 +17,22 @@
 #include "base.h"
 
 namespace std_dsp {
+	//Bytes per cache line, the alignment of alloc_buf and of the first sample of every storage channel
+	static const std::size_t cache_line_size = 64;
+
 	template <typename N>
 	inline
 	double* alloc_buf(N n) {
 		assert(n >= N(0));
 
 #ifdef WIN32
-		double* x = static_cast<double*>(_aligned_malloc(static_cast<std::size_t>(n) * sizeof(double), 16));
+		double* x = static_cast<double*>(_aligned_malloc(static_cast<std::size_t>(n) * sizeof(double), cache_line_size));
 #else
-		double* x = static_cast<double*>(malloc(static_cast<std::size_t>(n) * sizeof(double)));
+		//malloc only guarantees the alignment of the largest scalar type
+		void* p = 0;
+		if(posix_memalign(&p, cache_line_size, static_cast<std::size_t>(n) * sizeof(double)) != 0)
+			p = 0;
+		double* x = static_cast<double*>(p);
 #endif
 
 		//If the underlying implementation returns zero rather than throwing an exception
@@ -43,6 +52,72 @@ namespace std_dsp {
 #endif
 	}
 
+	//
+	//  Allocators for dynamic_storage provide
+	//
+	//  double* allocate(integer_t n);
+	//  void deallocate(double* p, integer_t n);
+	//
+	//  where n is the physical size in samples. Blocks must be aligned to cache_line_size.
+	//  Allocators may carry state; storage copies its allocator on copy and move and
+	//  releases every block through the allocator that produced it.
+	//
+
+	struct heap_allocator {
+		inline
+		double* allocate(integer_t n) { return alloc_buf(n); }
+		inline
+		void deallocate(double* p, integer_t) { free_buf(p); }
+	};
+
+	//
+	//  Channel stride policies for static_storage and dynamic_storage.
+	//
+	//  stride(n) is the distance in samples between the first samples of adjacent channels
+	//  of n samples each, and fixed<N> the same as a compile time constant.
+	//
+
+	//Pads each channel to an even count, so every channel is 16 byte aligned but no more
+	struct even_stride {
+		inline
+		static integer_t stride(integer_t n) { return n + (n & 1); }
+
+		template <integer_t N>
+		struct fixed : std::integral_constant<integer_t, N + (N & 1)> {};
+	};
+
+	//Pads each channel to whole cache lines
+	struct cache_line_stride {
+		static const integer_t line = static_cast<integer_t>(cache_line_size / sizeof(double));
+
+		inline
+		static integer_t stride(integer_t n) { return (n + line - 1) & ~(line - 1); }
+
+		template <integer_t N>
+		struct fixed : std::integral_constant<integer_t, (N + line - 1) & ~(line - 1)> {};
+	};
+
+	//Pads each channel to whole cache lines, plus one more line when the stride is a multiple of 1 KiB.
+	//With power of two sizes the same sample of every channel would otherwise map to a handful of L1
+	//sets, and loads from one channel would alias with the stores to another at the same 4 KiB offset.
+	struct anti_aliasing_stride {
+		static const integer_t line = cache_line_stride::line;
+		static const integer_t period = static_cast<integer_t>(1024 / sizeof(double));
+
+		inline
+		static integer_t stride(integer_t n) {
+			const integer_t s = cache_line_stride::stride(n);
+			return (s != 0 && (s & (period - 1)) == 0) ? s + line : s;
+		}
+
+		template <integer_t N>
+		struct fixed : std::integral_constant<integer_t,
+			cache_line_stride::fixed<N>::value + ((cache_line_stride::fixed<N>::value != 0 && (cache_line_stride::fixed<N>::value & (period - 1)) == 0) ? line : 0)> {};
+	};
+
+	//Storage pads to cache lines unless anti_aliasing_stride is passed as the stride policy
+	using default_stride = cache_line_stride;
+
 	namespace detail {
 		template <typename N>
 		inline
@@ -52,18 +127,18 @@ namespace std_dsp {
 			return n;
 		}
 
+		template <typename STRIDE>
 		inline
-		integer_t calc_physical_size(integer_t ch, integer_t n) { return ch * make_even(n); }
+		integer_t calc_physical_size(integer_t ch, integer_t n) { return ch * STRIDE::stride(n); }
 
 		//CRTP static polymorphism base class for storage implementation
 
-		template <typename STORAGE>
+		template <typename STORAGE, typename STRIDE>
 		class storage_base {
 		private:
 			inline
 			integer_t channel_offset(integer_t channel) const {
-				static const integer_t STRIDE = detail::make_even(size());
-				return STRIDE * channel;
+				return stride() * channel;
 			}
 			inline
 			integer_t end_offset(integer_t channel) const {
@@ -78,6 +153,7 @@ namespace std_dsp {
 			using difference_type = integer_t;
 			using iterator = pointer;
 			using const_iterator = const_pointer;
+			using stride_policy = STRIDE;
 
 			//Interface to be provided by storage implementations (computational basis for storage types)
 			//Dispatch the overriding implementation with static polymorphism
@@ -93,8 +169,11 @@ namespace std_dsp {
 
 			//Implementation of common methods
 
+			//Distance in samples between the first samples of adjacent channels
+			inline
+			integer_t stride() const { return STRIDE::stride(size()); }
 			inline
-			integer_t physical_size() const { return calc_physical_size(channels(), size()); }
+			integer_t physical_size() const { return channels() * stride(); }
 
 			//Iterator range methods
 
@@ -147,10 +226,10 @@ namespace std_dsp {
 		};
 	}
 
-	template <integer_t CHANNELS, integer_t SIZE>
-	class static_storage : public detail::storage_base<static_storage<CHANNELS, SIZE>> {
+	template <integer_t CHANNELS, integer_t SIZE, typename STRIDE = default_stride>
+	class static_storage : public detail::storage_base<static_storage<CHANNELS, SIZE, STRIDE>, STRIDE> {
 	private:
-		SSE_ALIGN double data[CHANNELS * SIZE + ((SIZE & 1) == 1) * (CHANNELS - 1)];
+		CACHE_ALIGN double data[CHANNELS * STRIDE::template fixed<SIZE>::value];
 	public:
 		inline
 		double* get() { return data; }
@@ -162,8 +241,8 @@ namespace std_dsp {
 		integer_t size() const { return SIZE; }
 	};
 
-	template <integer_t CHANNELS>
-	class static_storage<CHANNELS, 0LL> : public detail::storage_base<static_storage<CHANNELS, 0LL>> {
+	template <integer_t CHANNELS, typename STRIDE>
+	class static_storage<CHANNELS, 0LL, STRIDE> : public detail::storage_base<static_storage<CHANNELS, 0LL, STRIDE>, STRIDE> {
 	public:
 		inline
 		double* get() { return nullptr; }
@@ -175,8 +254,8 @@ namespace std_dsp {
 		integer_t size() const { return 0LL; }
 	};
 
-	template <>
-	class static_storage<0LL, 0LL> : public detail::storage_base<static_storage<0LL, 0LL>>{
+	template <typename STRIDE>
+	class static_storage<0LL, 0LL, STRIDE> : public detail::storage_base<static_storage<0LL, 0LL, STRIDE>, STRIDE> {
 	public:
 		inline
 		double* get() { return nullptr; }
@@ -188,45 +267,51 @@ namespace std_dsp {
 		integer_t size() const { return 0LL; }
 	};
 
-	template <integer_t CHANNELS = 0LL>
-	class dynamic_storage : public detail::storage_base<dynamic_storage<CHANNELS>> {
+	template <integer_t CHANNELS = 0LL, typename STRIDE = default_stride, typename ALLOCATOR = heap_allocator>
+	class dynamic_storage : public detail::storage_base<dynamic_storage<CHANNELS, STRIDE, ALLOCATOR>, STRIDE> {
 	private:
 		double* data;
 		integer_t buf_size;
+		ALLOCATOR allocator;
 	public:
 		dynamic_storage() : data(nullptr), buf_size(0LL) {}
 		explicit dynamic_storage(integer_t n) : data(nullptr), buf_size(0LL) { resize(n); }
-		dynamic_storage(const dynamic_storage& x) {
-			data = nullptr;
+		explicit dynamic_storage(const ALLOCATOR& a) : data(nullptr), buf_size(0LL), allocator(a) {}
+		dynamic_storage(integer_t n, const ALLOCATOR& a) : data(nullptr), buf_size(0LL), allocator(a) { resize(n); }
+		dynamic_storage(const dynamic_storage& x) : data(nullptr), buf_size(0LL), allocator(x.allocator) {
 			resize(x.size());
-			copy_n(x.begin(), x.physical_size(), data);
+			std::copy_n(x.begin(), x.physical_size(), data);
 		}
-		dynamic_storage(dynamic_storage&& x) {
+		dynamic_storage(dynamic_storage&& x) : allocator(x.allocator) {
 			data = x.data;
 			buf_size = x.buf_size;
 			x.data = nullptr;
 			x.buf_size = 0LL;
 		}
 		~dynamic_storage() {
-			free_buf(data);
+			if(data != nullptr)
+				allocator.deallocate(data, this->physical_size());
 		}
 
 		dynamic_storage& operator=(const dynamic_storage& x) {
-			using std::swap;
 			dynamic_storage tmp(x);
-			swap(*this, tmp);
+			swap(tmp);
+			return *this;
 		}
 		dynamic_storage& operator=(dynamic_storage&& x) {
 			if(this == &x)
 				return *this;
 			
 			//Free allocated memory before moving in x's data
-			free_buf(data);
+			if(data != nullptr)
+				allocator.deallocate(data, this->physical_size());
 
 			data = x.data;
 			buf_size = x.buf_size;
+			allocator = x.allocator;
 			x.data = nullptr;
 			x.buf_size = 0LL;
+			return *this;
 		}
 
 		inline
@@ -234,6 +319,7 @@ namespace std_dsp {
 			using std::swap;
 			swap(data, x.data);
 			swap(buf_size, x.buf_size);
+			swap(allocator, x.allocator);
 		}
 
 		inline
@@ -244,37 +330,49 @@ namespace std_dsp {
 		integer_t channels() const { return CHANNELS; }
 		inline
 		integer_t size() const { return buf_size; }
+		inline
+		const ALLOCATOR& get_allocator() const { return allocator; }
 
 		inline
 		void resize(integer_t n) {
 			if(n == buf_size)
 				return;
 
-			double* p = alloc_buf(detail::calc_physical_size(channels(), n));
+			//Sizes that round to the same stride keep the block
+			const integer_t physical = detail::calc_physical_size<STRIDE>(channels(), n);
+			if(data != nullptr && physical == this->physical_size()) {
+				buf_size = n;
+				return;
+			}
+
+			double* p = physical != 0LL ? allocator.allocate(physical) : nullptr;
 			if(data != nullptr)
-				free_buf(data);
+				allocator.deallocate(data, this->physical_size());
 			data = p;
 			buf_size = n;
 		}
 	};
 
-	template <>
-	class dynamic_storage<0LL> : public detail::storage_base<dynamic_storage<0LL>> {
+	template <typename STRIDE, typename ALLOCATOR>
+	class dynamic_storage<0LL, STRIDE, ALLOCATOR> : public detail::storage_base<dynamic_storage<0LL, STRIDE, ALLOCATOR>, STRIDE> {
 	private:
 		double* data;
 		integer_t channel_count;
 		integer_t buf_size;
+		ALLOCATOR allocator;
 	public:
 		dynamic_storage() : data(nullptr), channel_count(0LL), buf_size(0LL) {}
 		dynamic_storage(integer_t ch, integer_t n) : data(nullptr), channel_count(0LL), buf_size(0LL) { resize(ch, n); }
-		dynamic_storage(const dynamic_storage& x) {
+		explicit dynamic_storage(const ALLOCATOR& a) : data(nullptr), channel_count(0LL), buf_size(0LL), allocator(a) {}
+		dynamic_storage(integer_t ch, integer_t n, const ALLOCATOR& a) : data(nullptr), channel_count(0LL), buf_size(0LL), allocator(a) { resize(ch, n); }
+		dynamic_storage(const dynamic_storage& x) : allocator(x.allocator) {
 			data = nullptr;
 			channel_count = 0LL;
 			buf_size = 0LL;
 			resize(x.channels(), x.size());
-			std::copy_n(x.begin(), x.channels() * x.size(), data);
+			std::copy_n(x.begin(), x.physical_size(), data);
 		}
-		dynamic_storage(dynamic_storage&& x) {
+		dynamic_storage(dynamic_storage&& x) : allocator(x.allocator) {
 			data = x.data;
 			channel_count = x.channel_count;
 			buf_size = x.buf_size;
@@ -284,24 +382,27 @@ namespace std_dsp {
 			x.buf_size = 0LL;
 		}
 		~dynamic_storage() {
-			free_buf(data);
+			if(data != nullptr)
+				allocator.deallocate(data, this->physical_size());
 		}
 
 		dynamic_storage& operator=(const dynamic_storage& x) {
-			using std::swap;
 			dynamic_storage tmp(x);
-			swap(*this, tmp);
+			swap(tmp);
+			return *this;
 		}
 		dynamic_storage& operator=(dynamic_storage&& x) {
 			if (this == &x)
 				return *this;
 			
 			//Free allocated memory before moving in x's data
-			free_buf(data);
+			if(data != nullptr)
+				allocator.deallocate(data, this->physical_size());
 
 			data = x.data;
 			channel_count = x.channel_count;
 			buf_size = x.buf_size;
+			allocator = x.allocator;
 			
 			//Clear x
 			x.data = nullptr;
@@ -316,6 +417,7 @@ namespace std_dsp {
 			swap(data, x.data);
 			swap(buf_size, x.buf_size);
 			swap(channel_count, x.channel_count);
+			swap(allocator, x.allocator);
 		}
 
 		inline
@@ -326,15 +428,24 @@ namespace std_dsp {
 		integer_t channels() const { return channel_count; }
 		inline
 		integer_t size() const { return buf_size; }
+		inline
+		const ALLOCATOR& get_allocator() const { return allocator; }
 
 		inline
 		void resize(integer_t ch, integer_t n) {
 			if (ch == channels() && n == buf_size)
 				return;
 
-			double* p = alloc_buf(detail::calc_physical_size(ch, n));
+			//Shapes that round to the same stride keep the block
+			const integer_t physical = detail::calc_physical_size<STRIDE>(ch, n);
+			if (data != nullptr && ch == channels() && physical == this->physical_size()) {
+				buf_size = n;
+				return;
+			}
+
+			double* p = physical != 0LL ? allocator.allocate(physical) : nullptr;
 			if (data != nullptr)
-				free_buf(data);
+				allocator.deallocate(data, this->physical_size());
 			data = p;
 			channel_count = ch;
 			buf_size = n;
@@ -346,9 +457,9 @@ namespace std_dsp {
 		}
 	};
 
-	template <integer_t CHANNELS>
+	template <integer_t CHANNELS, typename STRIDE, typename ALLOCATOR>
 	inline
-	void swap(dynamic_storage<CHANNELS>&x, dynamic_storage<CHANNELS>&y) {
+	void swap(dynamic_storage<CHANNELS, STRIDE, ALLOCATOR>& x, dynamic_storage<CHANNELS, STRIDE, ALLOCATOR>& y) {
 		x.swap(y);
 	}
 
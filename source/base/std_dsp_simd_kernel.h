@@ -0,0 +1,533 @@
+
+#ifndef STD_DSP_SIMD_KERNEL_GUARD
+#define STD_DSP_SIMD_KERNEL_GUARD
+
+#include <type_traits>
+#include <utility>
+
+#include "defines.h"
+#include "std_dsp_alignment.h"
+#include "std_dsp_computational_basis.h"
+
+//
+//  Width-generic SIMD kernels.
+//
+//  simd_kernel<V, UNROLL, ALIGNED_LOADS, ALIGNED_STORES> runs an operator over sequences UNROLL
+//  vectors of type V at a time, then one vector at a time, and returns how many elements it
+//  processed. The caller finishes the remainder with a narrower kernel, a masked tail or scalars.
+//
+//  The callers peel elements until the output is aligned to the vector size (see alignment_head),
+//  then store aligned and load aligned only when the inputs ended up aligned as well. Pointers
+//  at arbitrary element offsets thus always take the vector path.
+//
+//  vector_traits<V> supplies the lane count and the memory access of each vector type, so a new
+//  instruction set only needs a traits specialization and entry points compiled for its target.
+//  The kernels are force-inlined and have no target of their own; they are compiled for the target
+//  of the entry point they are inlined into.
+//
+//  unroll_factor<ALGORITHM, V> picks the unroll factor per algorithm and vector type. Specialize it
+//  to tune an algorithm for a machine, e.g.
+//
+//    template <> struct unroll_factor<algorithm_tags::unary_reduction, double4_t>
+//      : std::integral_constant<int, 8> {};
+//
+
+#if defined(__GNUC__) && !defined(__clang__)
+#define STD_DSP_UNROLL _Pragma("GCC unroll 16")
+#elif defined(__clang__)
+#define STD_DSP_UNROLL _Pragma("unroll")
+#else
+#define STD_DSP_UNROLL
+#endif
+
+//The kernels call the target specific accessors of vector_traits from functions without a target,
+//which GCC reports as an ABI change. They are always inlined into an entry point of the same target,
+//so no vector is ever passed across a function boundary.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace std_dsp {
+	template <typename V>
+	struct vector_traits;
+
+	template <>
+	struct vector_traits<double2_t> {
+		using scalar_type = double;
+		static const int lanes = 2;
+
+		//Aligned accesses go through load2/store2 so the iterators providing them work too
+		template <bool ALIGNED, typename I, typename N>
+		inline
+		static double2_t load(I x, N n) { return load(x, n, std::integral_constant<bool, ALIGNED>()); }
+		template <bool ALIGNED, typename O, typename N>
+		inline
+		static void store(O x, N n, double2_t value) { store(x, n, value, std::integral_constant<bool, ALIGNED>()); }
+		template <typename I, typename N>
+		inline
+		static double2_t load(I x, N n, std::true_type) { return load2(x, n); }
+		template <typename N>
+		inline
+		static double2_t load(const double* x, N n, std::false_type) { return load2u(x, n); }
+		template <typename O, typename N>
+		inline
+		static void store(O x, N n, double2_t value, std::true_type) { store2(x, n, value); }
+		template <typename N>
+		inline
+		static void store(double* x, N n, double2_t value, std::false_type) { store2u(x, n, value); }
+		template <typename Op>
+		inline
+		static double2_t get(Op& op) { return op.get2(); }
+	};
+
+	template <>
+	struct vector_traits<float4_t> {
+		using scalar_type = float;
+		static const int lanes = 4;
+
+		template <bool ALIGNED, typename N>
+		inline
+		static float4_t load(const float* x, N n) { return ALIGNED ? load4(x, n) : load4u(x, n); }
+		template <bool ALIGNED, typename N>
+		inline
+		static void store(float* x, N n, float4_t value) {
+			if(ALIGNED)
+				store4(x, n, value);
+			else
+				store4u(x, n, value);
+		}
+		template <typename Op>
+		inline
+		static float4_t get(Op& op) { return op.get4f(); }
+	};
+
+#ifdef STD_DSP_AVX
+	template <>
+	struct vector_traits<double4_t> {
+		using scalar_type = double;
+		static const int lanes = 4;
+
+		template <bool ALIGNED, typename N>
+		inline STD_DSP_TARGET_AVX2
+		static double4_t load(const double* x, N n) { return ALIGNED ? load4(x, n) : load4u(x, n); }
+		template <bool ALIGNED, typename N>
+		inline STD_DSP_TARGET_AVX2
+		static void store(double* x, N n, double4_t value) {
+			if(ALIGNED)
+				store4(x, n, value);
+			else
+				store4u(x, n, value);
+		}
+		template <typename Op>
+		inline STD_DSP_TARGET_AVX2
+		static double4_t get(Op& op) { return op.get4(); }
+	};
+
+	template <>
+	struct vector_traits<float8_t> {
+		using scalar_type = float;
+		static const int lanes = 8;
+
+		template <bool ALIGNED, typename N>
+		inline STD_DSP_TARGET_AVX2
+		static float8_t load(const float* x, N n) { return ALIGNED ? load8(x, n) : load8u(x, n); }
+		template <bool ALIGNED, typename N>
+		inline STD_DSP_TARGET_AVX2
+		static void store(float* x, N n, float8_t value) {
+			if(ALIGNED)
+				store8(x, n, value);
+			else
+				store8u(x, n, value);
+		}
+		template <typename Op>
+		inline STD_DSP_TARGET_AVX2
+		static float8_t get(Op& op) { return op.get8f(); }
+	};
+
+	//The only vector type with masked accesses, which the *_tail kernels need
+	template <>
+	struct vector_traits<double8_t> {
+		using scalar_type = double;
+		using mask_type = mask8_t;
+		static const int lanes = 8;
+
+		template <bool ALIGNED, typename N>
+		inline STD_DSP_TARGET_AVX512
+		static double8_t load(const double* x, N n) { return ALIGNED ? load8(x, n) : load8u(x, n); }
+		template <bool ALIGNED, typename N>
+		inline STD_DSP_TARGET_AVX512
+		static void store(double* x, N n, double8_t value) {
+			if(ALIGNED)
+				store8(x, n, value);
+			else
+				store8u(x, n, value);
+		}
+		inline STD_DSP_TARGET_AVX512
+		static double8_t load(const double* x, mask8_t mask) { return load8u(x, mask); }
+		inline STD_DSP_TARGET_AVX512
+		static void store(double* x, mask8_t mask, double8_t value) { store8u(x, mask, value); }
+		template <typename N>
+		inline
+		static mask8_t tail_mask(N n) { return tail_mask8(n); }
+		template <typename Op>
+		inline STD_DSP_TARGET_AVX512
+		static double8_t get(Op& op) { return op.get8(); }
+	};
+#endif
+
+	//Stands in for a vector type an element type has no support for at some level,
+	//no operator accepts it so the detection traits turn that level off
+	struct no_vector {};
+
+	//The vector type of each instruction set level for an element type
+	template <typename T>
+	struct vector_types {
+		using sse = no_vector;
+		using avx2 = no_vector;
+		using avx512 = no_vector;
+	};
+
+	template <>
+	struct vector_types<double> {
+		using sse = double2_t;
+#ifdef STD_DSP_AVX
+		using avx2 = double4_t;
+		using avx512 = double8_t;
+#else
+		using avx2 = no_vector;
+		using avx512 = no_vector;
+#endif
+	};
+
+	template <>
+	struct vector_types<float> {
+		using sse = float4_t;
+#ifdef STD_DSP_AVX
+		using avx2 = float8_t;
+#else
+		using avx2 = no_vector;
+#endif
+		using avx512 = no_vector;
+	};
+
+	namespace algorithm_tags {
+		struct unary_reduction {};
+		struct unary_inplace_transform_and_reduce {};
+		struct copy_transform {};
+		struct binary_transform {};
+		struct ternary_transform {};
+		struct generate {};
+		struct stereo_transform {};
+	}
+
+	//Number of vectors per iteration of the unrolled loop
+	template <typename ALGORITHM, typename V>
+	struct unroll_factor : std::integral_constant<int, 4> {};
+
+	template <typename V, int UNROLL, bool ALIGNED_LOADS = false, bool ALIGNED_STORES = ALIGNED_LOADS>
+	struct simd_kernel {
+		static_assert(UNROLL >= 1, "Unroll factor must be at least 1.");
+
+		using traits = vector_traits<V>;
+		using scalar_type = typename traits::scalar_type;
+
+		static const int lanes = traits::lanes;
+		static const int step = lanes * UNROLL;
+
+		//The largest multiple of the lane count not greater than n
+		template <typename N>
+		ALWAYS_INLINE
+		static N vector_count(N n) {
+			return n & ~N(lanes - 1);
+		}
+
+		template <typename I, typename N, typename Op>
+		ALWAYS_INLINE
+		static N reduce(I first, N n, Op& op) {
+			const N vector_n = vector_count(n);
+			N remaining = vector_n;
+			while(remaining >= N(step)) {
+				V x[UNROLL];
+				STD_DSP_UNROLL
+				for(int u = 0; u < UNROLL; ++u)
+					x[u] = traits::template load<ALIGNED_LOADS>(first, u * lanes);
+
+				first += step;
+				remaining -= step;
+
+				STD_DSP_UNROLL
+				for(int u = 0; u < UNROLL; ++u)
+					op(x[u]);
+			}
+
+			while(remaining) {
+				remaining -= lanes;
+				op(traits::template load<ALIGNED_LOADS>(first, 0));
+				first += lanes;
+			}
+			return vector_n;
+		}
+
+		template <typename I, typename N, typename O, typename Op>
+		ALWAYS_INLINE
+		static N transform(I first, N n, O out, Op& op) {
+			const N vector_n = vector_count(n);
+			N remaining = vector_n;
+			while(remaining >= N(step)) {
+				V x[UNROLL];
+				STD_DSP_UNROLL
+				for(int u = 0; u < UNROLL; ++u)
+					x[u] = traits::template load<ALIGNED_LOADS>(first, u * lanes);
+
+				remaining -= step;
+
+				STD_DSP_UNROLL
+				for(int u = 0; u < UNROLL; ++u)
+					x[u] = op(x[u]);
+
+				STD_DSP_UNROLL
+				for(int u = 0; u < UNROLL; ++u)
+					traits::template store<ALIGNED_STORES>(out, u * lanes, x[u]);
+
+				first += step;
+				out += step;
+			}
+
+			while(remaining) {
+				remaining -= lanes;
+				traits::template store<ALIGNED_STORES>(out, 0, op(traits::template load<ALIGNED_LOADS>(first, 0)));
+				first += lanes;
+				out += lanes;
+			}
+			return vector_n;
+		}
+
+		template <typename I1, typename I2, typename N, typename O, typename Op>
+		ALWAYS_INLINE
+		static N transform(I1 first1, I2 first2, N n, O out, Op& op) {
+			const N vector_n = vector_count(n);
+			N remaining = vector_n;
+			while(remaining >= N(step)) {
+				V x1[UNROLL];
+				V x2[UNROLL];
+				STD_DSP_UNROLL
+				for(int u = 0; u < UNROLL; ++u) {
+					x1[u] = traits::template load<ALIGNED_LOADS>(first1, u * lanes);
+					x2[u] = traits::template load<ALIGNED_LOADS>(first2, u * lanes);
+				}
+
+				remaining -= step;
+
+				STD_DSP_UNROLL
+				for(int u = 0; u < UNROLL; ++u)
+					x1[u] = op(x1[u], x2[u]);
+
+				STD_DSP_UNROLL
+				for(int u = 0; u < UNROLL; ++u)
+					traits::template store<ALIGNED_STORES>(out, u * lanes, x1[u]);
+
+				first1 += step;
+				first2 += step;
+				out += step;
+			}
+
+			while(remaining) {
+				remaining -= lanes;
+				traits::template store<ALIGNED_STORES>(out, 0, op(traits::template load<ALIGNED_LOADS>(first1, 0), traits::template load<ALIGNED_LOADS>(first2, 0)));
+				first1 += lanes;
+				first2 += lanes;
+				out += lanes;
+			}
+			return vector_n;
+		}
+
+		template <typename I1, typename I2, typename I3, typename N, typename O, typename Op>
+		ALWAYS_INLINE
+		static N transform(I1 first1, I2 first2, I3 first3, N n, O out, Op& op) {
+			const N vector_n = vector_count(n);
+			N remaining = vector_n;
+			while(remaining >= N(step)) {
+				V x1[UNROLL];
+				V x2[UNROLL];
+				V x3[UNROLL];
+				STD_DSP_UNROLL
+				for(int u = 0; u < UNROLL; ++u) {
+					x1[u] = traits::template load<ALIGNED_LOADS>(first1, u * lanes);
+					x2[u] = traits::template load<ALIGNED_LOADS>(first2, u * lanes);
+					x3[u] = traits::template load<ALIGNED_LOADS>(first3, u * lanes);
+				}
+
+				remaining -= step;
+
+				STD_DSP_UNROLL
+				for(int u = 0; u < UNROLL; ++u)
+					x1[u] = op(x1[u], x2[u], x3[u]);
+
+				STD_DSP_UNROLL
+				for(int u = 0; u < UNROLL; ++u)
+					traits::template store<ALIGNED_STORES>(out, u * lanes, x1[u]);
+
+				first1 += step;
+				first2 += step;
+				first3 += step;
+				out += step;
+			}
+
+			while(remaining) {
+				remaining -= lanes;
+				traits::template store<ALIGNED_STORES>(out, 0, op(traits::template load<ALIGNED_LOADS>(first1, 0), traits::template load<ALIGNED_LOADS>(first2, 0), traits::template load<ALIGNED_LOADS>(first3, 0)));
+				first1 += lanes;
+				first2 += lanes;
+				first3 += lanes;
+				out += lanes;
+			}
+			return vector_n;
+		}
+
+		//Two inputs to two outputs, op maps std::pair<V, V> to std::pair<V, V>
+		template <typename I1, typename I2, typename N, typename O1, typename O2, typename Op>
+		ALWAYS_INLINE
+		static N transform_pair(I1 first1, I2 first2, N n, O1 out1, O2 out2, Op& op) {
+			const N vector_n = vector_count(n);
+			N remaining = vector_n;
+			while(remaining >= N(step)) {
+				std::pair<V, V> x[UNROLL];
+				STD_DSP_UNROLL
+				for(int u = 0; u < UNROLL; ++u)
+					x[u] = std::make_pair(traits::template load<ALIGNED_LOADS>(first1, u * lanes), traits::template load<ALIGNED_LOADS>(first2, u * lanes));
+
+				remaining -= step;
+				first1 += step;
+				first2 += step;
+
+				STD_DSP_UNROLL
+				for(int u = 0; u < UNROLL; ++u)
+					x[u] = op(x[u]);
+
+				STD_DSP_UNROLL
+				for(int u = 0; u < UNROLL; ++u) {
+					traits::template store<ALIGNED_STORES>(out1, u * lanes, x[u].first);
+					traits::template store<ALIGNED_STORES>(out2, u * lanes, x[u].second);
+				}
+
+				out1 += step;
+				out2 += step;
+			}
+
+			while(remaining) {
+				remaining -= lanes;
+				const std::pair<V, V> r = op(std::make_pair(traits::template load<ALIGNED_LOADS>(first1, 0), traits::template load<ALIGNED_LOADS>(first2, 0)));
+				traits::template store<ALIGNED_STORES>(out1, 0, r.first);
+				traits::template store<ALIGNED_STORES>(out2, 0, r.second);
+				first1 += lanes;
+				first2 += lanes;
+				out1 += lanes;
+				out2 += lanes;
+			}
+			return vector_n;
+		}
+
+		//Fills with the vectors of a generator, see generator_functors
+		template <typename N, typename O, typename Op>
+		ALWAYS_INLINE
+		static N generate(N n, O out, Op& op) {
+			const N vector_n = vector_count(n);
+			N remaining = vector_n;
+			if(op.is_const()) {
+				const V x = traits::get(op);
+				while(remaining >= N(step)) {
+					remaining -= step;
+
+					STD_DSP_UNROLL
+					for(int u = 0; u < UNROLL; ++u)
+						traits::template store<ALIGNED_STORES>(out, u * lanes, x);
+
+					out += step;
+				}
+
+				while(remaining) {
+					remaining -= lanes;
+					traits::template store<ALIGNED_STORES>(out, 0, x);
+					out += lanes;
+				}
+			} else {
+				while(remaining >= N(step)) {
+					remaining -= step;
+
+					V x[UNROLL];
+					STD_DSP_UNROLL
+					for(int u = 0; u < UNROLL; ++u)
+						x[u] = traits::get(op);
+
+					STD_DSP_UNROLL
+					for(int u = 0; u < UNROLL; ++u)
+						traits::template store<ALIGNED_STORES>(out, u * lanes, x[u]);
+
+					out += step;
+				}
+
+				while(remaining) {
+					remaining -= lanes;
+					traits::template store<ALIGNED_STORES>(out, 0, traits::get(op));
+					out += lanes;
+				}
+			}
+			return vector_n;
+		}
+
+		//
+		//  Masked tails, fewer than lanes elements in a single partial vector.
+		//  Only for vector types whose traits have a mask_type.
+		//
+
+		template <typename N, typename Op>
+		ALWAYS_INLINE
+		static void reduce_tail(const scalar_type* first, N n, Op& op) {
+			const typename traits::mask_type mask = traits::tail_mask(n);
+			op(mask, traits::load(first, mask));
+		}
+
+		template <typename N, typename Op>
+		ALWAYS_INLINE
+		static void transform_tail(const scalar_type* first, N n, scalar_type* out, Op& op) {
+			const typename traits::mask_type mask = traits::tail_mask(n);
+			traits::store(out, mask, op(traits::load(first, mask)));
+		}
+
+		//Like transform_tail, but op also gets the mask so it can leave the other lanes out of a reduction
+		template <typename N, typename Op>
+		ALWAYS_INLINE
+		static void transform_and_reduce_tail(scalar_type* first, N n, Op& op) {
+			const typename traits::mask_type mask = traits::tail_mask(n);
+			traits::store(first, mask, op(mask, traits::load(first, mask)));
+		}
+
+		template <typename N, typename Op>
+		ALWAYS_INLINE
+		static void transform_tail(const scalar_type* first1, const scalar_type* first2, N n, scalar_type* out, Op& op) {
+			const typename traits::mask_type mask = traits::tail_mask(n);
+			traits::store(out, mask, op(traits::load(first1, mask), traits::load(first2, mask)));
+		}
+
+		template <typename N, typename Op>
+		ALWAYS_INLINE
+		static void transform_tail(const scalar_type* first1, const scalar_type* first2, const scalar_type* first3,
+			N n, scalar_type* out, Op& op) {
+			const typename traits::mask_type mask = traits::tail_mask(n);
+			traits::store(out, mask, op(traits::load(first1, mask), traits::load(first2, mask), traits::load(first3, mask)));
+		}
+
+		template <typename N, typename Op>
+		ALWAYS_INLINE
+		static void generate_tail(N n, scalar_type* out, Op& op) {
+			traits::store(out, traits::tail_mask(n), traits::get(op));
+		}
+	};
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif
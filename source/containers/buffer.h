@@ -6,9 +6,12 @@
 #include <algorithm>
 
 #include "../base/std_dsp_mem.h"
+#include "../memory/buffer_pool.h"
 #include "../iterators/channel_iterator.h"
 
 #include "../stateless_algorithms/mono.h"
+#include "../range/range.h"
+#include "../range/view_algorithms.h"
 
 namespace std_dsp {
 	template <typename STORAGE>
@@ -27,22 +30,25 @@ namespace std_dsp {
 
 		buffer_t() {}
 		explicit buffer_t(difference_type n) { storage.resize(n); }
+		//For storage with an allocator
+		template <typename ALLOCATOR>
+		buffer_t(difference_type n, const ALLOCATOR& allocator) : storage(n, allocator) {}
 
 		inline
 		channel_iterator<const_pointer> cbegin() const {
-			return make_channel_iterator(storage.cbegin(), storage.size());
+			return make_channel_iterator(storage.cbegin(), storage.stride(), storage.size());
 		}
 		inline
 		channel_iterator<const_pointer> cend() const {
-			return make_channel_iterator(storage.cend(), storage.size());
+			return make_channel_iterator(storage.cbegin(storage.channels()), storage.stride(), storage.size());
 		}
 		inline
 		channel_iterator<pointer> begin() {
-			return make_channel_iterator(storage.begin(), storage.size());
+			return make_channel_iterator(storage.begin(), storage.stride(), storage.size());
 		}
 		inline
 		channel_iterator<pointer> end() {
-			return make_channel_iterator(storage.end(), storage.size());
+			return make_channel_iterator(storage.begin(storage.channels()), storage.stride(), storage.size());
 		}
 		inline
 		channel_iterator<const_pointer> begin() const {
@@ -96,43 +102,36 @@ namespace std_dsp {
 		inline
 		difference_type capacity() const { return storage.size(); }
 
+		//Non-owning view of all channels
+
+		inline
+		buffer_view<double> view() { return make_view(storage); }
+		inline
+		buffer_view<const double> view() const { return make_view(storage); }
+		inline
+		buffer_view<const double> cview() const { return make_view(storage); }
+
 		//Utility methods
 
 		inline
-		void clear() { std_dsp::zero(storage.channels() * storage.size(), begin()); }
+		void clear() { std_dsp::zero(view()); }
 		inline
-		void clear(integer_t n) {
-			for(auto c : *this)
-				std_dsp::zero(n, c);
-		}
+		void clear(integer_t n) { std_dsp::zero(view().take(n)); }
 
 		inline
-		void fill(double x) { std_dsp::assign(storage.channels() * storage.size(), begin(), x); }
+		void fill(double x) { std_dsp::assign(view(), x); }
 		inline
-		void fill(integer_t n, double x) {
-			for(auto c : *this)
-				std_dsp::assign(n, c, x);
-		}
+		void fill(integer_t n, double x) { std_dsp::assign(view().take(n), x); }
 
 		inline
-		void randomize(double a = -1.0, double b = 1.0) {
-			std_dsp::randomize(storage.channels() * storage.size(), *begin(), a, b);
-		}
+		void randomize(double a = -1.0, double b = 1.0) { std_dsp::randomize(view(), a, b); }
 		inline
-		void randomize(integer_t n, double a = -1.0, double b = 1.0) {
-			for(auto c : *this)
-				std_dsp::randomize(n, c, a, b);
-		}
+		void randomize(integer_t n, double a = -1.0, double b = 1.0) { std_dsp::randomize(view().take(n), a, b); }
 
 		inline
-		void undenormalize() {
-			std_dsp::undenormalize(storage(), storage.channels() * storage.size());
-		}
+		void undenormalize() { std_dsp::undenormalize(view()); }
 		inline
-		void undenormalize(integer_t n) {
-			for(auto c : *this)
-				std_dsp::undenormalize(c, n);
-		}
+		void undenormalize(integer_t n) { std_dsp::undenormalize(view().take(n)); }
 
 		inline
 		void resize(difference_type n, bool clear_storage = true) {
@@ -192,6 +191,10 @@ namespace std_dsp {
 
 	using mono_buffer = buffer<1>;
 	using stereo_buffer = buffer<2>;
+
+	//Buffers whose memory is recycled through a buffer_pool
+	template <integer_t CHANNELS>
+	using pooled_buffer = buffer_t<pooled_storage<CHANNELS>>;
 }
 
 #endif
@@ -1,4 +1,3 @@
-
 #ifndef STD_DSP_DELAY_LINE_GUARD
 #define STD_DSP_DELAY_LINE_GUARD
 
@@ -7,39 +6,13 @@
 #include <algorithm>
 #include <utility>
 
-#include "iterators.h"
 #include "../base/std_dsp_mem.h"
+#include "../memory/mirrored_storage.h"
+#include "../iterators/circular_iterator.h"
+#include "../interpolation/interpolation.h"
 #include "../stateless_algorithms/mono.h"
 
-#ifdef WIN32
-#define constexpr
-#else
-#endif
-
 namespace std_dsp {
-	namespace detail {	
-		inline
-		integer_t wrap_forward(integer_t i, integer_t buf_size) {
-			if (i >= buf_size)
-				return i % buf_size;
-			return i;
-		}
-		inline
-		integer_t wrap_reverse(integer_t i, integer_t buf_size) {
-			while (i < 0)
-				i += buf_size;
-			return i;
-		}
-		inline
-		integer_t wrap_bidirectional(integer_t i, integer_t buf_size) {
-			if (i >= buf_size)
-				return i % buf_size;
-			while (i < 0)
-				i += buf_size;
-			return i;
-		}
-	}
-
 	//
 	//  Utility function for computing the minimum buffer size needed to accomodate
 	//  the maximum delay the system will use and the size of the blocks of the
@@ -50,45 +23,336 @@ namespace std_dsp {
 		return max_delay + block_size + 1;
 	}
 
-	template <std::size_t CHANNELS, typename STORAGE, typename STEREO_TAG = SplitStereoTag>
+	//
+	//  A wrapped region of a circular buffer as at most two contiguous runs,
+	//  [first1, first1 + n1) followed by [first2, first2 + n2).
+	//
+	template <typename T>
+	struct span_pair {
+		T* first1;
+		integer_t n1;
+		T* first2;
+		integer_t n2;
+
+		inline
+		integer_t size() const { return n1 + n2; }
+		inline
+		bool wraps() const { return n2 != 0; }
+	};
+
+	//
+	//  One tap of a multi-tap read
+	//
+	struct delay_tap {
+		integer_t delay;
+		double gain;
+	};
+
+	namespace detail {
+		//Samples per pass of a multi-tap read
+		static const integer_t tap_block = 256;
+
+		template <typename T>
+		inline
+		span_pair<T> make_span_pair(T* first, integer_t buf_size, integer_t pos, integer_t n) {
+			assert(pos >= 0 && pos < buf_size);
+			assert(n >= 0 && n <= buf_size);
+			const integer_t n1 = (std::min)(n, buf_size - pos);
+			span_pair<T> s = { first + pos, n1, first, n - n1 };
+			return s;
+		}
+	}
+
+	//
+	//  Wrapping policies for delay_line_buffer. modulo_wrap works with any buffer size,
+	//  mask_wrap rounds the size up to a power of two and wraps with a mask, so delayed
+	//  positions and taps are computed without branches. mirror_wrap is for storage that
+	//  maps each channel twice back to back, where no block ever needs a second span.
+	//
+	struct modulo_wrap {
+		template <typename I>
+		using iterator = circular_iterator<I>;
+
+		inline
+		static integer_t capacity(integer_t n) { return n; }
+		inline
+		static integer_t forward(integer_t i, integer_t size) { return detail::wrap_forward(i, size); }
+		inline
+		static integer_t reverse(integer_t i, integer_t size) { return detail::wrap_reverse(i, size); }
+
+		template <typename I>
+		inline
+		static circular_iterator<I> make_iterator(I first, integer_t pos, integer_t size) {
+			return make_circular_iterator(first, pos, size);
+		}
+
+		template <typename T>
+		inline
+		static span_pair<T> spans(T* first, integer_t size, integer_t pos, integer_t n) {
+			return detail::make_span_pair(first, size, pos, n);
+		}
+	};
+
+	struct mask_wrap {
+		template <typename I>
+		using iterator = masked_circular_iterator<I>;
+
+		inline
+		static integer_t capacity(integer_t n) { return detail::next_power_of_two(n); }
+		inline
+		static integer_t forward(integer_t i, integer_t size) { return detail::wrap_mask(i, size - 1); }
+		inline
+		static integer_t reverse(integer_t i, integer_t size) { return detail::wrap_mask(i, size - 1); }
+
+		template <typename I>
+		inline
+		static masked_circular_iterator<I> make_iterator(I first, integer_t pos, integer_t size) {
+			return make_masked_circular_iterator(first, pos, size);
+		}
+
+		template <typename T>
+		inline
+		static span_pair<T> spans(T* first, integer_t size, integer_t pos, integer_t n) {
+			return detail::make_span_pair(first, size, pos, n);
+		}
+	};
+
+	struct mirror_wrap : modulo_wrap {
+		//The samples past the end of a channel are its beginning again
+		template <typename T>
+		inline
+		static span_pair<T> spans(T* first, integer_t size, integer_t pos, integer_t n) {
+			assert(pos >= 0 && pos < size);
+			assert(n >= 0 && n <= size);
+			span_pair<T> s = { first + pos, n, first, 0 };
+			return s;
+		}
+	};
+
+	//
+	//  Multichannel delay line over planar storage.
+	//
+	//  Each block is written at the write head and read back at a delay behind it. Block
+	//  reads and writes resolve the wrapped region into at most two contiguous spans and
+	//  run the vectorized algorithms over each, so wrapping costs one extra call per block
+	//  rather than a branch per sample:
+	//
+	//  delay_line<2> d(minimum_buffer_size(max_delay, block_size));
+	//  for each block:
+	//      d.write(0, in_left, n);
+	//      d.read(0, delay, n, out_left);
+	//      ...
+	//      d.rotate(n);
+	//
+	//  A read at delay d covers the samples written d samples before the write head, so
+	//  with d >= n it returns what earlier blocks wrote and with d < n it overlaps the
+	//  current block.
+	//
+	//  With mask_wrap the buffer is rounded up to a power of two, which static storage
+	//  must already be. mirrored_delay_line rounds it up to whole pages and reads and
+	//  writes every block as a single span.
+	//
+	template <typename STORAGE, typename WRAP = modulo_wrap>
 	class delay_line_buffer {
 	private:
 		STORAGE storage;
 		integer_t write_head;
+
+		inline
+		integer_t read_position(integer_t delay) const {
+			//A delay of size() would land back on the write head
+			assert(delay >= 0 && delay < storage.size());
+			return WRAP::reverse(write_head - delay, storage.size());
+		}
+
+		//out += x1 * gain1 + x2 * gain2 from positions p1 and p2, split where either run wraps
+		inline
+		void add_tap_pair(const double* first, integer_t p1, double gain1, integer_t p2, double gain2, integer_t n, double* out) const {
+			const integer_t size = storage.size();
+			while(n > 0) {
+				const integer_t m = (std::min)(WRAP::spans(first, size, p1, n).n1, WRAP::spans(first, size, p2, n).n1);
+				linear_combination_add(first + p1, first + p2, m, out, gain1, gain2);
+				p1 = WRAP::forward(p1 + m, size);
+				p2 = WRAP::forward(p2 + m, size);
+				out += m;
+				n -= m;
+			}
+		}
 	public:
-		delay_line() : data() {}
-		delay_line(difference_type n) : data(n) {}
+		using iterator = typename WRAP::template iterator<double*>;
+
+		delay_line_buffer() : write_head(0) {
+			assert(storage.size() == 0 || WRAP::capacity(storage.size()) == storage.size());
+			clear();
+		}
+		explicit delay_line_buffer(integer_t n) : storage(WRAP::capacity(n)), write_head(0) { clear(); }
+
+		inline
+		integer_t channels() const { return storage.channels(); }
+		inline
+		integer_t size() const { return storage.size(); }
+		inline
+		integer_t get_write_head() const { return write_head; }
 
 		//
-		//  Returns a zero delay write iterator
+		//  Spans of the n samples of channel starting at the write head
+		//  Preconditions:
+		//  n is no larger than the buffer.
 		//
-		delay_line_iterator<CHANNELS, STEREO_TAG> begin() {
-			return delay_line_iterator<CHANNELS, STEREO_TAG>(
-				storage.begin(),
-				write_head,
-				storage.size()
-				);
+		inline
+		span_pair<double> write_spans(integer_t channel, integer_t n) {
+			return WRAP::spans(storage.begin(channel), storage.size(), write_head, n);
 		}
 		//
-		//  Returns a non-negative delay read iterator
+		//  Spans of the n samples of channel starting delay samples before the write head
 		//  Preconditions:
-		//  delay is non-negative.
+		//  delay lies in [0, size()), n is no larger than the buffer.
+		//
+		inline
+		span_pair<const double> read_spans(integer_t channel, integer_t delay, integer_t n) const {
+			return WRAP::spans(storage.begin(channel), storage.size(), read_position(delay), n);
+		}
+
+		//
+		//  Zero delay write iterator
+		//
+		inline
+		iterator begin(integer_t channel) {
+			return WRAP::make_iterator(storage.begin(channel), write_head, storage.size());
+		}
+		//
+		//  Read iterator at a non-negative delay
 		//
-		delay_line_iterator<CHANNELS, STEREO_TAG> begin(storage_type_t delay) const {
-			assert(delay >= 0);
-			return delay_line_iterator<CHANNELS, STEREO_TAG>(
-				storage.begin(),
-				wrap_reverse(write_head - delay, storage.size()),
-				storage.size()
-				);
+		inline
+		iterator begin(integer_t channel, integer_t delay) {
+			return WRAP::make_iterator(storage.begin(channel), read_position(delay), storage.size());
 		}
 
+		//
+		//  The single sample delay samples behind the write head
+		//
+		inline
+		double tap(integer_t channel, integer_t delay) const {
+			return storage.begin(channel)[read_position(delay)];
+		}
+
+		// - Block writes -
+
+		inline
+		void write(integer_t channel, const double* first, integer_t n) {
+			const span_pair<double> s = write_spans(channel, n);
+			std_dsp::copy(first, s.n1, s.first1);
+			std_dsp::copy(first + s.n1, s.n2, s.first2);
+		}
+		template <typename Op>
+		inline
+		void write_transform(integer_t channel, const double* first, integer_t n, Op op) {
+			const span_pair<double> s = write_spans(channel, n);
+			copy_transform(first, s.n1, s.first1, op);
+			copy_transform(first + s.n1, s.n2, s.first2, op);
+		}
+		template <typename Op>
+		inline
+		void write_binary_transform(integer_t channel, const double* first1, const double* first2, integer_t n, Op op) {
+			const span_pair<double> s = write_spans(channel, n);
+			binary_transform(first1, first2, s.n1, s.first1, op);
+			binary_transform(first1 + s.n1, first2 + s.n1, s.n2, s.first2, op);
+		}
+		//Adds first * gain to what the write head already holds, for accumulating taps
+		inline
+		void write_add(integer_t channel, const double* first, integer_t n, double gain = 1.0) {
+			const span_pair<double> s = write_spans(channel, n);
+			std_dsp::multiply_add(first, s.n1, s.first1, gain);
+			std_dsp::multiply_add(first + s.n1, s.n2, s.first2, gain);
+		}
+
+		// - Block reads -
+
+		inline
+		void read(integer_t channel, integer_t delay, integer_t n, double* out) const {
+			const span_pair<const double> s = read_spans(channel, delay, n);
+			std_dsp::copy(s.first1, s.n1, out);
+			std_dsp::copy(s.first2, s.n2, out + s.n1);
+		}
+		template <typename Op>
+		inline
+		void read_transform(integer_t channel, integer_t delay, integer_t n, double* out, Op op) const {
+			const span_pair<const double> s = read_spans(channel, delay, n);
+			copy_transform(s.first1, s.n1, out, op);
+			copy_transform(s.first2, s.n2, out + s.n1, op);
+		}
+		//out = op(delayed, first)
+		template <typename Op>
+		inline
+		void read_binary_transform(integer_t channel, integer_t delay, const double* first, integer_t n, double* out, Op op) const {
+			const span_pair<const double> s = read_spans(channel, delay, n);
+			binary_transform(s.first1, first, s.n1, out, op);
+			binary_transform(s.first2, first + s.n1, s.n2, out + s.n1, op);
+		}
+		//out += delayed * gain
+		inline
+		void read_add(integer_t channel, integer_t delay, integer_t n, double* out, double gain = 1.0) const {
+			const span_pair<const double> s = read_spans(channel, delay, n);
+			std_dsp::multiply_add(s.first1, s.n1, out, gain);
+			std_dsp::multiply_add(s.first2, s.n2, out + s.n1, gain);
+		}
+
+		//
+		//  Adds count taps of channel into out, each delayed and scaled on its own. The block
+		//  is processed in passes of a few hundred samples, every pass adding the taps two at
+		//  a time, so out stays in cache and is loaded and stored once per pair of taps
+		//  rather than once per tap.
+		//  Preconditions:
+		//  n is no larger than the buffer, every delay lies in [0, size()).
+		//
+		inline
+		void read_taps_add(integer_t channel, const delay_tap* taps, integer_t count, integer_t n, double* out) const {
+			const double* first = storage.begin(channel);
+			const integer_t size = storage.size();
+			for(integer_t offset = 0; offset < n; offset += detail::tap_block) {
+				const integer_t m = (std::min)(detail::tap_block, n - offset);
+				const integer_t head = WRAP::forward(write_head + offset, size);
+
+				integer_t t = 0;
+				for(; t + 1 < count; t += 2) {
+					assert(taps[t].delay >= 0 && taps[t].delay < size && taps[t + 1].delay >= 0 && taps[t + 1].delay < size);
+					add_tap_pair(first,
+						WRAP::reverse(head - taps[t].delay, size), taps[t].gain,
+						WRAP::reverse(head - taps[t + 1].delay, size), taps[t + 1].gain,
+						m, out + offset);
+				}
+
+				if(t < count) {
+					assert(taps[t].delay >= 0 && taps[t].delay < size);
+					const span_pair<const double> s = WRAP::spans(first, size, WRAP::reverse(head - taps[t].delay, size), m);
+					std_dsp::multiply_add(s.first1, s.n1, out + offset, taps[t].gain);
+					std_dsp::multiply_add(s.first2, s.n2, out + offset + s.n1, taps[t].gain);
+				}
+			}
+		}
+
+		//
+		//  Fractional delay read, sample k delays[k] samples behind the write head plus k,
+		//  with one of the interpolators of interpolation.h. A thiran_interpolation is
+		//  passed by reference so its state carries over to the next block.
+		//
+		template <typename INTERPOLATOR>
+		inline
+		void read_fractional(integer_t channel, const double* delays, integer_t n, double* out, INTERPOLATOR&& interpolator) const {
+			fractional_delay_read<WRAP>(storage.begin(channel), storage.size(), write_head, delays, n, out, std::forward<INTERPOLATOR>(interpolator));
+		}
+
+		// - Whole buffer -
+
+		inline
 		void clear() {
-			std_dsp::zero(CHANNELS * storage.size(), storage.begin());
+			storage.clear();
 		}
 
+		inline
 		void fill(double x) {
-			std_dsp::assign(CHANNELS * storage.size(), storage.begin(), x);
+			for(integer_t c = 0; c < storage.channels(); ++c)
+				std_dsp::assign(storage.size(), storage.begin(c), x);
 		}
 
 		//
@@ -96,12 +360,12 @@ namespace std_dsp {
 		//  requested will origin at the new rotated position.
 		//  Does not manipulate underlying data and has O(1) complexity.
 		//  Preconditions:
-		//  delay is non-negative
-		// 
+		//  n is non-negative
+		//
 		inline
 		void rotate(integer_t n) {
 			assert(n >= 0);
-			write_head = wrap_forward(write_head + n, storage.size());
+			write_head = WRAP::forward(write_head + n, storage.size());
 		}
 
 		//
@@ -111,11 +375,28 @@ namespace std_dsp {
 		//
 		inline
 		void resize(integer_t n) {
-			storage.resize(n);
+			storage.resize(WRAP::capacity(n));
 			write_head = 0;
 			clear();
 		}
 	};
+
+	template <integer_t CHANNELS>
+	using delay_line = delay_line_buffer<dynamic_storage<CHANNELS>>;
+
+	template <integer_t CHANNELS, integer_t SIZE>
+	using static_delay_line = delay_line_buffer<static_storage<CHANNELS, SIZE>>;
+
+	//Power of two sized delay lines, wrapped with a mask
+	template <integer_t CHANNELS>
+	using masked_delay_line = delay_line_buffer<dynamic_storage<CHANNELS>, mask_wrap>;
+
+	template <integer_t CHANNELS, integer_t SIZE>
+	using static_masked_delay_line = delay_line_buffer<static_storage<CHANNELS, SIZE>, mask_wrap>;
+
+	//Page sized delay lines over double mapped memory, blocks never split at the wrap
+	template <integer_t CHANNELS>
+	using mirrored_delay_line = delay_line_buffer<mirrored_storage<CHANNELS>, mirror_wrap>;
 }
 
 #endif
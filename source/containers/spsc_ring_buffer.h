@@ -0,0 +1,206 @@
+
+#ifndef STD_DSP_SPSC_RING_BUFFER_GUARD
+#define STD_DSP_SPSC_RING_BUFFER_GUARD
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <atomic>
+
+#include "../base/base.h"
+#include "../base/std_dsp_mem.h"
+#include "../stateless_algorithms/mono.h"
+#include "delay_line.h"
+
+//
+//  Wait-free single producer, single consumer ring of multichannel samples.
+//
+//  One thread writes, one other thread reads, and neither ever blocks or loops: every
+//  call does a bounded amount of work and reports how much it could do. Use it to hand
+//  audio between the real-time thread and disk streaming or analysis threads.
+//
+//  The producer and consumer positions sit on cache lines of their own, each next to the
+//  side's cached copy of the other position, so the two threads only touch each other's
+//  line when the cached value runs out.
+//
+//  Blocks are transferred through spans of the ring, at most two per channel, or one with
+//  mirrored storage:
+//
+//  producer:                                   consumer:
+//  n = min(n, r.write_available());            n = min(n, r.read_available());
+//  for each channel c:                         for each channel c:
+//      fill r.write_spans(c, n)                    use r.read_spans(c, n)
+//  r.commit_write(n);                          r.commit_read(n);
+//
+//  or with the copying push and pop. The ring holds capacity() samples per channel, one
+//  less than the storage, so a full ring and an empty one have different positions.
+//
+
+namespace std_dsp {
+	template <typename STORAGE, typename WRAP = modulo_wrap>
+	class spsc_ring_buffer {
+	private:
+		STORAGE storage;
+
+		//Producer line: its position and its last view of the consumer's
+		CACHE_ALIGN std::atomic<integer_t> write_index;
+		integer_t read_cache;
+
+		//Consumer line
+		CACHE_ALIGN std::atomic<integer_t> read_index;
+		integer_t write_cache;
+
+		//Keeps whatever follows off the consumer line
+		CACHE_ALIGN char padding[1];
+
+		inline
+		integer_t distance(integer_t from, integer_t to) const {
+			return WRAP::reverse(to - from, storage.size());
+		}
+
+		//What each side knows to be free or filled from its cached view, without touching the other line
+		inline
+		integer_t cached_writable() const {
+			return capacity() - distance(read_cache, write_index.load(std::memory_order_relaxed));
+		}
+		inline
+		integer_t cached_readable() const {
+			return distance(read_index.load(std::memory_order_relaxed), write_cache);
+		}
+
+		//Up to n writable samples, asking the consumer only when the cached position falls short
+		inline
+		integer_t writable(integer_t n) {
+			return cached_writable() >= n ? n : (std::min)(n, write_available());
+		}
+		inline
+		integer_t readable(integer_t n) {
+			return cached_readable() >= n ? n : (std::min)(n, read_available());
+		}
+	public:
+		spsc_ring_buffer() : write_index(0), read_cache(0), read_index(0), write_cache(0) {}
+		//A ring of at least n samples per channel
+		explicit spsc_ring_buffer(integer_t n) : storage(WRAP::capacity(n + 1)), write_index(0), read_cache(0), read_index(0), write_cache(0) {
+			storage.clear();
+		}
+
+		spsc_ring_buffer(const spsc_ring_buffer&) = delete;
+		spsc_ring_buffer& operator=(const spsc_ring_buffer&) = delete;
+
+		inline
+		integer_t channels() const { return storage.channels(); }
+		inline
+		integer_t capacity() const { return storage.size() == 0 ? 0 : storage.size() - 1; }
+
+		// - Producer -
+
+		//Samples that can be written now
+		inline
+		integer_t write_available() {
+			read_cache = read_index.load(std::memory_order_acquire);
+			return capacity() - distance(read_cache, write_index.load(std::memory_order_relaxed));
+		}
+
+		//
+		//  Spans for the next n samples of channel
+		//  Preconditions:
+		//  n is no larger than write_available().
+		//
+		inline
+		span_pair<double> write_spans(integer_t channel, integer_t n) {
+			return WRAP::spans(storage.begin(channel), storage.size(), write_index.load(std::memory_order_relaxed), n);
+		}
+
+		//Publishes the next n written samples to the consumer
+		inline
+		void commit_write(integer_t n) {
+			//The views only grow between refreshes, so the one that gave n still covers it
+			assert(n >= 0 && n <= cached_writable());
+			const integer_t w = write_index.load(std::memory_order_relaxed);
+			write_index.store(WRAP::forward(w + n, storage.size()), std::memory_order_release);
+		}
+
+		//
+		//  Copies up to n samples of every channel from in[channel] and publishes them.
+		//  Returns how many were pushed.
+		//
+		inline
+		integer_t push(const double* const* in, integer_t n) {
+			n = writable(n);
+			if(n == 0)
+				return 0;
+			for(integer_t c = 0; c < channels(); ++c) {
+				const span_pair<double> s = write_spans(c, n);
+				std_dsp::copy(in[c], s.n1, s.first1);
+				std_dsp::copy(in[c] + s.n1, s.n2, s.first2);
+			}
+			commit_write(n);
+			return n;
+		}
+		inline
+		integer_t push(const double* in, integer_t n) {
+			assert(channels() == 1);
+			return push(&in, n);
+		}
+
+		// - Consumer -
+
+		//Samples that can be read now
+		inline
+		integer_t read_available() {
+			write_cache = write_index.load(std::memory_order_acquire);
+			return distance(read_index.load(std::memory_order_relaxed), write_cache);
+		}
+
+		//
+		//  Spans of the next n samples of channel
+		//  Preconditions:
+		//  n is no larger than read_available().
+		//
+		inline
+		span_pair<const double> read_spans(integer_t channel, integer_t n) const {
+			const STORAGE& s = storage;
+			return WRAP::spans(s.begin(channel), s.size(), read_index.load(std::memory_order_relaxed), n);
+		}
+
+		//Hands the next n read samples back to the producer
+		inline
+		void commit_read(integer_t n) {
+			assert(n >= 0 && n <= cached_readable());
+			const integer_t r = read_index.load(std::memory_order_relaxed);
+			read_index.store(WRAP::forward(r + n, storage.size()), std::memory_order_release);
+		}
+
+		//
+		//  Copies up to n samples of every channel into out[channel] and releases them.
+		//  Returns how many were popped.
+		//
+		inline
+		integer_t pop(double* const* out, integer_t n) {
+			n = readable(n);
+			if(n == 0)
+				return 0;
+			for(integer_t c = 0; c < channels(); ++c) {
+				const span_pair<const double> s = read_spans(c, n);
+				std_dsp::copy(s.first1, s.n1, out[c]);
+				std_dsp::copy(s.first2, s.n2, out[c] + s.n1);
+			}
+			commit_read(n);
+			return n;
+		}
+		inline
+		integer_t pop(double* out, integer_t n) {
+			assert(channels() == 1);
+			return pop(&out, n);
+		}
+	};
+
+	template <integer_t CHANNELS>
+	using spsc_ring = spsc_ring_buffer<dynamic_storage<CHANNELS>>;
+
+	//Whole page rings whose spans never split
+	template <integer_t CHANNELS>
+	using mirrored_spsc_ring = spsc_ring_buffer<mirrored_storage<CHANNELS>, mirror_wrap>;
+}
+
+#endif
@@ -0,0 +1,316 @@
+
+#ifndef STD_DSP_FDN_REVERB_GUARD
+#define STD_DSP_FDN_REVERB_GUARD
+
+#include <cstdint>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+#include "../base/base.h"
+#include "../base/std_dsp_denormals.h"
+#include "../base/std_dsp_mem.h"
+#include "../containers/delay_line.h"
+#include "../interpolation/interpolation.h"
+#include "../stateless_algorithms/mono.h"
+#include "../stereo/stereo_transforms.h"
+
+//
+//  Feedback delay network reverb.
+//
+//  N delay lines feed back into each other through an orthogonal matrix, with a damping
+//  filter per line setting the decay time per frequency (Jot). The network runs a block
+//  of samples at a time: as long as the block is no longer than the shortest delay, every
+//  sample read from the lines was written by an earlier block, so each stage is a vector
+//  operation over whole rows of the block:
+//
+//  read        every line at its (modulated) delay into a row
+//  damp        one biquad per line
+//  output      left and right mixes of the rows
+//  feedback    the matrix over the rows, log2(N) passes of sum and difference for Hadamard
+//  write       feedback plus input back into every line
+//
+//  The output is wet only. Setting delays, decay or modulation allocates and belongs
+//  outside the audio thread; process does not allocate.
+//
+//  fdn_reverb<8> reverb(48000.0);
+//  reverb.set_decay(2.0, 0.8);
+//  reverb.process(in_left, in_right, n, out_left, out_right);
+//
+
+namespace std_dsp {
+	//
+	//  Feedback matrices. apply multiplies the rows of the block, one per line, by the
+	//  matrix up to a factor of scale(), which is folded into the write back.
+	//
+
+	//Sylvester Hadamard matrix, N a power of two
+	struct hadamard_feedback {
+		inline
+		static double scale(integer_t n) { return 1.0 / std::sqrt(static_cast<double>(n)); }
+
+		template <typename STORAGE>
+		inline
+		static void apply(STORAGE& rows, double*, integer_t m) {
+			const integer_t n = rows.channels();
+			assert((n & (n - 1)) == 0);
+			for(integer_t h = 1; h < n; h *= 2) {
+				for(integer_t i = 0; i < n; i += 2 * h) {
+					for(integer_t j = i; j < i + h; ++j)
+						mid_side(rows.begin(j), rows.begin(j + h), m, rows.begin(j), rows.begin(j + h));
+				}
+			}
+		}
+	};
+
+	//I - 2/N 11^T, any N, mixes less densely than Hadamard
+	struct householder_feedback {
+		inline
+		static double scale(integer_t) { return 1.0; }
+
+		template <typename STORAGE>
+		inline
+		static void apply(STORAGE& rows, double* sum, integer_t m) {
+			const integer_t n = rows.channels();
+			std_dsp::copy(rows.begin(0), m, sum);
+			for(integer_t i = 1; i < n; ++i)
+				std_dsp::add(rows.begin(i), sum, m, sum);
+			for(integer_t i = 0; i < n; ++i)
+				linear_combination(rows.begin(i), sum, m, rows.begin(i), 1.0, -2.0 / static_cast<double>(n));
+		}
+	};
+
+	namespace detail {
+		//Samples per pass of the network
+		static const integer_t fdn_block = 256;
+
+		static const double fdn_two_pi = 6.283185307179586476925;
+
+		inline
+		integer_t next_prime(integer_t n) {
+			if(n <= 2)
+				return 2;
+			if(n % 2 == 0)
+				++n;
+			for(;; n += 2) {
+				bool prime = true;
+				for(integer_t d = 3; d * d <= n && prime; d += 2)
+					prime = n % d != 0;
+				if(prime)
+					return n;
+			}
+		}
+	}
+
+	template <integer_t N = 8LL, typename MATRIX = hadamard_feedback>
+	class fdn_reverb {
+		static_assert(N >= 2, "A feedback delay network needs at least two lines.");
+	private:
+		using lines_type = delay_line_buffer<dynamic_storage<N>, mask_wrap>;
+
+		double sample_rate;
+		lines_type lines;
+		dynamic_storage<N> rows;
+		dynamic_storage<N> modulated_delays;
+		dynamic_storage<1> scratch;
+
+		integer_t delays[N];
+		integer_t block_limit;
+
+		//Damping biquads, transposed direct form II
+		double damping_b0[N], damping_b1[N], damping_b2[N], damping_a1[N], damping_a2[N];
+		double z1[N], z2[N];
+
+		double decay_dc;
+		double decay_nyquist;
+
+		double input_gain[N];
+		double left_gain[N];
+		double right_gain[N];
+
+		//Delay modulation, one sine per line rotated by a complex phasor
+		double depth;
+		double lfo_cos[N], lfo_sin[N];
+		double rotate_cos, rotate_sin;
+
+		inline
+		void resize_lines() {
+			integer_t shortest = delays[0];
+			integer_t longest = delays[0];
+			for(integer_t i = 1; i < N; ++i) {
+				shortest = (std::min)(shortest, delays[i]);
+				longest = (std::max)(longest, delays[i]);
+			}
+
+			//Fractional reads look up to two samples ahead of the delayed position
+			const integer_t reach = static_cast<integer_t>(std::ceil(depth)) + (depth > 0.0 ? hermite_interpolation::max_lookahead + 1 : 0);
+			assert(shortest - reach >= 1);
+			block_limit = (std::min)(detail::fdn_block, shortest - reach);
+			lines.resize(minimum_buffer_size(longest + reach, block_limit));
+		}
+
+		inline
+		void damp(double* x, integer_t m, integer_t i) {
+			double s1 = z1[i];
+			double s2 = z2[i];
+			for(integer_t k = 0; k < m; ++k) {
+				const double y = damping_b0[i] * x[k] + s1;
+				s1 = damping_b1[i] * x[k] - damping_a1[i] * y + s2;
+				s2 = damping_b2[i] * x[k] - damping_a2[i] * y;
+				x[k] = y;
+			}
+			//Keeps silent tails from decaying into denormals
+			if(undenormalize_needed()) {
+				s1 = std::fabs(s1) < 1.e-15 ? 0.0 : s1;
+				s2 = std::fabs(s2) < 1.e-15 ? 0.0 : s2;
+			}
+			z1[i] = s1;
+			z2[i] = s2;
+		}
+
+		inline
+		void generate_delays(integer_t i, integer_t m) {
+			double* d = modulated_delays.begin(i);
+			double c = lfo_cos[i];
+			double s = lfo_sin[i];
+			for(integer_t k = 0; k < m; ++k) {
+				d[k] = static_cast<double>(delays[i]) + depth * s;
+				const double t = c * rotate_cos - s * rotate_sin;
+				s = s * rotate_cos + c * rotate_sin;
+				c = t;
+			}
+			//Pulls the phasor back onto the unit circle
+			const double r = 1.0 / std::sqrt(c * c + s * s);
+			lfo_cos[i] = c * r;
+			lfo_sin[i] = s * r;
+		}
+	public:
+		explicit fdn_reverb(double sample_rate) : sample_rate(sample_rate), rows(detail::fdn_block), modulated_delays(detail::fdn_block), scratch(detail::fdn_block), decay_dc(1.5), decay_nyquist(0.7), depth(0.0), rotate_cos(1.0), rotate_sin(0.0) {
+			//Left into the even lines, right into the odd ones, outputs on orthogonal sign patterns
+			const double output = 1.0 / std::sqrt(static_cast<double>(N));
+			for(integer_t i = 0; i < N; ++i) {
+				input_gain[i] = ((i / 2) % 2 == 0) ? 1.0 : -1.0;
+				left_gain[i] = output;
+				right_gain[i] = (i % 2 == 0) ? output : -output;
+
+				const double phase = detail::fdn_two_pi * static_cast<double>(i) / static_cast<double>(N);
+				lfo_cos[i] = std::cos(phase);
+				lfo_sin[i] = std::sin(phase);
+			}
+
+			//Prime lengths spread geometrically over 30 to 110 ms
+			integer_t lengths[N];
+			for(integer_t i = 0; i < N; ++i) {
+				const double t = 0.030 * std::pow(0.110 / 0.030, static_cast<double>(i) / static_cast<double>(N - 1));
+				lengths[i] = detail::next_prime(static_cast<integer_t>(t * sample_rate));
+			}
+			set_delays(lengths);
+		}
+
+		inline
+		integer_t lines_count() const { return N; }
+		inline
+		integer_t delay(integer_t line) const { return delays[line]; }
+
+		//
+		//  Sets the delay of every line in samples, matches the damping to the decay times
+		//  last set and clears the network
+		//  Preconditions:
+		//  every length exceeds the modulation depth by at least four samples.
+		//
+		inline
+		void set_delays(const integer_t* lengths) {
+			std::copy_n(lengths, N, delays);
+			resize_lines();
+			set_decay(decay_dc, decay_nyquist);
+			clear();
+		}
+
+		//
+		//  Decay times in seconds to -60 dB at DC and at Nyquist. Each line gets a first
+		//  order absorption filter matching both gains to its length.
+		//
+		inline
+		void set_decay(double rt60_dc, double rt60_nyquist) {
+			decay_dc = rt60_dc;
+			decay_nyquist = rt60_nyquist;
+			for(integer_t i = 0; i < N; ++i) {
+				const double dc = std::pow(10.0, -3.0 * static_cast<double>(delays[i]) / (rt60_dc * sample_rate));
+				const double nyquist = std::pow(10.0, -3.0 * static_cast<double>(delays[i]) / (rt60_nyquist * sample_rate));
+				const double p = (dc - nyquist) / (dc + nyquist);
+				set_damping(i, dc * (1.0 - p), 0.0, 0.0, -p, 0.0);
+			}
+		}
+
+		//The damping biquad of a line, y = b0 x + b1 x' + b2 x'' - a1 y' - a2 y''
+		inline
+		void set_damping(integer_t line, double b0, double b1, double b2, double a1, double a2) {
+			damping_b0[line] = b0;
+			damping_b1[line] = b1;
+			damping_b2[line] = b2;
+			damping_a1[line] = a1;
+			damping_a2[line] = a2;
+		}
+
+		//
+		//  Sweeps every delay by up to depth samples at rate Hz, each line at its own phase.
+		//  Resizes the lines and clears the network.
+		//
+		inline
+		void set_modulation(double depth_samples, double rate) {
+			depth = depth_samples;
+			rotate_cos = std::cos(detail::fdn_two_pi * rate / sample_rate);
+			rotate_sin = std::sin(detail::fdn_two_pi * rate / sample_rate);
+			resize_lines();
+			clear();
+		}
+
+		inline
+		void clear() {
+			lines.clear();
+			for(integer_t i = 0; i < N; ++i) {
+				z1[i] = 0.0;
+				z2[i] = 0.0;
+			}
+		}
+
+		inline
+		void process(const double* in_left, const double* in_right, integer_t n, double* out_left, double* out_right) {
+			while(n > 0) {
+				const integer_t m = (std::min)(n, block_limit);
+
+				for(integer_t i = 0; i < N; ++i) {
+					if(depth > 0.0) {
+						generate_delays(i, m);
+						lines.read_fractional(i, modulated_delays.begin(i), m, rows.begin(i), hermite_interpolation());
+					} else {
+						lines.read(i, delays[i], m, rows.begin(i));
+					}
+					damp(rows.begin(i), m, i);
+				}
+
+				std_dsp::zero(m, out_left);
+				std_dsp::zero(m, out_right);
+				for(integer_t i = 0; i < N; ++i) {
+					std_dsp::multiply_add(rows.begin(i), m, out_left, left_gain[i]);
+					std_dsp::multiply_add(rows.begin(i), m, out_right, right_gain[i]);
+				}
+
+				MATRIX::apply(rows, scratch.begin(0), m);
+
+				const double feedback = MATRIX::scale(N);
+				for(integer_t i = 0; i < N; ++i)
+					lines.write_binary_transform(i, rows.begin(i), (i % 2 == 0) ? in_left : in_right, m, linear_combination_op(feedback, input_gain[i]));
+				lines.rotate(m);
+
+				in_left += m;
+				in_right += m;
+				out_left += m;
+				out_right += m;
+				n -= m;
+			}
+		}
+	};
+}
+
+#endif
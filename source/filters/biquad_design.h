@@ -0,0 +1,454 @@
+
+#ifndef STD_DSP_BIQUAD_DESIGN_GUARD
+#define STD_DSP_BIQUAD_DESIGN_GUARD
+
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <algorithm>
+
+#include "../base/base.h"
+#include "../std_dsp_biquad_filter.h"
+
+//
+//  Coefficient design for biquad_coeffs and cascades of them.
+//
+//  rbj_biquad      the cookbook shapes of Robert Bristow-Johnson's Audio EQ Cookbook
+//  butterworth     maximally flat low and high passes of any order up to 32
+//  chebyshev       type I, equiripple in the passband
+//  elliptic        equiripple in both bands, the steepest for an order (Orfanidis)
+//
+//  The high order designs place the poles and zeros of an analog prototype, map them
+//  through the bilinear transform prewarped to the cutoff and pair them into sections,
+//  ordered by increasing pole radius so the most resonant sections come last. They fill
+//  design_sections(order) coefficient sets and return how many that is.
+//
+//  All of them are trig and, for the high orders, complex arithmetic. rbj_cache keeps
+//  recent cookbook designs for code that recomputes them on every parameter change.
+//
+
+namespace std_dsp {
+	enum class rbj_shape : int {
+		low_pass = 0,
+		high_pass,
+		band_pass,
+		notch,
+		all_pass,
+		peaking,
+		low_shelf,
+		high_shelf
+	};
+
+	enum class filter_pass : int {
+		low_pass = 0,
+		high_pass
+	};
+
+	namespace detail {
+		static const double design_pi = 3.14159265358979323846;
+
+		static const integer_t max_design_order = 32;
+	}
+
+	//
+	//  A cookbook section at fc Hz for sample rate fs. q sets the bandwidth or, for the
+	//  shelves, the slope; gain_db only applies to peaking and the shelves.
+	//
+	inline
+	biquad_coeffs rbj_biquad(rbj_shape shape, double fc, double q, double gain_db, double fs) {
+		assert(fc > 0.0 && fc < 0.5 * fs && q > 0.0);
+		const double w0 = 2.0 * detail::design_pi * fc / fs;
+		const double cs = std::cos(w0);
+		const double alpha = std::sin(w0) / (2.0 * q);
+		const double a = std::pow(10.0, gain_db / 40.0);
+		const double root = 2.0 * std::sqrt(a) * alpha;
+
+		double b0, b1, b2, a0, a1, a2;
+		switch(shape) {
+		case rbj_shape::low_pass:
+			b0 = (1.0 - cs) / 2.0; b1 = 1.0 - cs; b2 = b0;
+			a0 = 1.0 + alpha; a1 = -2.0 * cs; a2 = 1.0 - alpha;
+			break;
+		case rbj_shape::high_pass:
+			b0 = (1.0 + cs) / 2.0; b1 = -(1.0 + cs); b2 = b0;
+			a0 = 1.0 + alpha; a1 = -2.0 * cs; a2 = 1.0 - alpha;
+			break;
+		case rbj_shape::band_pass:
+			//0 dB peak gain
+			b0 = alpha; b1 = 0.0; b2 = -alpha;
+			a0 = 1.0 + alpha; a1 = -2.0 * cs; a2 = 1.0 - alpha;
+			break;
+		case rbj_shape::notch:
+			b0 = 1.0; b1 = -2.0 * cs; b2 = 1.0;
+			a0 = 1.0 + alpha; a1 = -2.0 * cs; a2 = 1.0 - alpha;
+			break;
+		case rbj_shape::all_pass:
+			b0 = 1.0 - alpha; b1 = -2.0 * cs; b2 = 1.0 + alpha;
+			a0 = 1.0 + alpha; a1 = -2.0 * cs; a2 = 1.0 - alpha;
+			break;
+		case rbj_shape::peaking:
+			b0 = 1.0 + alpha * a; b1 = -2.0 * cs; b2 = 1.0 - alpha * a;
+			a0 = 1.0 + alpha / a; a1 = -2.0 * cs; a2 = 1.0 - alpha / a;
+			break;
+		case rbj_shape::low_shelf:
+			b0 = a * ((a + 1.0) - (a - 1.0) * cs + root);
+			b1 = 2.0 * a * ((a - 1.0) - (a + 1.0) * cs);
+			b2 = a * ((a + 1.0) - (a - 1.0) * cs - root);
+			a0 = (a + 1.0) + (a - 1.0) * cs + root;
+			a1 = -2.0 * ((a - 1.0) + (a + 1.0) * cs);
+			a2 = (a + 1.0) + (a - 1.0) * cs - root;
+			break;
+		case rbj_shape::high_shelf:
+		default:
+			b0 = a * ((a + 1.0) + (a - 1.0) * cs + root);
+			b1 = -2.0 * a * ((a - 1.0) + (a + 1.0) * cs);
+			b2 = a * ((a + 1.0) + (a - 1.0) * cs - root);
+			a0 = (a + 1.0) - (a - 1.0) * cs + root;
+			a1 = 2.0 * ((a - 1.0) - (a + 1.0) * cs);
+			a2 = (a + 1.0) - (a - 1.0) * cs - root;
+			break;
+		}
+
+		biquad_coeffs c;
+		c.a1 = a1 / a0;
+		c.a2 = a2 / a0;
+		c.b0 = b0 / a0;
+		c.b1 = b1 / a0;
+		c.b2 = b2 / a0;
+		return c;
+	}
+
+	//Sections of a design of order, the last one first order when order is odd
+	inline
+	integer_t design_sections(integer_t order) { return (order + 1) / 2; }
+
+	namespace detail {
+		using complex_t = std::complex<double>;
+
+		//
+		//  Analog low pass prototype with its passband edge at 1 rad/s. Only poles and zeros
+		//  with a non negative imaginary part are kept, the rest are their conjugates; the
+		//  zeros not listed are at infinity.
+		//
+		struct analog_prototype {
+			complex_t poles[max_design_order / 2 + 1];
+			integer_t pole_count;
+			complex_t zeros[max_design_order / 2 + 1];
+			integer_t zero_count;
+			integer_t order;
+			//Gain at DC
+			double gain;
+		};
+
+		// - Jacobi elliptic functions by Landen transformations, after Orfanidis -
+
+		//Descending Landen moduli of k until they vanish
+		inline
+		integer_t landen(double k, double* v) {
+			integer_t n = 0;
+			while(k > 1.e-16 && n < 16) {
+				const double kp = std::sqrt(1.0 - k * k);
+				k = (k / (1.0 + kp)) * (k / (1.0 + kp));
+				v[n++] = k;
+			}
+			return n;
+		}
+
+		//cd(u K, k) and sn(u K, k) for complex u
+		inline
+		complex_t cde(complex_t u, double k) {
+			double v[16];
+			const integer_t n = landen(k, v);
+			complex_t w = std::cos(u * (design_pi / 2.0));
+			for(integer_t i = n - 1; i >= 0; --i)
+				w = (1.0 + v[i]) * w / (1.0 + v[i] * w * w);
+			return w;
+		}
+		inline
+		complex_t sne(complex_t u, double k) {
+			double v[16];
+			const integer_t n = landen(k, v);
+			complex_t w = std::sin(u * (design_pi / 2.0));
+			for(integer_t i = n - 1; i >= 0; --i)
+				w = (1.0 + v[i]) * w / (1.0 + v[i] * w * w);
+			return w;
+		}
+
+		//Inverse of sne, u with sn(u K, k) = w
+		inline
+		complex_t asne(complex_t w, double k) {
+			double v[16];
+			const integer_t n = landen(k, v);
+			for(integer_t i = 0; i < n; ++i) {
+				const double previous = i == 0 ? k : v[i - 1];
+				w = w / (1.0 + std::sqrt(1.0 - w * w * (previous * previous))) * (2.0 / (1.0 + v[i]));
+			}
+			return 1.0 - std::acos(w) * (2.0 / design_pi);
+		}
+
+		//Modulus k of an order n elliptic filter whose discrimination modulus is k1
+		inline
+		double ellipdeg(integer_t n, double k1) {
+			const double k1p = std::sqrt(1.0 - k1 * k1);
+			double product = 1.0;
+			for(integer_t i = 1; i <= n / 2; ++i)
+				product *= sne(complex_t(static_cast<double>(2 * i - 1) / static_cast<double>(n), 0.0), k1p).real();
+			const double kp = std::pow(k1p, static_cast<double>(n)) * std::pow(product, 4.0);
+			return std::sqrt(1.0 - kp * kp);
+		}
+
+		// - Prototypes -
+
+		inline
+		analog_prototype butterworth_prototype(integer_t order) {
+			analog_prototype p;
+			p.order = order;
+			p.pole_count = 0;
+			p.zero_count = 0;
+			p.gain = 1.0;
+			for(integer_t i = 0; i < (order + 1) / 2; ++i) {
+				const double theta = design_pi * static_cast<double>(2 * i + 1) / static_cast<double>(2 * order);
+				p.poles[p.pole_count++] = complex_t(-std::sin(theta), std::cos(theta));
+			}
+			return p;
+		}
+
+		inline
+		analog_prototype chebyshev_prototype(integer_t order, double ripple_db) {
+			const double eps = std::sqrt(std::pow(10.0, ripple_db / 10.0) - 1.0);
+			const double mu = std::asinh(1.0 / eps) / static_cast<double>(order);
+
+			analog_prototype p;
+			p.order = order;
+			p.pole_count = 0;
+			p.zero_count = 0;
+			//Even orders start the passband at the bottom of the ripple
+			p.gain = order % 2 == 0 ? 1.0 / std::sqrt(1.0 + eps * eps) : 1.0;
+			for(integer_t i = 0; i < (order + 1) / 2; ++i) {
+				const double theta = design_pi * static_cast<double>(2 * i + 1) / static_cast<double>(2 * order);
+				p.poles[p.pole_count++] = complex_t(-std::sinh(mu) * std::sin(theta), std::cosh(mu) * std::cos(theta));
+			}
+			return p;
+		}
+
+		inline
+		analog_prototype elliptic_prototype(integer_t order, double ripple_db, double stopband_db) {
+			const double ep = std::sqrt(std::pow(10.0, ripple_db / 10.0) - 1.0);
+			const double es = std::sqrt(std::pow(10.0, stopband_db / 10.0) - 1.0);
+			const double k1 = ep / es;
+			const double k = ellipdeg(order, k1);
+			const double v0 = (complex_t(0.0, -1.0) * asne(complex_t(0.0, 1.0 / ep), k1)).real() / static_cast<double>(order);
+
+			analog_prototype p;
+			p.order = order;
+			p.pole_count = 0;
+			p.zero_count = 0;
+			p.gain = order % 2 == 0 ? 1.0 / std::sqrt(1.0 + ep * ep) : 1.0;
+			for(integer_t i = 1; i <= order / 2; ++i) {
+				const double u = static_cast<double>(2 * i - 1) / static_cast<double>(order);
+				const double zeta = cde(complex_t(u, 0.0), k).real();
+				p.zeros[p.zero_count++] = complex_t(0.0, 1.0 / (k * zeta));
+				const complex_t pole = complex_t(0.0, 1.0) * cde(complex_t(u, -v0), k);
+				p.poles[p.pole_count++] = complex_t(pole.real(), std::fabs(pole.imag()));
+			}
+			if(order % 2 == 1) {
+				const complex_t pole = complex_t(0.0, 1.0) * sne(complex_t(0.0, v0), k);
+				p.poles[p.pole_count++] = complex_t(pole.real(), 0.0);
+			}
+			return p;
+		}
+
+		//
+		//  Maps the prototype to sections cutting off at fc: the high pass through s -> 1/s,
+		//  then the bilinear transform prewarped so the edge lands on fc. Each section is
+		//  scaled to unit gain in the passband, the first one also by the prototype's gain.
+		//
+		inline
+		integer_t digitize(const analog_prototype& p, filter_pass pass, double fc, double fs, biquad_coeffs* out) {
+			assert(fc > 0.0 && fc < 0.5 * fs);
+			const double t = std::tan(design_pi * fc / fs);
+			const bool high = pass == filter_pass::high_pass;
+			auto bilinear = [t, high](complex_t s) {
+				const complex_t x = high ? t / s : s * t;
+				return (1.0 + x) / (1.0 - x);
+			};
+
+			//Poles from the smallest radius up, the real one of odd orders last
+			complex_t poles[max_design_order / 2 + 1];
+			integer_t count = 0;
+			for(integer_t i = 0; i < p.pole_count; ++i)
+				poles[count++] = bilinear(p.poles[i]);
+			const integer_t pairs = p.order / 2;
+			std::sort(poles, poles + pairs, [](complex_t a, complex_t b) { return std::abs(a) < std::abs(b); });
+
+			//Finite zeros go with the nearest poles, the ones at infinity land on Nyquist or DC
+			complex_t zeros[max_design_order / 2 + 1];
+			const complex_t infinite_zero = high ? 1.0 : -1.0;
+			for(integer_t i = 0; i < count; ++i)
+				zeros[i] = infinite_zero;
+			bool used[max_design_order / 2 + 1] = {};
+			for(integer_t i = 0; i < p.zero_count; ++i) {
+				const complex_t z = bilinear(p.zeros[i]);
+				integer_t best = -1;
+				for(integer_t j = 0; j < pairs; ++j) {
+					if(!used[j] && (best < 0 || std::abs(poles[j] - z) < std::abs(poles[best] - z)))
+						best = j;
+				}
+				used[best] = true;
+				zeros[best] = z;
+			}
+
+			const complex_t reference = high ? -1.0 : 1.0;
+			for(integer_t i = 0; i < count; ++i) {
+				biquad_coeffs c;
+				if(i < pairs) {
+					c.a1 = -2.0 * poles[i].real();
+					c.a2 = std::norm(poles[i]);
+					c.b0 = 1.0;
+					c.b1 = -2.0 * zeros[i].real();
+					c.b2 = std::norm(zeros[i]);
+				} else {
+					c.a1 = -poles[i].real();
+					c.a2 = 0.0;
+					c.b0 = 1.0;
+					c.b1 = -infinite_zero.real();
+					c.b2 = 0.0;
+				}
+
+				const complex_t r1 = 1.0 / reference;
+				const complex_t numerator = c.b0 + c.b1 * r1 + c.b2 * r1 * r1;
+				const complex_t denominator = 1.0 + c.a1 * r1 + c.a2 * r1 * r1;
+				double g = std::abs(denominator / numerator);
+				if(i == 0)
+					g *= p.gain;
+				c.b0 *= g;
+				c.b1 *= g;
+				c.b2 *= g;
+				out[i] = c;
+			}
+			return count;
+		}
+	}
+
+	//
+	//  High order designs into design_sections(order) sections, returning that count.
+	//  Preconditions:
+	//  1 <= order <= 32, 0 < fc < fs / 2.
+	//
+	inline
+	integer_t butterworth(filter_pass pass, integer_t order, double fc, double fs, biquad_coeffs* out) {
+		assert(order >= 1 && order <= detail::max_design_order);
+		return detail::digitize(detail::butterworth_prototype(order), pass, fc, fs, out);
+	}
+	//ripple_db of passband ripple, the passband ends at fc
+	inline
+	integer_t chebyshev(filter_pass pass, integer_t order, double ripple_db, double fc, double fs, biquad_coeffs* out) {
+		assert(order >= 1 && order <= detail::max_design_order && ripple_db > 0.0);
+		return detail::digitize(detail::chebyshev_prototype(order, ripple_db), pass, fc, fs, out);
+	}
+	//ripple_db of passband ripple up to fc, stopband_db of attenuation past the transition
+	inline
+	integer_t elliptic(filter_pass pass, integer_t order, double ripple_db, double stopband_db, double fc, double fs, biquad_coeffs* out) {
+		assert(order >= 1 && order <= detail::max_design_order && ripple_db > 0.0 && stopband_db > ripple_db);
+		return detail::digitize(detail::elliptic_prototype(order, ripple_db, stopband_db), pass, fc, fs, out);
+	}
+
+	//Magnitude of a cascade at f Hz
+	inline
+	double magnitude(const biquad_coeffs* c, integer_t count, double f, double fs) {
+		const std::complex<double> r1 = std::polar(1.0, -2.0 * detail::design_pi * f / fs);
+		double m = 1.0;
+		for(integer_t i = 0; i < count; ++i) {
+			const std::complex<double> numerator = c[i].b0 + c[i].b1 * r1 + c[i].b2 * r1 * r1;
+			const std::complex<double> denominator = 1.0 + c[i].a1 * r1 + c[i].a2 * r1 * r1;
+			m *= std::abs(numerator / denominator);
+		}
+		return m;
+	}
+
+	//
+	//  Memoizes rbj_biquad on (shape, fc, q, gain, fs) in a direct mapped table of SLOTS
+	//  entries. A hit costs a hash and a compare instead of the trig, which pays off when
+	//  parameters repeat: stepped controls, shared voice settings, modulation from tables.
+	//  Lookups never allocate; the table is not shared between threads.
+	//
+	template <integer_t SLOTS = 256LL>
+	class rbj_cache {
+		static_assert((SLOTS & (SLOTS - 1)) == 0, "The slot count must be a power of two.");
+	private:
+		struct key {
+			rbj_shape shape;
+			double fc, q, gain, fs;
+		};
+		struct entry {
+			key k;
+			biquad_coeffs c;
+			bool valid;
+		};
+
+		entry table[SLOTS];
+		integer_t hit_count;
+		integer_t miss_count;
+
+		inline
+		static std::uint64_t bits(double x) {
+			std::uint64_t u;
+			std::memcpy(&u, &x, sizeof(u));
+			return u;
+		}
+		inline
+		static bool equal(const key& x, const key& y) {
+			return x.shape == y.shape && bits(x.fc) == bits(y.fc) && bits(x.q) == bits(y.q) && bits(x.gain) == bits(y.gain) && bits(x.fs) == bits(y.fs);
+		}
+		//splitmix64 finalizer, the parameters often differ in their high bits only
+		inline
+		static std::uint64_t mix(std::uint64_t h) {
+			h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ull;
+			h = (h ^ (h >> 27)) * 0x94D049BB133111EBull;
+			return h ^ (h >> 31);
+		}
+		inline
+		static integer_t slot(const key& k) {
+			std::uint64_t h = mix(static_cast<std::uint64_t>(k.shape));
+			h = mix(h ^ bits(k.fc));
+			h = mix(h ^ bits(k.q));
+			h = mix(h ^ bits(k.gain));
+			h = mix(h ^ bits(k.fs));
+			return static_cast<integer_t>(h & static_cast<std::uint64_t>(SLOTS - 1));
+		}
+	public:
+		rbj_cache() { clear(); }
+
+		inline
+		biquad_coeffs operator()(rbj_shape shape, double fc, double q, double gain_db, double fs) {
+			const key k = { shape, fc, q, gain_db, fs };
+			entry& e = table[slot(k)];
+			if(e.valid && equal(e.k, k)) {
+				++hit_count;
+				return e.c;
+			}
+			++miss_count;
+			e.k = k;
+			e.c = rbj_biquad(shape, fc, q, gain_db, fs);
+			e.valid = true;
+			return e.c;
+		}
+
+		inline
+		void clear() {
+			for(integer_t i = 0; i < SLOTS; ++i)
+				table[i].valid = false;
+			hit_count = 0;
+			miss_count = 0;
+		}
+
+		inline
+		integer_t hits() const { return hit_count; }
+		inline
+		integer_t misses() const { return miss_count; }
+	};
+}
+
+#endif
@@ -0,0 +1,367 @@
+
+#ifndef STD_DSP_INTERPOLATION_GUARD
+#define STD_DSP_INTERPOLATION_GUARD
+
+#include <cstdint>
+#include <cassert>
+#include <cmath>
+#include <utility>
+#include <type_traits>
+
+#include "../base/base.h"
+#include "../base/defines.h"
+#include "../base/std_dsp_computational_basis.h"
+#include "../base/std_dsp_cpu_features.h"
+#include "../base/std_dsp_simd_kernel.h"
+
+//
+//  Fractional delay readers over circular storage.
+//
+//  Every output sample k of a block is read delays[k] samples behind position pos + k, so
+//  a block written at the write head and read back with a per sample delay gives chorus,
+//  flanger and Doppler modulation. Reads go in blocks of 256 samples: the taps around
+//  each delayed position are gathered into planar rows first, then the interpolation
+//  polynomial is evaluated over the rows with the widest vectors the machine has.
+//
+//  The FIR interpolators read taps up to max_lookahead samples after the delayed
+//  position, so delays must lie in [max_lookahead, size - taps]:
+//
+//  linear_interpolation            2 taps, max_lookahead 1
+//  hermite_interpolation           4 taps, max_lookahead 2, Catmull-Rom spline
+//  lagrange_interpolation<3>       4 taps, max_lookahead 2
+//  lagrange_interpolation<5>       6 taps, max_lookahead 3
+//
+//  thiran_interpolation is a first order allpass with state, flat in magnitude but only
+//  meant for slowly moving delays; delays must lie in [0.5, size - 2]. Its recursion runs
+//  one sample at a time.
+//
+
+//The evaluators pass vectors to force-inlined helpers, see std_dsp_simd_kernel.h. The
+//pragma does not reach templates instantiated after the header, so those take and give
+//vectors by reference.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace std_dsp {
+	namespace detail {
+		//Arithmetic of the interpolators for scalars and each vector type
+		template <typename V>
+		struct lane_math;
+
+		template <>
+		struct lane_math<double> {
+			inline
+			static double splat(double x) { return x; }
+			inline
+			static double add(double x, double y) { return x + y; }
+			inline
+			static double sub(double x, double y) { return x - y; }
+			inline
+			static double mul(double x, double y) { return x * y; }
+			//x * y + z
+			inline
+			static double madd(double x, double y, double z) { return x * y + z; }
+		};
+
+		template <>
+		struct lane_math<double2_t> {
+			inline
+			static double2_t splat(double x) { return load2(x); }
+			inline
+			static double2_t add(double2_t x, double2_t y) { return std_dsp::add(x, y); }
+			inline
+			static double2_t sub(double2_t x, double2_t y) { return subtract(x, y); }
+			inline
+			static double2_t mul(double2_t x, double2_t y) { return multiply(x, y); }
+			inline
+			static double2_t madd(double2_t x, double2_t y, double2_t z) { return multiply_add(x, y, z); }
+		};
+
+#ifdef STD_DSP_AVX
+		template <>
+		struct lane_math<double4_t> {
+			inline STD_DSP_TARGET_AVX2
+			static double4_t splat(double x) { return load4(x); }
+			inline STD_DSP_TARGET_AVX2
+			static double4_t add(double4_t x, double4_t y) { return std_dsp::add(x, y); }
+			inline STD_DSP_TARGET_AVX2
+			static double4_t sub(double4_t x, double4_t y) { return subtract(x, y); }
+			inline STD_DSP_TARGET_AVX2
+			static double4_t mul(double4_t x, double4_t y) { return multiply(x, y); }
+			inline STD_DSP_TARGET_AVX2
+			static double4_t madd(double4_t x, double4_t y, double4_t z) { return multiply_add(x, y, z); }
+		};
+
+		template <>
+		struct lane_math<double8_t> {
+			inline STD_DSP_TARGET_AVX512
+			static double8_t splat(double x) { return load8(x); }
+			inline STD_DSP_TARGET_AVX512
+			static double8_t add(double8_t x, double8_t y) { return std_dsp::add(x, y); }
+			inline STD_DSP_TARGET_AVX512
+			static double8_t sub(double8_t x, double8_t y) { return subtract(x, y); }
+			inline STD_DSP_TARGET_AVX512
+			static double8_t mul(double8_t x, double8_t y) { return multiply(x, y); }
+			inline STD_DSP_TARGET_AVX512
+			static double8_t madd(double8_t x, double8_t y, double8_t z) { return multiply_add(x, y, z); }
+		};
+#endif
+	}
+
+	// - Interpolators -
+
+	//
+	//  Each interpolator reads taps samples starting first samples from the sample before
+	//  the delayed position, and evaluate(x, f, y) writes to y the value at fraction f in
+	//  [0, 1) between x[-first] and x[-first + 1].
+	//
+
+	struct linear_interpolation {
+		static const integer_t taps = 2;
+		static const integer_t first = 0;
+		static const integer_t max_lookahead = 1;
+
+		template <typename V>
+		ALWAYS_INLINE
+		static void evaluate(const V* x, const V& f, V& y) {
+			using m = detail::lane_math<V>;
+			y = m::madd(f, m::sub(x[1], x[0]), x[0]);
+		}
+	};
+
+	struct hermite_interpolation {
+		static const integer_t taps = 4;
+		static const integer_t first = -1;
+		static const integer_t max_lookahead = 2;
+
+		template <typename V>
+		ALWAYS_INLINE
+		static void evaluate(const V* x, const V& f, V& y) {
+			using m = detail::lane_math<V>;
+			const V half = m::splat(0.5);
+			const V c1 = m::mul(half, m::sub(x[2], x[0]));
+			//x[-1] - 2.5 x[0] + 2 x[1] - 0.5 x[2]
+			const V c2 = m::sub(m::add(x[0], m::add(x[2], x[2])), m::madd(m::splat(2.5), x[1], m::mul(half, x[3])));
+			//0.5 (x[2] - x[-1]) + 1.5 (x[0] - x[1])
+			const V c3 = m::madd(m::splat(1.5), m::sub(x[1], x[2]), m::mul(half, m::sub(x[3], x[0])));
+			y = m::madd(m::madd(m::madd(c3, f, c2), f, c1), f, x[1]);
+		}
+	};
+
+	//
+	//  Lagrange interpolation through ORDER + 1 samples centered on the delayed position,
+	//  exact for polynomials up to degree ORDER. ORDER is odd.
+	//
+	template <integer_t ORDER>
+	struct lagrange_interpolation {
+		static_assert(ORDER >= 1 && ORDER % 2 == 1, "Lagrange interpolation needs an odd order.");
+
+		static const integer_t taps = ORDER + 1;
+		static const integer_t first = -(ORDER - 1) / 2;
+		static const integer_t max_lookahead = first + taps - 1;
+
+		template <typename V>
+		ALWAYS_INLINE
+		static void evaluate(const V* x, const V& f, V& y) {
+			using m = detail::lane_math<V>;
+
+			//The weight of tap j is prod(f - t_k) / prod(t_j - t_k) over k != j, with the
+			//numerator split into the products left and right of j
+			V d[taps];
+			STD_DSP_UNROLL
+			for(integer_t j = 0; j < taps; ++j)
+				d[j] = m::sub(f, m::splat(static_cast<double>(first + j)));
+
+			V left[taps];
+			left[0] = m::splat(1.0);
+			STD_DSP_UNROLL
+			for(integer_t j = 1; j < taps; ++j)
+				left[j] = m::mul(left[j - 1], d[j - 1]);
+
+			V right = m::splat(1.0);
+			y = m::splat(0.0);
+			STD_DSP_UNROLL
+			for(integer_t j = taps - 1; j >= 0; --j) {
+				double denominator = 1.0;
+				for(integer_t k = 0; k < taps; ++k) {
+					if(k != j)
+						denominator *= static_cast<double>(j - k);
+				}
+				y = m::madd(m::mul(x[j], m::splat(1.0 / denominator)), m::mul(left[j], right), y);
+				right = m::mul(right, d[j]);
+			}
+		}
+	};
+
+	//
+	//  First order Thiran allpass. The delay is split into an integer part read directly
+	//  and a fraction in [0.5, 1.5) realized by the allpass, whose output sample is kept
+	//  between blocks. Keep one per channel and reset it when the read jumps.
+	//
+	class thiran_interpolation {
+	private:
+		double y1;
+	public:
+		thiran_interpolation() : y1(0.0) {}
+
+		inline
+		void reset() { y1 = 0.0; }
+
+		//y = a x[n] + x[n - 1] - a y[n - 1]
+		inline
+		double operator()(double x0, double x1, double a) {
+			y1 = a * (x0 - y1) + x1;
+			return y1;
+		}
+	};
+
+	namespace detail {
+		//Samples per gathered block
+		static const integer_t interpolation_block = 256;
+
+		template <typename INTERPOLATOR, typename V, typename N>
+		ALWAYS_INLINE
+		N interpolate_kernel(const double* x, const double* f, N n, double* out) {
+			using traits = vector_traits<V>;
+			N i = 0;
+			for(; i + traits::lanes <= n; i += traits::lanes) {
+				V t[INTERPOLATOR::taps];
+				STD_DSP_UNROLL
+				for(integer_t j = 0; j < INTERPOLATOR::taps; ++j)
+					t[j] = traits::template load<true>(x + j * interpolation_block, i);
+				const V fraction = traits::template load<true>(f, i);
+				V y;
+				INTERPOLATOR::evaluate(t, fraction, y);
+				traits::template store<false>(out, i, y);
+			}
+			return i;
+		}
+
+		template <typename INTERPOLATOR, typename N>
+		inline
+		N interpolate_sse(const double* x, const double* f, N n, double* out) {
+			return interpolate_kernel<INTERPOLATOR, double2_t>(x, f, n, out);
+		}
+
+#ifdef STD_DSP_AVX
+		template <typename INTERPOLATOR, typename N>
+		inline STD_DSP_TARGET_AVX2
+		N interpolate_avx2(const double* x, const double* f, N n, double* out) {
+			return interpolate_kernel<INTERPOLATOR, double4_t>(x, f, n, out);
+		}
+
+		template <typename INTERPOLATOR, typename N>
+		inline STD_DSP_TARGET_AVX512
+		N interpolate_avx512(const double* x, const double* f, N n, double* out) {
+			return interpolate_kernel<INTERPOLATOR, double8_t>(x, f, n, out);
+		}
+#endif
+
+		//Evaluates n gathered samples, rows of interpolation_block, into out
+		template <typename INTERPOLATOR, typename N>
+		inline
+		void interpolate_rows(const double* x, const double* f, N n, double* out) {
+			N done = 0;
+#ifdef STD_DSP_AVX
+			if(use_avx512())
+				done = interpolate_avx512<INTERPOLATOR>(x, f, n, out);
+			else if(use_avx2())
+				done = interpolate_avx2<INTERPOLATOR>(x, f, n, out);
+#endif
+			//The vector widths are powers of two, so the rows stay aligned
+			done += interpolate_sse<INTERPOLATOR>(x + done, f + done, n - done, out + done);
+
+			for(; done < n; ++done) {
+				double t[INTERPOLATOR::taps];
+				for(integer_t j = 0; j < INTERPOLATOR::taps; ++j)
+					t[j] = x[j * interpolation_block + done];
+				INTERPOLATOR::evaluate(t, f[done], out[done]);
+			}
+		}
+
+		template <typename INTERPOLATOR>
+		struct is_fir_interpolator : std::true_type {};
+
+		template <>
+		struct is_fir_interpolator<thiran_interpolation> : std::false_type {};
+	}
+
+	//
+	//  Reads n samples from the circular buffer [first, first + size), sample k delays[k]
+	//  samples behind position pos + k, wrapping indices with the WRAP policy of the
+	//  buffer (see delay_line.h).
+	//  Preconditions:
+	//  pos lies in [0, size), every delay lies in the range of the interpolator.
+	//
+	template <typename WRAP, typename INTERPOLATOR>
+	inline
+	typename std::enable_if<detail::is_fir_interpolator<typename std::decay<INTERPOLATOR>::type>::value>::type
+	fractional_delay_read(const double* first, integer_t size, integer_t pos, const double* delays, integer_t n, double* out, INTERPOLATOR&&) {
+		using interpolator = typename std::decay<INTERPOLATOR>::type;
+		const integer_t taps = interpolator::taps;
+
+		CACHE_ALIGN double x[taps * detail::interpolation_block];
+		CACHE_ALIGN double f[detail::interpolation_block];
+
+		while(n > 0) {
+			const integer_t block = n < detail::interpolation_block ? n : detail::interpolation_block;
+
+			for(integer_t k = 0; k < block; ++k) {
+				assert(delays[k] >= static_cast<double>(interpolator::max_lookahead) && delays[k] <= static_cast<double>(size - taps));
+				const double p = static_cast<double>(pos + k) - delays[k];
+				const double i = std::floor(p);
+				f[k] = p - i;
+
+				const integer_t start = WRAP::forward(WRAP::reverse(static_cast<integer_t>(i) + interpolator::first, size), size);
+				for(integer_t j = 0; j < taps; ++j)
+					x[j * detail::interpolation_block + k] = first[WRAP::forward(start + j, size)];
+			}
+
+			detail::interpolate_rows<interpolator>(x, f, block, out);
+
+			pos = WRAP::forward(pos + block, size);
+			delays += block;
+			out += block;
+			n -= block;
+		}
+	}
+
+	template <typename WRAP>
+	inline
+	void fractional_delay_read(const double* first, integer_t size, integer_t pos, const double* delays, integer_t n, double* out, thiran_interpolation& allpass) {
+		CACHE_ALIGN double x0[detail::interpolation_block];
+		CACHE_ALIGN double x1[detail::interpolation_block];
+		CACHE_ALIGN double a[detail::interpolation_block];
+
+		while(n > 0) {
+			const integer_t block = n < detail::interpolation_block ? n : detail::interpolation_block;
+
+			for(integer_t k = 0; k < block; ++k) {
+				assert(delays[k] >= 0.5 && delays[k] <= static_cast<double>(size - 2));
+				const double whole = std::floor(delays[k] - 0.5);
+				const double d = delays[k] - whole;
+				a[k] = (1.0 - d) / (1.0 + d);
+
+				const integer_t i = WRAP::forward(WRAP::reverse(pos + k - static_cast<integer_t>(whole), size), size);
+				x0[k] = first[i];
+				x1[k] = first[WRAP::reverse(i - 1, size)];
+			}
+
+			for(integer_t k = 0; k < block; ++k)
+				out[k] = allpass(x0[k], x1[k], a[k]);
+
+			pos = WRAP::forward(pos + block, size);
+			delays += block;
+			out += block;
+			n -= block;
+		}
+	}
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif
@@ -10,9 +10,12 @@ namespace std_dsp {
 	private:
 		I it;
 		integer_t stride;
+		integer_t length;
 	public:
 		channel_iterator() {}
-		channel_iterator(I it, integer_t stride) : it(it), stride(stride) {}
+		channel_iterator(I it, integer_t stride) : it(it), stride(stride), length(stride) {}
+		//Channels of n samples whose starts are stride samples apart, for padded storage
+		channel_iterator(I it, integer_t stride, integer_t n) : it(it), stride(stride), length(n) {}
 
 		inline
 		double* begin() {
@@ -20,7 +23,7 @@ namespace std_dsp {
 		}
 		inline
 		double* end() {
-			return it + stride;
+			return it + length;
 		}
 		inline
 		const double* begin() const {
@@ -28,7 +31,7 @@ namespace std_dsp {
 		}
 		inline
 		const double* end() const {
-			return it + stride;
+			return it + length;
 		}
 		inline
 		const double* cbegin() {
@@ -36,7 +39,7 @@ namespace std_dsp {
 		}
 		inline
 		const double* cend() {
-			return it + stride;
+			return it + length;
 		}
 		inline
 		const double* cbegin() const {
@@ -44,7 +47,7 @@ namespace std_dsp {
 		}
 		inline
 		const double* cend() const {
-			return it + stride;
+			return it + length;
 		}
 
 		inline
@@ -110,6 +113,11 @@ namespace std_dsp {
 	channel_iterator<I> make_channel_iterator(I first, integer_t stride) {
 		return channel_iterator<I>(first, stride);
 	}
+
+	template <typename I>
+	channel_iterator<I> make_channel_iterator(I first, integer_t stride, integer_t n) {
+		return channel_iterator<I>(first, stride, n);
+	}
 }
 
 #endif
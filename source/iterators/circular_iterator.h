@@ -53,6 +53,25 @@ namespace std_dsp {
 				return i + buf_size;
 			return i;
 		}
+
+		//Any index, either direction, for power of two sizes (mask = size - 1).
+		//Two's complement makes negative indices wrap as well.
+		inline
+		integer_t wrap_mask(integer_t i, integer_t mask) {
+			return i & mask;
+		}
+
+		inline
+		bool is_power_of_two(integer_t n) {
+			return n > 0 && (n & (n - 1)) == 0;
+		}
+		inline
+		integer_t next_power_of_two(integer_t n) {
+			integer_t p = 1;
+			while (p < n)
+				p <<= 1;
+			return p;
+		}
 	}
 
 	template <typename I>
@@ -191,7 +210,7 @@ namespace std_dsp {
 		friend
 		circular_iterator make_delay_iterator(circular_iterator it, integer_t delay) {
 			//assert(delay >= 0);
-			return circular_iterator(it,offset, detail::wrap_bidirectional(it.pos - delay), it.size);
+			return circular_iterator(it.offset, detail::wrap_reverse(it.pos - delay, it.size), it.size);
 		}
 	};
 
@@ -200,6 +219,156 @@ namespace std_dsp {
 		return circular_iterator<I>(it, pos, size);
 	}
 
+	//
+	//  Circular iterator over a power of two sized buffer. Every step and random access
+	//  wraps with a mask instead of a compare, so offsets in either direction cost the
+	//  same and multi-tap reads through operator[] have no branches.
+	//
+	template <typename I>
+	class masked_circular_iterator {
+	private:
+		I offset;
+		integer_t pos;
+		integer_t mask;
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = typename std::iterator_traits<I>::value_type;
+		using difference_type = integer_t;
+		using pointer = typename std::iterator_traits<I>::pointer;
+		using reference = typename std::iterator_traits<I>::reference;
+
+		masked_circular_iterator() {}
+		//Preconditions: size is a power of two and 0 <= pos < size
+		masked_circular_iterator(I offset, integer_t pos, integer_t size) : offset(offset), pos(pos), mask(size - 1) {
+			assert(detail::is_power_of_two(size));
+			assert(pos >= 0 && pos < size);
+		}
+
+		inline
+		masked_circular_iterator& operator++() { pos = detail::wrap_mask(pos + 1, mask); return *this; }
+		inline
+		masked_circular_iterator operator++(int) {
+			auto tmp = *this;
+			pos = detail::wrap_mask(pos + 1, mask);
+			return tmp;
+		}
+		inline
+		masked_circular_iterator& operator--() { pos = detail::wrap_mask(pos - 1, mask); return *this; }
+		inline
+		masked_circular_iterator operator--(int) {
+			auto tmp = *this;
+			pos = detail::wrap_mask(pos - 1, mask);
+			return tmp;
+		}
+
+		inline
+		masked_circular_iterator& operator+=(integer_t n) {
+			pos = detail::wrap_mask(pos + n, mask);
+			return *this;
+		}
+		inline
+		masked_circular_iterator& operator-=(integer_t n) {
+			pos = detail::wrap_mask(pos - n, mask);
+			return *this;
+		}
+
+		inline
+		masked_circular_iterator operator+(integer_t n) const {
+			masked_circular_iterator tmp = *this;
+			tmp += n;
+			return tmp;
+		}
+		inline
+		masked_circular_iterator operator-(integer_t n) const {
+			masked_circular_iterator tmp = *this;
+			tmp -= n;
+			return tmp;
+		}
+
+		//Distance walking forward from x, in [0, size)
+		inline
+		integer_t operator-(masked_circular_iterator x) const {
+			return detail::wrap_mask(pos - x.pos, mask);
+		}
+
+		inline
+		reference operator*() const {
+			return offset[pos];
+		}
+		inline
+		reference operator[](integer_t n) const {
+			return offset[detail::wrap_mask(pos + n, mask)];
+		}
+
+		inline
+		friend
+		bool operator==(const masked_circular_iterator& x, const masked_circular_iterator& y) {
+			return x.offset == y.offset && x.pos == y.pos;
+		}
+		inline
+		friend
+		bool operator!=(const masked_circular_iterator& x, const masked_circular_iterator& y) {
+			return !(x == y);
+		}
+
+		inline
+		integer_t position() const { return pos; }
+		inline
+		integer_t size() const { return mask + 1; }
+
+		//
+		//  Computational basis functions
+		//
+		inline
+		I get_iterator() const {
+			return offset + pos;
+		}
+
+		inline
+		friend
+		bool is_odd_aligned(masked_circular_iterator it) {
+			return is_odd_aligned(it.offset + it.pos);
+		}
+
+		inline
+		friend
+		bool supports_fast_processing(masked_circular_iterator it) {
+			return supports_fast_processing(it.offset);
+		}
+		//Contiguous samples up to the end of the buffer
+		inline
+		friend
+		integer_t fast_count(masked_circular_iterator it, integer_t n) {
+			return (std::min)(it.mask + 1 - it.pos, n);
+		}
+		inline
+		friend
+		integer_t fast_reverse_count(masked_circular_iterator it, integer_t n) {
+			return (std::min)(it.pos, n);
+		}
+		inline
+		friend
+		std::size_t get_alignment(masked_circular_iterator it) {
+			return get_alignment(it.offset + it.pos);
+		}
+
+		inline
+		friend
+		masked_circular_iterator make_delay_iterator(masked_circular_iterator it, integer_t delay) {
+			return it - delay;
+		}
+	};
+
+	template <typename I>
+	masked_circular_iterator<I> make_masked_circular_iterator(I it, integer_t pos, integer_t size) {
+		return masked_circular_iterator<I>(it, pos, size);
+	}
+
+	template <typename I>
+	auto get_fast_iterator(masked_circular_iterator<I> it) -> decltype(get_fast_iterator(it.get_iterator())) {
+		return get_fast_iterator(it.get_iterator());
+	}
+
 	template <typename I>
 	auto get_fast_iterator(circular_iterator<I> it) -> decltype(get_fast_iterator(it.get_iterator())) {
 		return get_fast_iterator(it.get_iterator());
@@ -1,78 +1,208 @@
 
-#ifndef BUFFER_ALLOCATOR_GUARD
-#define BUFFER_ALLOCATOR_GUARD
+#ifndef STD_DSP_BUFFER_ALLOCATOR_GUARD
+#define STD_DSP_BUFFER_ALLOCATOR_GUARD
 
 #include <cstdint>
 #include <cassert>
+#include <new>
 
-inline
-std::int32_t align_size(std::int32_t size) {
-	assert(size >= 0);
-	if(size & 1 == 1)
-		return size + 1;
-	return size;
-}
+#include "../base/base.h"
+#include "../base/std_dsp_mem.h"
 
-template<std::int32_t SIZE>
-class stack {
-private:
-	std::int32_t pos_;
-	SSE_ALIGN double memory_[SIZE];
+//
+//  Real-time scratch arena.
+//
+//  A bump pointer allocator for the temporaries of one processing call. Capacity is
+//  reserved up front, outside the audio thread, and buffers are then taken and given
+//  back in LIFO order without touching the heap:
+//
+//  std_dsp::scratch_arena<4096> arena;
+//  ...
+//  std_dsp::scratch_arena<4096>::buffer tmp(arena, n);
+//  std_dsp::copy(in, n, tmp.get());
+//
+//  Every buffer starts on a cache line. What happens when a request does not fit is
+//  decided by the OVERFLOW_POLICY. With TRACK the arena records the largest amount
+//  ever in use and the number of overflows, to size the capacity in testing.
+//
 
-#ifdef DEBUG_THE_STACK
-	std::int32_t max_used_;
-#endif
-public:
-	class buffer {
-	private:
-		stack* owner_;
-		std::int32_t size_;
-		double* ptr_;
-	public:
-		buffer(stack* owner, std::int32_t size) : owner_(owner) {
-			size_ = align_size(size);
-			ptr_ = &owner->memory[owner->pos_];
-			owner->pos_ += size_;
-#ifdef DEBUG_THE_STACK
-			if(owner->max_pos_ < owner->pos_)
-				owner->max_pos_ = owner->pos_;
-#endif
-		}
-		buffer(const buffer&) = delete;
-		buffer(buffer&&) = delete;
-		~buffer() {
-			owner_->pos -= size_;
-		}
+namespace std_dsp {
+	//Overflow policies. allocate is called with the rounded size of a request that does not
+	//fit in the arena and deallocate with what it returned, when the buffer is released.
 
+	//Throws std::bad_alloc, like alloc_buf
+	struct throw_on_overflow {
 		inline
-		double* get() {
-			return ptr_;
-		}
+		static double* allocate(integer_t) { throw std::bad_alloc(); }
+		inline
+		static void deallocate(double*) {}
 	};
 
-	stack() : pos_(0) {
-#ifdef DEBUG_THE_STACK
-		max_used_ = 0;
-#endif
-		;
-	}
-	~stack() {
-		assert(pos_ == 0);
-	}
+	//Returns nullptr for the caller to handle, for code that must never throw or allocate
+	struct null_on_overflow {
+		inline
+		static double* allocate(integer_t) { return nullptr; }
+		inline
+		static void deallocate(double*) {}
+	};
 
-#ifdef DEBUG_THE_STACK
-	std::int32_t get_max_used() {
-		return max_used_;
+	//Falls back to the heap. Not real-time safe, but degrades gracefully when the capacity was underestimated.
+	struct heap_on_overflow {
+		inline
+		static double* allocate(integer_t n) { return alloc_buf(n); }
+		inline
+		static void deallocate(double* p) { free_buf(p); }
+	};
+
+	namespace detail {
+		template <integer_t SIZE>
+		class arena_memory {
+		private:
+			CACHE_ALIGN double memory[cache_line_stride::fixed<SIZE>::value];
+		public:
+			inline
+			double* get() { return memory; }
+			inline
+			integer_t capacity() const { return cache_line_stride::fixed<SIZE>::value; }
+		};
+
+		//Capacity chosen at run time
+		template <>
+		class arena_memory<0LL> {
+		private:
+			dynamic_storage<1> memory;
+		public:
+			inline
+			double* get() { return memory.begin(); }
+			inline
+			integer_t capacity() const { return memory.size(); }
+			inline
+			void reserve(integer_t n) { memory.resize(cache_line_stride::stride(n)); }
+		};
+
+		template <bool TRACK>
+		class arena_statistics {
+		protected:
+			inline
+			void record_use(integer_t) {}
+			inline
+			void record_overflow() {}
+		public:
+			inline
+			integer_t high_water_mark() const { return 0LL; }
+			inline
+			integer_t overflows() const { return 0LL; }
+			inline
+			void reset_statistics() {}
+		};
+
+		template <>
+		class arena_statistics<true> {
+		private:
+			integer_t max_used = 0LL;
+			integer_t overflow_count = 0LL;
+		protected:
+			inline
+			void record_use(integer_t used) {
+				if(max_used < used)
+					max_used = used;
+			}
+			inline
+			void record_overflow() { ++overflow_count; }
+		public:
+			inline
+			integer_t high_water_mark() const { return max_used; }
+			inline
+			integer_t overflows() const { return overflow_count; }
+			inline
+			void reset_statistics() {
+				max_used = 0LL;
+				overflow_count = 0LL;
+			}
+		};
 	}
-#endif
-};
 
-using stack_buffer = stack::buffer;
+	template <integer_t SIZE = 0LL, typename OVERFLOW_POLICY = throw_on_overflow, bool TRACK = false>
+	class scratch_arena : public detail::arena_statistics<TRACK> {
+	private:
+		detail::arena_memory<SIZE> memory;
+		integer_t pos;
+	public:
+		//Scoped allocation of n samples. Buffers must be destroyed in the reverse order of construction.
+		class buffer {
+		private:
+			scratch_arena* owner;
+			double* ptr;
+			integer_t length;
+			integer_t reserved;
+		public:
+			buffer(scratch_arena& arena, integer_t n) : owner(&arena), length(n) {
+				assert(n >= 0LL);
 
-//
-// Allocate a stack buffer by:
-// stack_buffer buf(stack, count);
-// buf.get() yields a pointer to the buffer
-//
+				reserved = cache_line_stride::stride(n);
+				if(reserved <= arena.available()) {
+					ptr = arena.memory.get() + arena.pos;
+					arena.pos += reserved;
+					arena.record_use(arena.pos);
+				} else {
+					arena.record_overflow();
+					ptr = OVERFLOW_POLICY::allocate(reserved);
+					reserved = 0LL;
+				}
+			}
+			buffer(const buffer&) = delete;
+			buffer& operator=(const buffer&) = delete;
+			~buffer() {
+				if(reserved == 0LL) {
+					if(ptr != nullptr && length != 0LL)
+						OVERFLOW_POLICY::deallocate(ptr);
+					return;
+				}
+
+				//Out of order release would hand the same memory out twice
+				assert(ptr + reserved == owner->memory.get() + owner->pos);
+				owner->pos -= reserved;
+			}
+
+			inline
+			double* get() { return ptr; }
+			inline
+			const double* get() const { return ptr; }
+			inline
+			integer_t size() const { return length; }
+			inline
+			double* begin() { return ptr; }
+			inline
+			const double* begin() const { return ptr; }
+			inline
+			double* end() { return ptr + length; }
+			inline
+			const double* end() const { return ptr + length; }
+		};
+
+		scratch_arena() : pos(0LL) {}
+		explicit scratch_arena(integer_t n) : pos(0LL) { reserve(n); }
+		scratch_arena(const scratch_arena&) = delete;
+		scratch_arena& operator=(const scratch_arena&) = delete;
+		~scratch_arena() {
+			assert(pos == 0LL);
+		}
+
+		//Capacity of a run time sized arena. Allocates, so call before processing starts.
+		inline
+		void reserve(integer_t n) {
+			static_assert(SIZE == 0LL, "The capacity of a fixed size arena cannot be changed");
+			assert(pos == 0LL);
+			memory.reserve(n);
+		}
+
+		inline
+		integer_t capacity() const { return memory.capacity(); }
+		inline
+		integer_t used() const { return pos; }
+		inline
+		integer_t available() const { return capacity() - pos; }
+	};
+}
 
 #endif
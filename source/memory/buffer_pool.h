@@ -0,0 +1,147 @@
+
+#ifndef STD_DSP_BUFFER_POOL_GUARD
+#define STD_DSP_BUFFER_POOL_GUARD
+
+#include <cstdint>
+#include <cassert>
+
+#include "../base/base.h"
+#include "../base/std_dsp_mem.h"
+
+//
+//  Recycling buffer pool.
+//
+//  Blocks are rounded up to a power of two size class and returned to a free list of
+//  that class on deallocation instead of to the heap, so rebuilding a graph or changing
+//  the block size reuses earlier allocations. reserve preallocates blocks ahead of time
+//  for code that must not allocate at all once processing has started.
+//
+//  A pool is not synchronized. pool_allocator uses the pool of whichever thread calls it
+//  unless given one, so a block released on another thread simply joins that thread's
+//  pool. An allocator given a pool must only be used on one thread at a time.
+//
+
+namespace std_dsp {
+	class buffer_pool {
+	private:
+		//The smallest class is one cache line
+		static const int min_class = 3;
+		static const int class_count = 64;
+
+		//Free blocks form a list through their first sample
+		struct free_block {
+			free_block* next;
+		};
+
+		free_block* free_lists[class_count];
+		integer_t cached_count;
+
+		inline
+		static int size_class(integer_t n) {
+			assert(n > 0LL);
+			int c = min_class;
+			while((integer_t(1) << c) < n)
+				++c;
+			return c;
+		}
+	public:
+		buffer_pool() : cached_count(0LL) {
+			for(int i = 0; i < class_count; ++i)
+				free_lists[i] = nullptr;
+		}
+		buffer_pool(const buffer_pool&) = delete;
+		buffer_pool& operator=(const buffer_pool&) = delete;
+		~buffer_pool() {
+			release();
+		}
+
+		//Capacity in samples of the block that serves a request for n samples
+		inline
+		static integer_t block_size(integer_t n) {
+			return integer_t(1) << size_class(n);
+		}
+
+		inline
+		double* allocate(integer_t n) {
+			const int c = size_class(n);
+			free_block* b = free_lists[c];
+			if(b == nullptr)
+				return alloc_buf(integer_t(1) << c);
+
+			free_lists[c] = b->next;
+			--cached_count;
+			return reinterpret_cast<double*>(b);
+		}
+
+		//n must be the size the block was allocated with, or any size of the same class
+		inline
+		void deallocate(double* p, integer_t n) {
+			if(p == nullptr)
+				return;
+
+			const int c = size_class(n);
+			free_block* b = reinterpret_cast<free_block*>(p);
+			b->next = free_lists[c];
+			free_lists[c] = b;
+			++cached_count;
+		}
+
+		//Makes sure count blocks of the class serving n samples are cached
+		inline
+		void reserve(integer_t n, integer_t count = 1LL) {
+			const int c = size_class(n);
+			integer_t have = 0LL;
+			for(free_block* b = free_lists[c]; b != nullptr; b = b->next)
+				++have;
+			for(; have < count; ++have)
+				deallocate(alloc_buf(integer_t(1) << c), n);
+		}
+
+		//Returns every cached block to the heap
+		inline
+		void release() {
+			for(int i = 0; i < class_count; ++i) {
+				while(free_lists[i] != nullptr) {
+					free_block* b = free_lists[i];
+					free_lists[i] = b->next;
+					free_buf(reinterpret_cast<double*>(b));
+				}
+			}
+			cached_count = 0LL;
+		}
+
+		//Number of blocks held for reuse
+		inline
+		integer_t cached() const { return cached_count; }
+	};
+
+	//The pool pool_allocator uses by default, one per thread
+	inline
+	buffer_pool& thread_buffer_pool() {
+		static thread_local buffer_pool pool;
+		return pool;
+	}
+
+	//dynamic_storage allocator drawing from a buffer_pool
+	class pool_allocator {
+	private:
+		//Null for the pool of the calling thread, looked up on every call
+		buffer_pool* pool;
+	public:
+		pool_allocator() : pool(nullptr) {}
+		explicit pool_allocator(buffer_pool& p) : pool(&p) {}
+
+		inline
+		double* allocate(integer_t n) { return get_pool().allocate(n); }
+		inline
+		void deallocate(double* p, integer_t n) { get_pool().deallocate(p, n); }
+
+		inline
+		buffer_pool& get_pool() const { return pool != nullptr ? *pool : thread_buffer_pool(); }
+	};
+
+	template <integer_t CHANNELS = 0LL, typename STRIDE = default_stride>
+	using pooled_storage = dynamic_storage<CHANNELS, STRIDE, pool_allocator>;
+}
+
+#endif
@@ -0,0 +1,235 @@
+
+#ifndef STD_DSP_MIRRORED_STORAGE_GUARD
+#define STD_DSP_MIRRORED_STORAGE_GUARD
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cassert>
+#include <algorithm>
+#include <new>
+
+#ifdef WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../base/base.h"
+#include "../base/std_dsp_mem.h"
+
+//
+//  Double mapped ring buffer storage.
+//
+//  The pages of every channel are mapped twice, back to back, so begin(c)[i] and
+//  begin(c)[i + size()] are the same sample. Any window of up to size() samples starting
+//  inside a channel is then contiguous in virtual memory, and circular reads and writes
+//  hand plain pointers to the vector kernels without splitting at the wrap point.
+//
+//  size() is rounded up to whole pages (whole allocation granules on Windows), 512
+//  samples with 4 KiB pages. The mapping is made by resize, which is a system call, so
+//  size the storage before processing starts.
+//
+
+namespace std_dsp {
+	//Channels are two copies of the ring apart
+	struct mirrored_stride {
+		inline
+		static integer_t stride(integer_t n) { return 2 * n; }
+	};
+
+	namespace detail {
+		//Bytes that the ring of one channel is rounded to
+		inline
+		std::size_t mirror_granularity() {
+#ifdef WIN32
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			return static_cast<std::size_t>(info.dwAllocationGranularity);
+#else
+			return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+		}
+
+		//Maps channels rings of bytes each, twice per ring, into one reservation. Returns nullptr on failure.
+		inline
+		double* map_mirrored(integer_t channels, std::size_t bytes) {
+			const std::size_t total = static_cast<std::size_t>(channels) * bytes;
+#ifdef WIN32
+			const ULONGLONG file_size = static_cast<ULONGLONG>(total);
+			HANDLE h = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+				static_cast<DWORD>(file_size >> 32), static_cast<DWORD>(file_size & 0xFFFFFFFFu), nullptr);
+			if(h == nullptr)
+				return nullptr;
+
+			//The reservation can only be probed, not kept, so another thread may take the
+			//range between releasing it and mapping the views. Retry a few times.
+			char* base = nullptr;
+			for(int attempt = 0; attempt < 16 && base == nullptr; ++attempt) {
+				char* p = static_cast<char*>(VirtualAlloc(nullptr, 2 * total, MEM_RESERVE, PAGE_NOACCESS));
+				if(p == nullptr)
+					break;
+				VirtualFree(p, 0, MEM_RELEASE);
+
+				integer_t mapped = 0;
+				for(; mapped < 2 * channels; ++mapped) {
+					const ULONGLONG offset = static_cast<ULONGLONG>(mapped / 2) * bytes;
+					void* view = MapViewOfFileEx(h, FILE_MAP_ALL_ACCESS,
+						static_cast<DWORD>(offset >> 32), static_cast<DWORD>(offset & 0xFFFFFFFFu), bytes, p + mapped * bytes);
+					if(view == nullptr)
+						break;
+				}
+
+				if(mapped == 2 * channels) {
+					base = p;
+				} else {
+					for(integer_t i = 0; i < mapped; ++i)
+						UnmapViewOfFile(p + i * bytes);
+				}
+			}
+
+			//The views keep the section alive
+			CloseHandle(h);
+			return reinterpret_cast<double*>(base);
+#else
+#if defined(__linux__)
+			int fd = memfd_create("std_dsp_mirrored_storage", MFD_CLOEXEC);
+#else
+			//shm_open with a name that is unlinked straight away
+			char name[64];
+			int fd = -1;
+			for(int attempt = 0; attempt < 16 && fd < 0; ++attempt) {
+				std::snprintf(name, sizeof(name), "/std_dsp_mirror_%d_%d", static_cast<int>(getpid()), attempt);
+				fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+			}
+			if(fd >= 0)
+				shm_unlink(name);
+#endif
+			if(fd < 0)
+				return nullptr;
+			if(ftruncate(fd, static_cast<off_t>(total)) != 0) {
+				close(fd);
+				return nullptr;
+			}
+
+			char* base = static_cast<char*>(mmap(nullptr, 2 * total, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+			if(base == MAP_FAILED) {
+				close(fd);
+				return nullptr;
+			}
+
+			for(integer_t i = 0; i < 2 * channels; ++i) {
+				const off_t offset = static_cast<off_t>((i / 2) * bytes);
+				if(mmap(base + i * bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, offset) == MAP_FAILED) {
+					munmap(base, 2 * total);
+					close(fd);
+					return nullptr;
+				}
+			}
+
+			//The mappings keep the file alive
+			close(fd);
+			return reinterpret_cast<double*>(base);
+#endif
+		}
+
+		inline
+		void unmap_mirrored(double* p, integer_t channels, std::size_t bytes) {
+			if(p == nullptr)
+				return;
+#ifdef WIN32
+			char* base = reinterpret_cast<char*>(p);
+			for(integer_t i = 0; i < 2 * channels; ++i)
+				UnmapViewOfFile(base + i * bytes);
+#else
+			munmap(p, 2 * static_cast<std::size_t>(channels) * bytes);
+#endif
+		}
+	}
+
+	template <integer_t CHANNELS = 1LL>
+	class mirrored_storage : public detail::storage_base<mirrored_storage<CHANNELS>, mirrored_stride> {
+	private:
+		double* data;
+		integer_t buf_size;
+	public:
+		mirrored_storage() : data(nullptr), buf_size(0LL) {}
+		explicit mirrored_storage(integer_t n) : data(nullptr), buf_size(0LL) { resize(n); }
+		mirrored_storage(const mirrored_storage& x) : data(nullptr), buf_size(0LL) {
+			resize(x.size());
+			for(integer_t c = 0; c < CHANNELS; ++c)
+				std::copy_n(x.begin(c), x.size(), this->begin(c));
+		}
+		mirrored_storage(mirrored_storage&& x) : data(x.data), buf_size(x.buf_size) {
+			x.data = nullptr;
+			x.buf_size = 0LL;
+		}
+		~mirrored_storage() {
+			detail::unmap_mirrored(data, CHANNELS, static_cast<std::size_t>(buf_size) * sizeof(double));
+		}
+
+		mirrored_storage& operator=(const mirrored_storage& x) {
+			mirrored_storage tmp(x);
+			swap(tmp);
+			return *this;
+		}
+		mirrored_storage& operator=(mirrored_storage&& x) {
+			if(this == &x)
+				return *this;
+			swap(x);
+			return *this;
+		}
+
+		inline
+		void swap(mirrored_storage& x) {
+			using std::swap;
+			swap(data, x.data);
+			swap(buf_size, x.buf_size);
+		}
+
+		inline
+		double* get() { return data; }
+		inline
+		const double* get() const { return data; }
+		inline
+		integer_t channels() const { return CHANNELS; }
+		inline
+		integer_t size() const { return buf_size; }
+
+		//Samples per channel for a request of n, whole pages
+		inline
+		static integer_t capacity(integer_t n) {
+			const integer_t granule = static_cast<integer_t>(detail::mirror_granularity() / sizeof(double));
+			return (n + granule - 1) / granule * granule;
+		}
+
+		//Maps new zeroed rings of at least n samples each; the contents are not kept
+		inline
+		void resize(integer_t n) {
+			const integer_t m = capacity(n);
+			if(m == buf_size)
+				return;
+
+			double* p = nullptr;
+			if(m != 0LL) {
+				p = detail::map_mirrored(CHANNELS, static_cast<std::size_t>(m) * sizeof(double));
+				if(p == nullptr)
+					throw std::bad_alloc();
+			}
+			detail::unmap_mirrored(data, CHANNELS, static_cast<std::size_t>(buf_size) * sizeof(double));
+			data = p;
+			buf_size = m;
+		}
+	};
+
+	template <integer_t CHANNELS>
+	inline
+	void swap(mirrored_storage<CHANNELS>& x, mirrored_storage<CHANNELS>& y) {
+		x.swap(y);
+	}
+}
+
+#endif
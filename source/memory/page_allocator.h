@@ -0,0 +1,193 @@
+
+#ifndef STD_DSP_PAGE_ALLOCATOR_GUARD
+#define STD_DSP_PAGE_ALLOCATOR_GUARD
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <new>
+
+#ifdef WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "../base/base.h"
+#include "../base/std_dsp_mem.h"
+
+//
+//  Page allocator for large, long lived storage such as delay and reverb memory.
+//
+//  Every block is mapped directly from the OS, backed by huge pages where possible,
+//  optionally prefaulted and locked into RAM, so the first read of a long delay on the
+//  audio thread neither faults nor walks thousands of 4 KiB TLB entries. Each block costs
+//  at least one page, so use it for a few large buffers rather than many small ones.
+//
+//  Every step is best effort: explicit huge pages fall back to transparent huge pages and
+//  those to normal pages, and a failed lock (RLIMIT_MEMLOCK, missing privilege) leaves the
+//  block usable but pageable. Only a failed mapping throws std::bad_alloc.
+//
+
+namespace std_dsp {
+	namespace page_options {
+		enum : unsigned {
+			//Ask the kernel to back the block with transparent huge pages
+			transparent_huge_pages = 1u << 0,
+			//Map from the reserved huge page pool (MAP_HUGETLB, MEM_LARGE_PAGES)
+			explicit_huge_pages = 1u << 1,
+			//Touch every page at allocation
+			prefault = 1u << 2,
+			//Lock the pages into RAM
+			lock = 1u << 3,
+
+			defaults = transparent_huge_pages | prefault | lock
+		};
+	}
+
+	class page_allocator {
+	private:
+		unsigned options;
+
+		static const std::size_t huge_page_size = std::size_t(2) << 20;
+
+		inline
+		static std::size_t page_size() {
+#ifdef WIN32
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			return static_cast<std::size_t>(info.dwPageSize);
+#else
+			return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+		}
+
+		inline
+		std::size_t mapped_bytes(integer_t n) const {
+			const std::size_t bytes = static_cast<std::size_t>(n) * sizeof(double);
+			const std::size_t granularity = (options & (page_options::transparent_huge_pages | page_options::explicit_huge_pages)) != 0 ? huge_page_size : page_size();
+			return (bytes + granularity - 1) & ~(granularity - 1);
+		}
+
+		inline
+		void* map(std::size_t bytes) const {
+#ifdef WIN32
+			void* p = nullptr;
+			const std::size_t large = static_cast<std::size_t>(GetLargePageMinimum());
+			if((options & page_options::explicit_huge_pages) != 0 && large != 0 && bytes % large == 0)
+				p = VirtualAlloc(nullptr, bytes, MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if(p == nullptr)
+				p = VirtualAlloc(nullptr, bytes, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+			return p;
+#else
+			void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+			if((options & page_options::explicit_huge_pages) != 0)
+				p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+			if(p == MAP_FAILED) {
+				if((options & (page_options::transparent_huge_pages | page_options::explicit_huge_pages)) == 0) {
+					p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+					return p == MAP_FAILED ? nullptr : p;
+				}
+
+				//Transparent huge pages only back 2 MiB aligned ranges, so map a huge page more
+				//and unmap what lies outside the aligned range, leaving exactly bytes mapped
+				p = mmap(nullptr, bytes + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if(p == MAP_FAILED)
+					return nullptr;
+				char* const first = static_cast<char*>(p);
+				char* const aligned = reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(first) + huge_page_size - 1) & ~std::uintptr_t(huge_page_size - 1));
+				if(aligned != first)
+					munmap(first, static_cast<std::size_t>(aligned - first));
+				if(aligned + bytes != first + bytes + huge_page_size)
+					munmap(aligned + bytes, static_cast<std::size_t>(first + huge_page_size - aligned));
+				p = aligned;
+#ifdef MADV_HUGEPAGE
+				madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+			}
+			return p;
+#endif
+		}
+	public:
+		explicit page_allocator(unsigned options = page_options::defaults) : options(options) {}
+
+		inline
+		double* allocate(integer_t n) {
+			const std::size_t bytes = mapped_bytes(n);
+			void* p = map(bytes);
+			if(p == nullptr)
+				throw std::bad_alloc();
+
+			if((options & page_options::prefault) != 0) {
+				//Writing, not reading, so copy on write zero pages become real ones
+				const std::size_t step = page_size();
+				volatile char* c = static_cast<char*>(p);
+				for(std::size_t i = 0; i < bytes; i += step)
+					c[i] = 0;
+			}
+
+			if((options & page_options::lock) != 0) {
+#ifdef WIN32
+				VirtualLock(p, bytes);
+#else
+				mlock(p, bytes);
+#endif
+			}
+
+			return static_cast<double*>(p);
+		}
+
+		inline
+		void deallocate(double* p, integer_t n) {
+			if(p == nullptr)
+				return;
+#ifdef WIN32
+			(void)n;
+			VirtualFree(p, 0, MEM_RELEASE);
+#else
+			//munmap also drops any lock
+			munmap(p, mapped_bytes(n));
+#endif
+		}
+
+		inline
+		unsigned get_options() const { return options; }
+
+		//Whether the pages of a block are currently resident, for checking that prefaulting took effect
+		inline
+		bool is_resident(const double* p, integer_t n) const {
+#if defined(WIN32)
+			(void)p;
+			(void)n;
+			return true;
+#else
+			const std::size_t step = page_size();
+			const std::size_t bytes = mapped_bytes(n);
+#ifdef __APPLE__
+			char v[256];
+#else
+			unsigned char v[256];
+#endif
+			for(std::size_t offset = 0; offset < bytes; offset += 256 * step) {
+				const std::size_t len = bytes - offset < 256 * step ? bytes - offset : 256 * step;
+				if(mincore(const_cast<double*>(p) + offset / sizeof(double), len, v) != 0)
+					return false;
+				for(std::size_t i = 0; i < (len + step - 1) / step; ++i) {
+					if((v[i] & 1) == 0)
+						return false;
+				}
+			}
+			return true;
+#endif
+		}
+	};
+
+	//Storage for long delay memory, mapped from huge pages, prefaulted and locked
+	template <integer_t CHANNELS = 0LL, typename STRIDE = default_stride>
+	using locked_storage = dynamic_storage<CHANNELS, STRIDE, page_allocator>;
+}
+
+#endif
@@ -0,0 +1,80 @@
+
+#ifndef STD_DSP_RESOURCE_ALLOCATOR_GUARD
+#define STD_DSP_RESOURCE_ALLOCATOR_GUARD
+
+#include <cstddef>
+#include <cassert>
+
+#include "../base/base.h"
+#include "../base/std_dsp_mem.h"
+
+#if (__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)) && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define STD_DSP_HAS_PMR
+#endif
+#endif
+
+//
+//  Memory resource allocators for dynamic_storage.
+//
+//  resource_allocator adapts anything with the std::pmr::memory_resource interface
+//
+//  void* allocate(std::size_t bytes, std::size_t alignment);
+//  void deallocate(void* p, std::size_t bytes, std::size_t alignment);
+//
+//  so storage can be backed by huge pages, a locked arena or a monotonic resource per
+//  graph. The resource must outlive every storage allocated from it.
+//
+//  std::pmr::monotonic_buffer_resource arena(1 << 24);
+//  std_dsp::pmr_storage<2> s(4096, std_dsp::pmr_allocator(&arena));
+//
+
+namespace std_dsp {
+	template <typename RESOURCE>
+	class resource_allocator {
+	private:
+		RESOURCE* resource;
+	public:
+		explicit resource_allocator(RESOURCE* r) : resource(r) {
+			assert(r != nullptr);
+		}
+
+		inline
+		double* allocate(integer_t n) {
+			return static_cast<double*>(resource->allocate(static_cast<std::size_t>(n) * sizeof(double), cache_line_size));
+		}
+		inline
+		void deallocate(double* p, integer_t n) {
+			resource->deallocate(p, static_cast<std::size_t>(n) * sizeof(double), cache_line_size);
+		}
+
+		inline
+		RESOURCE* get_resource() const { return resource; }
+
+		inline
+		friend
+		bool operator==(const resource_allocator& x, const resource_allocator& y) {
+			return x.resource == y.resource;
+		}
+		inline
+		friend
+		bool operator!=(const resource_allocator& x, const resource_allocator& y) {
+			return !(x == y);
+		}
+	};
+
+#ifdef STD_DSP_HAS_PMR
+	//Draws from std::pmr::get_default_resource() unless given a resource
+	class pmr_allocator : public resource_allocator<std::pmr::memory_resource> {
+	public:
+		pmr_allocator() : resource_allocator<std::pmr::memory_resource>(std::pmr::get_default_resource()) {}
+		pmr_allocator(std::pmr::memory_resource* r) : resource_allocator<std::pmr::memory_resource>(r) {}
+	};
+
+	template <integer_t CHANNELS = 0LL, typename STRIDE = default_stride>
+	using pmr_storage = dynamic_storage<CHANNELS, STRIDE, pmr_allocator>;
+#endif
+}
+
+#endif
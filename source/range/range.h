@@ -1,148 +1,165 @@
 
-#pragma once
+#ifndef STD_DSP_RANGE_GUARD
+#define STD_DSP_RANGE_GUARD
 
 #include <cstdint>
 #include <cassert>
-#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "../base/base.h"
+
+//
+//  Non-owning multichannel views.
+//
+//  A buffer_view addresses channels() x size() samples through two strides: channel_stride
+//  between the first samples of adjacent channels and frame_stride between consecutive
+//  samples of one channel. Planar storage has frame_stride 1, interleaved storage has
+//  channel_stride 1 and frame_stride channels(). Views are cheap to copy and slicing them
+//  (take, drop, split, channel) never touches the samples, so a host block can be cut at
+//  event boundaries and the pieces handed to the algorithms in range/view_algorithms.h.
+//
+//  buffer_view<double> writes, buffer_view<const double> only reads, and the first
+//  converts to the second.
+//
 
 namespace std_dsp {
-	template <std::int32_t CHANNELS, bool REVERSE=false>
-	class range;
-
-	template <std::int32_t CHANNELS>
-	class range<CHANNELS, false> {
+	template <typename T = double>
+	class buffer_view {
 	private:
-		double* source_;
-		std::int32_t count_;
+		T* first;
+		integer_t channel_count;
+		integer_t length;
+		integer_t channel_step;
+		integer_t frame_step;
 	public:
-		enum channels_enum {
-			channels = CHANNELS,
-		};
-		enum reversed_enum {
-			reversed = 0,
-		}
+		using value_type = typename std::remove_const<T>::type;
+		using pointer = T*;
+		using reference = T&;
 
-		range() : count_(0) {}
-		range(double* source, std::int32_t count) : source_(source), count_(count) {}
-		range(const range& that) = default;
-		range(range&& that) = default;
-
-		range& operator=(const range& that) = default;
-		range& operator=(const range&& that) = default;
-
-		double* begin() { return source_; }
-		const double* begin() const { return source_; }
-		const double* cbegin() const { return source_; }
-		double* end() { return source_ + (CHANNELS * count_); }
-		const double* end() const { return source_ + (CHANNELS * count_); }
-		const double* end() const { return source_ + (CHANNELS * count_); }
-
-		void advance(std::int32_t n) {
-			assert(n <= count_);
-			source_ += (CHANNELS * n);
-			count_ -= n;
+		buffer_view() : first(nullptr), channel_count(0LL), length(0LL), channel_step(0LL), frame_step(1LL) {}
+		buffer_view(T* first, integer_t channels, integer_t n, integer_t channel_stride, integer_t frame_stride)
+		: first(first), channel_count(channels), length(n), channel_step(channel_stride), frame_step(frame_stride) {
+			assert(channels >= 0LL);
+			assert(n >= 0LL);
 		}
 
-		range take(std::int32_t n) const {
-			assert(n <= count_);
-			return range(source_, count_ - n);
-		}
-		range drop(std::int32_t n) const {
-			assert(n <= count_);
-			return range(source_ + (CHANNELS * n), count_ - n);
-		}
-		range take_and_advance(std::int32_t n) {
-			range r = take(n);
-			advance(n);
-			return r;
-		}
-		std::pair<range, range> split(std::int32_t n) {
-			assert(n <= count_);
-			assert(n >= 0);
-			std::pair<range, range>(take(n), drop(n));
-		}
+		//Read only view of a writable one
+		template <typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+		buffer_view(const buffer_view<U>& x)
+		: first(x.data()), channel_count(x.channels()), length(x.size()), channel_step(x.channel_stride()), frame_step(x.frame_stride()) {}
 
-		std::int32_t size() {
-			return count_;
-		}
+		//Shape
 
-		range<CHANNELS, true> reverse() const {
-			return range<CHANNELS, true>(source + (CHANNELS * count_), count_);
-		}
-	};		
+		inline
+		integer_t channels() const { return channel_count; }
+		inline
+		integer_t size() const { return length; }
+		inline
+		bool empty() const { return channel_count == 0LL || length == 0LL; }
+		inline
+		integer_t channel_stride() const { return channel_step; }
+		inline
+		integer_t frame_stride() const { return frame_step; }
 
-	template <std::int32_t CHANNELS>
-	class range<CHANNELS, true> {
-	private:
-		double* source_;
-		std::int32_t count_;
-	public:
-		enum channels_enum {
-			channels = CHANNELS,
-		};
-		enum reversed_enum {
-			reversed = 1,
+		//Every channel is a contiguous run of samples
+		inline
+		bool is_planar() const { return frame_step == 1LL; }
+		//Frames of channels() samples follow each other without gaps
+		inline
+		bool is_interleaved() const { return channel_step == 1LL && frame_step == channel_count; }
+		//All samples form a single run of channels() * size() samples
+		inline
+		bool is_contiguous() const {
+			if(is_planar())
+				return channel_count <= 1LL || channel_step == length;
+			return is_interleaved();
 		}
 
-		range() : count_(0) {}
-		range(double* source, std::int32_t count) : source_(source), count_(count) {}
-		range(const range& that) = default;
-		range(range&& that) = default;
-
-		range& operator=(const range& that) = default;
-		range& operator=(const range&& that) = default;
-		
-		std::reverse_iterator<double*> begin() { return source_; }
-		std::reverse_iterator<const double*> begin() const { return source_; }
-		std::reverse_iterator<const double*> cbegin() const { return source_; }
-		std::reverse_iterator<double*> end() { return source_ + (CHANNELS * count_); }
-		std::reverse_iterator<const double*> end() const { return source_ + (CHANNELS * count_); }
-		std::reverse_iterator<const double*> end() const { return source_ + (CHANNELS * count_); }
+		//Access
 
 		inline
-		double get(std::int32_t index) {
-			return source_[-index-1];
+		T* data() const { return first; }
+		inline
+		T* channel_data(integer_t channel) const {
+			assert(channel >= 0LL && channel < channel_count);
+			return first + channel * channel_step;
 		}
 		inline
-		double_2 get2(std::int32_t index) {
-
+		T& operator()(integer_t channel, integer_t index) const {
+			assert(index >= 0LL && index < length);
+			return channel_data(channel)[index * frame_step];
 		}
 
-		void advance(std::int32_t n) {
-			assert(n <= count_);
-			assert(n >= 0);
-			source_ -= (CHANNELS * n);
-			count_ -= n;
-		}
+		//Slicing
 
-		range take(std::int32_t n) {
-			assert(n <= count_);
-			assert(n >= 0);
-			return range(source_, count_ - n);
+		//The first n frames
+		inline
+		buffer_view take(integer_t n) const {
+			assert(n >= 0LL && n <= length);
+			return buffer_view(first, channel_count, n, channel_step, frame_step);
 		}
-		range drop(std::int32_t n) {
-			assert(n <= count_);
-			assert(n >= 0);
-			return range(source_ - (CHANNELS * n), count_ - n);
+		//All but the first n frames
+		inline
+		buffer_view drop(integer_t n) const {
+			assert(n >= 0LL && n <= length);
+			return buffer_view(first + n * frame_step, channel_count, length - n, channel_step, frame_step);
 		}
-		range take_and_advance(std::int32_t n) {
-			range r = take(n);
-			advance(n);
-			return r;
+		//n frames from offset
+		inline
+		buffer_view slice(integer_t offset, integer_t n) const {
+			return drop(offset).take(n);
 		}
-		std::pair<range, range> split(std::int32_t n) {
-			assert(n <= count_);
-			assert(n >= 0);
-			std::pair<range, range>(take(n), drop(n));
+		inline
+		std::pair<buffer_view, buffer_view> split(integer_t n) const {
+			return std::make_pair(take(n), drop(n));
 		}
-
-		std::int32_t size() {
-			return count_;
+		//Removes the first n frames from this view and returns them
+		inline
+		buffer_view take_and_advance(integer_t n) {
+			buffer_view r = take(n);
+			*this = drop(n);
+			return r;
 		}
 
-		range<CHANNELS, false> reverse() {
-			return range<CHANNELS, false>(source - (CHANNELS * count_), count_);
+		//A single channel as a mono view
+		inline
+		buffer_view channel(integer_t c) const {
+			return channels_range(c, 1LL);
+		}
+		//count channels from c
+		inline
+		buffer_view channels_range(integer_t c, integer_t count) const {
+			assert(c >= 0LL && count >= 0LL && c + count <= channel_count);
+			return buffer_view(first + c * channel_step, count, length, channel_step, frame_step);
 		}
 	};
 
+	template <typename T>
+	inline
+	buffer_view<T> make_planar_view(T* first, integer_t channels, integer_t n, integer_t channel_stride) {
+		return buffer_view<T>(first, channels, n, channel_stride, 1LL);
+	}
+
+	template <typename T>
+	inline
+	buffer_view<T> make_interleaved_view(T* first, integer_t channels, integer_t n) {
+		return buffer_view<T>(first, channels, n, 1LL, channels);
+	}
+
+	template <typename T>
+	inline
+	buffer_view<T> make_mono_view(T* first, integer_t n) {
+		return buffer_view<T>(first, 1LL, n, n, 1LL);
+	}
+
+	//Planar view of static_storage, dynamic_storage or anything providing get, channels, size and stride
+	template <typename STORAGE>
+	inline
+	auto make_view(STORAGE& s) -> buffer_view<typename std::remove_pointer<decltype(s.get())>::type> {
+		using T = typename std::remove_pointer<decltype(s.get())>::type;
+		return buffer_view<T>(s.get(), s.channels(), s.size(), s.stride(), 1LL);
+	}
 }
+
+#endif
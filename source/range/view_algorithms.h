@@ -0,0 +1,535 @@
+
+#ifndef STD_DSP_VIEW_ALGORITHMS_GUARD
+#define STD_DSP_VIEW_ALGORITHMS_GUARD
+
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+
+#include "../base/base.h"
+#include "../stateless_algorithms/mono.h"
+#include "../stereo/interleave.h"
+#include "../stereo/stereo_transforms.h"
+
+#include "range.h"
+
+//
+//  The stateless algorithms and stereo transforms over buffer_view.
+//
+//  Views of the same contiguous layout are processed in one call over all samples, planar
+//  views one channel at a time, straight on the underlying memory. Any other combination
+//  (interleaved against planar, or gaps between frames) is gathered through a small stack
+//  block per channel, so it works for every layout but is only as fast as the copies.
+//
+
+namespace std_dsp {
+	namespace detail {
+		//Frames per gathered block
+		static const integer_t view_block = 256;
+
+		template <typename T>
+		inline
+		void gather(const buffer_view<T>& x, integer_t channel, integer_t offset, integer_t n, typename buffer_view<T>::value_type* out) {
+			const T* p = x.channel_data(channel) + offset * x.frame_stride();
+			const integer_t step = x.frame_stride();
+			for(integer_t i = 0; i < n; ++i)
+				out[i] = p[i * step];
+		}
+
+		template <typename T>
+		inline
+		void scatter(const T* first, integer_t n, const buffer_view<T>& x, integer_t channel, integer_t offset) {
+			T* p = x.channel_data(channel) + offset * x.frame_stride();
+			const integer_t step = x.frame_stride();
+			for(integer_t i = 0; i < n; ++i)
+				p[i * step] = first[i];
+		}
+
+		template <typename T1, typename T2>
+		inline
+		bool same_contiguous_layout(const buffer_view<T1>& x, const buffer_view<T2>& y) {
+			return x.is_contiguous() && y.is_contiguous() && (x.channels() == 1LL || x.frame_stride() == y.frame_stride());
+		}
+
+		template <typename T1, typename T2>
+		inline
+		void check_shapes(const buffer_view<T1>& x, const buffer_view<T2>& y) {
+			assert(x.channels() == y.channels());
+			assert(x.size() == y.size());
+		}
+
+		//f(T* first, integer_t n) over every channel of x
+		template <typename T, typename F>
+		inline
+		void for_each_run(const buffer_view<T>& x, F f) {
+			if(x.empty())
+				return;
+			if(x.is_contiguous()) {
+				f(x.data(), x.channels() * x.size());
+				return;
+			}
+			if(x.is_planar()) {
+				for(integer_t c = 0; c < x.channels(); ++c)
+					f(x.channel_data(c), x.size());
+				return;
+			}
+
+			CACHE_ALIGN T tmp[view_block];
+			for(integer_t c = 0; c < x.channels(); ++c) {
+				for(integer_t i = 0; i < x.size(); i += view_block) {
+					const integer_t n = std::min(view_block, x.size() - i);
+					gather(x, c, i, n, tmp);
+					f(static_cast<T*>(tmp), n);
+					scatter(static_cast<const T*>(tmp), n, x, c, i);
+				}
+			}
+		}
+
+		//f(const T1* first, integer_t n, T2* out) over every channel of in and out
+		template <typename T1, typename T2, typename F>
+		inline
+		void for_each_run(const buffer_view<T1>& in, const buffer_view<T2>& out, F f) {
+			check_shapes(in, out);
+			if(in.empty())
+				return;
+			if(same_contiguous_layout(in, out)) {
+				f(in.data(), in.channels() * in.size(), out.data());
+				return;
+			}
+			if(in.is_planar() && out.is_planar()) {
+				for(integer_t c = 0; c < in.channels(); ++c)
+					f(in.channel_data(c), in.size(), out.channel_data(c));
+				return;
+			}
+
+			CACHE_ALIGN T2 in_tmp[view_block];
+			CACHE_ALIGN T2 out_tmp[view_block];
+			for(integer_t c = 0; c < in.channels(); ++c) {
+				for(integer_t i = 0; i < in.size(); i += view_block) {
+					const integer_t n = std::min(view_block, in.size() - i);
+					const T2* p = in_tmp;
+					if(in.is_planar())
+						p = in.channel_data(c) + i;
+					else
+						gather(in, c, i, n, in_tmp);
+					if(out.is_planar()) {
+						f(p, n, out.channel_data(c) + i);
+					} else {
+						f(p, n, static_cast<T2*>(out_tmp));
+						scatter(static_cast<const T2*>(out_tmp), n, out, c, i);
+					}
+				}
+			}
+		}
+
+		//f(const T1* first1, const T2* first2, integer_t n, T3* out) over every channel of the three views
+		template <typename T1, typename T2, typename T3, typename F>
+		inline
+		void for_each_run(const buffer_view<T1>& in1, const buffer_view<T2>& in2, const buffer_view<T3>& out, F f) {
+			check_shapes(in1, out);
+			check_shapes(in2, out);
+			if(out.empty())
+				return;
+			if(same_contiguous_layout(in1, out) && same_contiguous_layout(in2, out)) {
+				f(in1.data(), in2.data(), out.channels() * out.size(), out.data());
+				return;
+			}
+			if(in1.is_planar() && in2.is_planar() && out.is_planar()) {
+				for(integer_t c = 0; c < out.channels(); ++c)
+					f(in1.channel_data(c), in2.channel_data(c), out.size(), out.channel_data(c));
+				return;
+			}
+
+			CACHE_ALIGN T3 in1_tmp[view_block];
+			CACHE_ALIGN T3 in2_tmp[view_block];
+			CACHE_ALIGN T3 out_tmp[view_block];
+			for(integer_t c = 0; c < out.channels(); ++c) {
+				for(integer_t i = 0; i < out.size(); i += view_block) {
+					const integer_t n = std::min(view_block, out.size() - i);
+					const T3* p1 = in1_tmp;
+					const T3* p2 = in2_tmp;
+					if(in1.is_planar())
+						p1 = in1.channel_data(c) + i;
+					else
+						gather(in1, c, i, n, in1_tmp);
+					if(in2.is_planar())
+						p2 = in2.channel_data(c) + i;
+					else
+						gather(in2, c, i, n, in2_tmp);
+					//out may alias an input, so it is gathered like the inputs
+					if(out.is_planar()) {
+						f(p1, p2, n, out.channel_data(c) + i);
+					} else {
+						gather(out, c, i, n, out_tmp);
+						f(p1, p2, n, static_cast<T3*>(out_tmp));
+						scatter(static_cast<const T3*>(out_tmp), n, out, c, i);
+					}
+				}
+			}
+		}
+
+		//Folds f(const T* first, integer_t n) over every run of x with combine
+		template <typename T, typename F, typename C>
+		inline
+		double reduce_runs(const buffer_view<T>& x, F f, C combine) {
+			assert(!x.empty());
+			if(x.is_contiguous())
+				return f(x.data(), x.channels() * x.size());
+			if(x.is_planar()) {
+				double r = f(x.channel_data(0), x.size());
+				for(integer_t c = 1; c < x.channels(); ++c)
+					r = combine(r, f(x.channel_data(c), x.size()));
+				return r;
+			}
+
+			using V = typename buffer_view<T>::value_type;
+			CACHE_ALIGN V tmp[view_block];
+			bool first_run = true;
+			double r = 0.0;
+			for(integer_t c = 0; c < x.channels(); ++c) {
+				for(integer_t i = 0; i < x.size(); i += view_block) {
+					const integer_t n = std::min(view_block, x.size() - i);
+					gather(x, c, i, n, tmp);
+					const double y = f(static_cast<const V*>(tmp), n);
+					r = first_run ? y : combine(r, y);
+					first_run = false;
+				}
+			}
+			return r;
+		}
+
+		struct min_combine {
+			inline
+			double operator()(double a, double b) const { return std::min(a, b); }
+		};
+		struct max_combine {
+			inline
+			double operator()(double a, double b) const { return std::max(a, b); }
+		};
+		struct sum_combine {
+			inline
+			double operator()(double a, double b) const { return a + b; }
+		};
+		struct product_combine {
+			inline
+			double operator()(double a, double b) const { return a * b; }
+		};
+	}
+
+	// - Generic transforms -
+
+	template <typename T1, typename T2, typename Op>
+	inline
+	void copy_transform(const buffer_view<T1>& in, const buffer_view<T2>& out, Op op) {
+		detail::for_each_run(in, out, [&op](const T2* first, integer_t n, T2* o) { copy_transform(first, n, o, op); });
+	}
+
+	template <typename T, typename Op>
+	inline
+	void inplace_transform(const buffer_view<T>& x, Op op) {
+		detail::for_each_run(x, [&op](T* first, integer_t n) { inplace_transform(first, n, op); });
+	}
+
+	template <typename T1, typename T2, typename T3, typename Op>
+	inline
+	void binary_transform(const buffer_view<T1>& in1, const buffer_view<T2>& in2, const buffer_view<T3>& out, Op op) {
+		detail::for_each_run(in1, in2, out, [&op](const T3* first1, const T3* first2, integer_t n, T3* o) { binary_transform(first1, first2, n, o, op); });
+	}
+
+	// - Copy transforms -
+
+	//Between planar and interleaved stereo views this is interleave or deinterleave
+	template <typename T1, typename T2>
+	inline
+	void copy(const buffer_view<T1>& in, const buffer_view<T2>& out) {
+		detail::check_shapes(in, out);
+		if(in.channels() == 2LL && in.is_planar() && out.is_interleaved()) {
+			interleave(in.channel_data(0), in.channel_data(1), in.size(), out.data());
+			return;
+		}
+		if(in.channels() == 2LL && in.is_interleaved() && out.is_planar()) {
+			deinterleave(in.data(), in.size(), out.channel_data(0), out.channel_data(1));
+			return;
+		}
+		detail::for_each_run(in, out, [](const T2* first, integer_t n, T2* o) { copy(first, n, o); });
+	}
+	template <typename T1, typename T2>
+	inline
+	void add(const buffer_view<T1>& in, const buffer_view<T2>& out, double term) {
+		copy_transform(in, out, transform_functors::add_op(term));
+	}
+	template <typename T1, typename T2>
+	inline
+	void multiply(const buffer_view<T1>& in, const buffer_view<T2>& out, double factor) {
+		copy_transform(in, out, transform_functors::multiply_op(factor));
+	}
+	template <typename T1, typename T2>
+	inline
+	void clip(const buffer_view<T1>& in, const buffer_view<T2>& out, double min_level, double max_level) {
+		copy_transform(in, out, transform_functors::clip_op(min_level, max_level));
+	}
+	template <typename T1, typename T2>
+	inline
+	void cubic_clip(const buffer_view<T1>& in, const buffer_view<T2>& out) {
+		copy_transform(in, out, transform_functors::cubic_clip_op());
+	}
+	template <typename T1, typename T2>
+	inline
+	void phase_reverse(const buffer_view<T1>& in, const buffer_view<T2>& out) {
+		copy_transform(in, out, transform_functors::multiply_op(-1.0));
+	}
+	template <typename T1, typename T2>
+	inline
+	void abs(const buffer_view<T1>& in, const buffer_view<T2>& out) {
+		copy_transform(in, out, transform_functors::abs_op());
+	}
+	template <typename T1, typename T2>
+	inline
+	void square(const buffer_view<T1>& in, const buffer_view<T2>& out) {
+		copy_transform(in, out, transform_functors::square_op());
+	}
+
+	// - Inplace transforms -
+
+	template <typename T>
+	inline
+	void add(const buffer_view<T>& x, double term) {
+		inplace_transform(x, transform_functors::add_op(term));
+	}
+	template <typename T>
+	inline
+	void multiply(const buffer_view<T>& x, double factor) {
+		inplace_transform(x, transform_functors::multiply_op(factor));
+	}
+	template <typename T>
+	inline
+	void clip(const buffer_view<T>& x, double min_level, double max_level) {
+		inplace_transform(x, transform_functors::clip_op(min_level, max_level));
+	}
+	template <typename T>
+	inline
+	void cubic_clip(const buffer_view<T>& x) {
+		inplace_transform(x, transform_functors::cubic_clip_op());
+	}
+	template <typename T>
+	inline
+	void phase_reverse(const buffer_view<T>& x) {
+		inplace_transform(x, transform_functors::multiply_op(-1.0));
+	}
+	template <typename T>
+	inline
+	void abs(const buffer_view<T>& x) {
+		inplace_transform(x, transform_functors::abs_op());
+	}
+	template <typename T>
+	inline
+	void square(const buffer_view<T>& x) {
+		inplace_transform(x, transform_functors::square_op());
+	}
+	template <typename T>
+	inline
+	void undenormalize(const buffer_view<T>& x) {
+		if(!undenormalize_needed())
+			return;
+		detail::for_each_run(x, [](T* first, integer_t n) { undenormalize(first, n); });
+	}
+
+	// - Binary transforms -
+
+	template <typename T1, typename T2, typename T3>
+	inline
+	void add(const buffer_view<T1>& in1, const buffer_view<T2>& in2, const buffer_view<T3>& out) {
+		binary_transform(in1, in2, out, add_op());
+	}
+	template <typename T1, typename T2, typename T3>
+	inline
+	void multiply(const buffer_view<T1>& in1, const buffer_view<T2>& in2, const buffer_view<T3>& out) {
+		binary_transform(in1, in2, out, multiply_op());
+	}
+	template <typename T1, typename T2, typename T3>
+	inline
+	void linear_combination(const buffer_view<T1>& in1, const buffer_view<T2>& in2, const buffer_view<T3>& out, scalar_t a1, scalar_t a2) {
+		binary_transform(in1, in2, out, linear_combination_op(a1, a2));
+	}
+	template <typename T1, typename T2, typename T3>
+	inline
+	void mix(const buffer_view<T1>& in1, const buffer_view<T2>& in2, const buffer_view<T3>& out, scalar_t frac) {
+		linear_combination(in1, in2, out, 1.0 - frac, frac);
+	}
+	//out += in * scalar
+	template <typename T1, typename T2>
+	inline
+	void multiply_add(const buffer_view<T1>& in, const buffer_view<T2>& out, scalar_t scalar) {
+		binary_transform(in, out, out, multiply_with_scalar_and_add_op(scalar));
+	}
+
+	// - Generators -
+
+	template <typename T, typename Op>
+	inline
+	void generate(const buffer_view<T>& out, Op op) {
+		detail::for_each_run(out, [&op](T* first, integer_t n) { generate(n, first, op); });
+	}
+	template <typename T>
+	inline
+	void zero(const buffer_view<T>& out) {
+		generate(out, generator_functors::zero_generator_op());
+	}
+	template <typename T>
+	inline
+	void assign(const buffer_view<T>& out, double value) {
+		generate(out, generator_functors::constant_generator_op(value));
+	}
+	template <typename T>
+	inline
+	void randomize(const buffer_view<T>& out, double a, double b) {
+		generate(out, generator_functors::random_generator_op(a, b));
+	}
+
+	// - Reductions over all channels -
+
+	template <typename T>
+	inline
+	double min_value(const buffer_view<T>& x) {
+		using V = typename buffer_view<T>::value_type;
+		return detail::reduce_runs(x, [](const V* first, integer_t n) { return min_value(first, n); }, detail::min_combine());
+	}
+	template <typename T>
+	inline
+	double max_value(const buffer_view<T>& x) {
+		using V = typename buffer_view<T>::value_type;
+		return detail::reduce_runs(x, [](const V* first, integer_t n) { return max_value(first, n); }, detail::max_combine());
+	}
+	template <typename T>
+	inline
+	double min_abs_value(const buffer_view<T>& x) {
+		using V = typename buffer_view<T>::value_type;
+		return detail::reduce_runs(x, [](const V* first, integer_t n) { return min_abs_value(first, n); }, detail::min_combine());
+	}
+	template <typename T>
+	inline
+	double max_abs_value(const buffer_view<T>& x) {
+		using V = typename buffer_view<T>::value_type;
+		return detail::reduce_runs(x, [](const V* first, integer_t n) { return max_abs_value(first, n); }, detail::max_combine());
+	}
+	template <typename T>
+	inline
+	double sum(const buffer_view<T>& x) {
+		using V = typename buffer_view<T>::value_type;
+		if(x.empty())
+			return 0.0;
+		return detail::reduce_runs(x, [](const V* first, integer_t n) { return sum(first, n); }, detail::sum_combine());
+	}
+	template <typename T>
+	inline
+	double sum_of_squares(const buffer_view<T>& x) {
+		using V = typename buffer_view<T>::value_type;
+		if(x.empty())
+			return 0.0;
+		return detail::reduce_runs(x, [](const V* first, integer_t n) { return sum_of_squares(first, n); }, detail::sum_combine());
+	}
+	template <typename T>
+	inline
+	double product(const buffer_view<T>& x) {
+		using V = typename buffer_view<T>::value_type;
+		if(x.empty())
+			return 1.0;
+		return detail::reduce_runs(x, [](const V* first, integer_t n) { return product(first, n); }, detail::product_combine());
+	}
+
+	// - Stereo transforms -
+
+	//Two channel views of any layout. Planar pairs use the split algorithm, interleaved pairs
+	//the interleaved one, and mixed layouts go through planar blocks on the stack.
+	template <typename T1, typename T2, typename Op>
+	inline
+	void stereo_transform(const buffer_view<T1>& in, const buffer_view<T2>& out, Op op) {
+		detail::check_shapes(in, out);
+		assert(in.channels() == 2LL);
+		if(in.size() == 0LL)
+			return;
+		if(in.is_planar() && out.is_planar()) {
+			stereo_transform(in.channel_data(0), in.channel_data(1), in.size(), out.channel_data(0), out.channel_data(1), op);
+			return;
+		}
+		if(in.is_interleaved() && out.is_interleaved()) {
+			stereo_transform(in.data(), in.size(), out.data(), op);
+			return;
+		}
+
+		CACHE_ALIGN T2 in_tmp[2][detail::view_block];
+		CACHE_ALIGN T2 out_tmp[2][detail::view_block];
+		for(integer_t i = 0; i < in.size(); i += detail::view_block) {
+			const integer_t n = std::min(detail::view_block, in.size() - i);
+			const T2* p1 = in_tmp[0];
+			const T2* p2 = in_tmp[1];
+			if(in.is_planar()) {
+				p1 = in.channel_data(0) + i;
+				p2 = in.channel_data(1) + i;
+			} else {
+				detail::gather(in, 0, i, n, in_tmp[0]);
+				detail::gather(in, 1, i, n, in_tmp[1]);
+			}
+			if(out.is_planar()) {
+				stereo_transform(p1, p2, n, out.channel_data(0) + i, out.channel_data(1) + i, op);
+			} else {
+				stereo_transform(p1, p2, n, static_cast<T2*>(out_tmp[0]), static_cast<T2*>(out_tmp[1]), op);
+				detail::scatter(static_cast<const T2*>(out_tmp[0]), n, out, 0, i);
+				detail::scatter(static_cast<const T2*>(out_tmp[1]), n, out, 1, i);
+			}
+		}
+	}
+
+	template <typename T1, typename T2>
+	inline
+	void swap_channels(const buffer_view<T1>& in, const buffer_view<T2>& out) {
+		stereo_transform(in, out, swap_op());
+	}
+	template <typename T1, typename T2>
+	inline
+	void duplicate_left(const buffer_view<T1>& in, const buffer_view<T2>& out) {
+		stereo_transform(in, out, duplicate_left_op());
+	}
+	template <typename T1, typename T2>
+	inline
+	void duplicate_right(const buffer_view<T1>& in, const buffer_view<T2>& out) {
+		stereo_transform(in, out, duplicate_right_op());
+	}
+	template <typename T1, typename T2>
+	inline
+	void mono(const buffer_view<T1>& in, const buffer_view<T2>& out) {
+		stereo_transform(in, out, mono_op());
+	}
+	template <typename T1, typename T2>
+	inline
+	void mid_side(const buffer_view<T1>& in, const buffer_view<T2>& out) {
+		stereo_transform(in, out, mid_side_op());
+	}
+	template <typename T1, typename T2>
+	inline
+	void mid_side_inv(const buffer_view<T1>& in, const buffer_view<T2>& out) {
+		stereo_transform(in, out, mid_side_inv_op());
+	}
+	template <typename T1, typename T2>
+	inline
+	void phase_invert_left(const buffer_view<T1>& in, const buffer_view<T2>& out) {
+		stereo_transform(in, out, phase_invert_left_op());
+	}
+	template <typename T1, typename T2>
+	inline
+	void phase_invert_right(const buffer_view<T1>& in, const buffer_view<T2>& out) {
+		stereo_transform(in, out, phase_invert_right_op());
+	}
+	template <typename T1, typename T2>
+	inline
+	void width(const buffer_view<T1>& in, const buffer_view<T2>& out, double w) {
+		if(fabs(w) < 0.000001) {
+			mono(in, out);
+			return;
+		}
+		stereo_transform(in, out, width_op(w));
+	}
+}
+
+#endif
@@ -2,49 +2,205 @@
 #ifndef STD_DSP_BINARY_TRANSFORMS_GUARD
 #define STD_DSP_BINARY_TRANSFORMS_GUARD
 
+#include <iterator>
+
 #include "../../base/std_dsp_computational_basis.h"
+#include "../../base/std_dsp_cpu_features.h"
+#include "../../base/std_dsp_simd_kernel.h"
 
 #include "functors.h"
 
 namespace std_dsp {
+	namespace detail {
+		//Processes the largest multiple of the vector width with AVX2 and returns the count.
+		//Peels to the alignment of out, then stores aligned.
+		template <typename T, typename N, typename Op>
+		inline STD_DSP_TARGET_AVX2
+		N binary_transform_avx2(const T* first1, const T* first2, N n, T* out, Op& op) {
+			using V = typename vector_types<T>::avx2;
+			using kernel = simd_kernel<V, unroll_factor<algorithm_tags::binary_transform, V>::value, false, true>;
+			const N head = alignment_head<sizeof(V)>(out, n);
+			for(N i = 0; i < head; ++i)
+				out[i] = op(first1[i], first2[i]);
+			return head + kernel::transform(first1 + head, first2 + head, n - head, out + head, op);
+		}
+
+		//Processes all n elements with AVX-512, the head and the last partial vector with masked loads and stores
+		template <typename T, typename N, typename Op>
+		inline STD_DSP_TARGET_AVX512
+		N binary_transform_avx512(const T* first1, const T* first2, N n, T* out, Op& op) {
+			using V = typename vector_types<T>::avx512;
+			using kernel = simd_kernel<V, unroll_factor<algorithm_tags::binary_transform, V>::value, false, true>;
+			const N head = alignment_head<sizeof(V)>(out, n);
+			if(head)
+				kernel::transform_tail(first1, first2, head, out, op);
+			const N vector_n = head + kernel::transform(first1 + head, first2 + head, n - head, out + head, op);
+			if(vector_n != n)
+				kernel::transform_tail(first1 + vector_n, first2 + vector_n, n - vector_n, out + vector_n, op);
+			return n;
+		}
+
+		//Processes the largest multiple of the vector width with SSE. Peels to the alignment of out
+		//and loads aligned only when the inputs share it.
+		template <typename I1, typename I2, typename N, typename O, typename Op>
+		inline
+		N binary_transform_sse(I1, I2, N, O, Op&, simd_tag<0>) {
+			return N(0);
+		}
+
+		template <typename T, typename N, typename Op>
+		inline
+		N binary_transform_sse(const T* first1, const T* first2, N n, T* out, Op& op, simd_tag<1>) {
+			using V = typename vector_types<T>::sse;
+			using aligned_kernel = simd_kernel<V, unroll_factor<algorithm_tags::binary_transform, V>::value, true, true>;
+			using unaligned_kernel = simd_kernel<V, unroll_factor<algorithm_tags::binary_transform, V>::value, false, true>;
+			const N head = alignment_head<sizeof(V)>(out, n);
+			for(N i = 0; i < head; ++i)
+				out[i] = op(first1[i], first2[i]);
+
+			first1 += head;
+			first2 += head;
+			if(is_aligned_to<sizeof(V)>(first1) && is_aligned_to<sizeof(V)>(first2))
+				return head + aligned_kernel::transform(first1, first2, n - head, out + head, op);
+			return head + unaligned_kernel::transform(first1, first2, n - head, out + head, op);
+		}
+
+		template <typename I1, typename I2, typename N, typename O, typename Op>
+		inline
+		N binary_transform_dispatch(I1, I2, N, O, Op&, simd_tag<0>) {
+			return N(0);
+		}
+
+		template <typename T, typename N, typename Op>
+		inline
+		N binary_transform_dispatch(const T* first1, const T* first2, N n, T* out, Op& op, simd_tag<1>) {
+			if(use_avx2())
+				return binary_transform_avx2(first1, first2, n, out, op);
+			return N(0);
+		}
+
+		template <typename T, typename N, typename Op>
+		inline
+		N binary_transform_dispatch(const T* first1, const T* first2, N n, T* out, Op& op, simd_tag<2>) {
+			if(use_avx512())
+				return binary_transform_avx512(first1, first2, n, out, op);
+			return binary_transform_dispatch(first1, first2, n, out, op, simd_tag<1>());
+		}
+
+		//The widest level the iterators and the operator allow for element type T
+		template <typename T, typename I1, typename I2, typename O, typename Op>
+		using binary_transform_tag = simd_tag_for<are_pointers<I1, I2, O>::value,
+			is_vector_op<Op(typename vector_types<T>::avx2, typename vector_types<T>::avx2)>::value,
+			is_vector_op<Op(typename vector_types<T>::avx512, typename vector_types<T>::avx512)>::value>;
+
+		//Selected by the value type of the first input
+		template <typename T>
+		struct binary_transform_kernel {
+			template <typename I1, typename I2, typename N, typename O, typename Op>
+			inline
+			void operator()(I1 first1, I2 first2, N n, O out, Op& op) {
+				while(n) {
+					--n;
+					*out = op(*first1, *first2);
+					++first1;
+					++first2;
+					++out;
+				}
+			}
+		};
+
+		template <>
+		struct binary_transform_kernel<double> {
+			template <typename I1, typename I2, typename N, typename O, typename Op>
+			inline
+			void operator()(I1 first1, I2 first2, N n, O out, Op& op) {
+				const N wide_n = binary_transform_dispatch(first1, first2, n, out, op,
+					binary_transform_tag<double, I1, I2, O, Op>());
+				first1 += wide_n;
+				first2 += wide_n;
+				out += wide_n;
+				n -= wide_n;
+
+				const N vector_n = vector_loop(first1, first2, n, out, op,
+					std::integral_constant<bool, are_pointers<I1, I2, O>::value>());
+				first1 += vector_n;
+				first2 += vector_n;
+				out += vector_n;
+				n -= vector_n;
+
+				while(n) {
+					--n;
+					*out = op(*first1, *first2);
+					++first1;
+					++first2;
+					++out;
+				}
+			}
+
+		private:
+			template <typename N, typename Op>
+			inline
+			static N vector_loop(const double* first1, const double* first2, N n, double* out, Op& op, std::true_type) {
+				return binary_transform_sse(first1, first2, n, out, op, simd_tag<1>());
+			}
+
+			//Other iterators access memory through their own load2/store2, which are aligned
+			template <typename I1, typename I2, typename N, typename O, typename Op>
+			inline
+			static N vector_loop(I1 first1, I2 first2, N n, O out, Op& op, std::false_type) {
+				if(n == 0 || !check_alignment(first1, first2, out))
+					return N(0);
+
+				N head = 0;
+				if(is_odd_aligned(out)) {
+					*out = op(*first1, *first2);
+					++first1;
+					++first2;
+					++out;
+					head = 1;
+				}
+
+				using kernel = simd_kernel<double2_t, unroll_factor<algorithm_tags::binary_transform, double2_t>::value, true>;
+				return head + kernel::transform(first1, first2, n - head, out, op);
+			}
+		};
+
+		template <>
+		struct binary_transform_kernel<float> {
+			template <typename I1, typename I2, typename N, typename O, typename Op>
+			inline
+			void operator()(I1 first1, I2 first2, N n, O out, Op& op) {
+				using sse_tag = simd_tag_for<are_pointers<I1, I2, O>::value,
+					is_vector_op<Op(float4_t, float4_t)>::value, false>;
+				const N wide_n = binary_transform_dispatch(first1, first2, n, out, op,
+					binary_transform_tag<float, I1, I2, O, Op>());
+				first1 += wide_n;
+				first2 += wide_n;
+				out += wide_n;
+				n -= wide_n;
+
+				const N sse_n = binary_transform_sse(first1, first2, n, out, op, sse_tag());
+				first1 += sse_n;
+				first2 += sse_n;
+				out += sse_n;
+				n -= sse_n;
+
+				while(n) {
+					--n;
+					*out = op(*first1, *first2);
+					++first1;
+					++first2;
+					++out;
+				}
+			}
+		};
+	}
+
 	template <typename I1, typename I2, typename N, typename O, typename Op>
 	inline
 	void binary_transform(I1 first1, I2 first2, N n, O out, Op op) {
-		std::pair<std::size_t, std::size_t> partitions = unroll_partition_8(n);
-		while(partitions.first) {
-			double2_t x10 = load2(first1, 0);
-			double2_t x11 = load2(first1, 2);
-			double2_t x12 = load2(first1, 4);
-			double2_t x13 = load2(first1, 6);
-			double2_t x20 = load2(first2, 0);
-			double2_t x21 = load2(first2, 2);
-			double2_t x22 = load2(first2, 4);
-			double2_t x23 = load2(first2, 6);
-
-			partitions.first -= 8;
-
-			x10 = op(x10, x20);
-			x11 = op(x11, x21);
-			x12 = op(x12, x22);
-			x13 = op(x13, x23);
-
-			store2(out, 0, x10);
-			store2(out, 2, x11);
-			store2(out, 4, x12);
-			store2(out, 6, x13);
-
-			first1 += 8;
-			first2 += 8;
-			out += 8;
-		}
-
-		while(partitions.second) {
-			--partitions.second;
-			*out = op(*first1, *first2);
-			++first1;
-			++first2;
-			++out;
-		}
+		detail::binary_transform_kernel<typename std::iterator_traits<I1>::value_type> kernel;
+		kernel(first1, first2, n, out, op);
 	}
 
 	struct linear_combination_op {
@@ -67,18 +223,34 @@ namespace std_dsp {
 			double2_t m2 = multiply(x2, a2_v);
 			return add(m1, m2);
 		}
+		inline STD_DSP_TARGET_AVX2
+		double4_t operator()(double4_t x1, double4_t x2) {
+			return multiply_add(x1, load4(a1), multiply(x2, load4(a2)));
+		}
+		inline STD_DSP_TARGET_AVX512
+		double8_t operator()(double8_t x1, double8_t x2) {
+			return multiply_add(x1, load8(a1), multiply(x2, load8(a2)));
+		}
+		inline
+		float4_t operator()(float4_t x1, float4_t x2) {
+			return multiply_add(x1, load4f(static_cast<float>(a1)), multiply(x2, load4f(static_cast<float>(a2))));
+		}
+		inline STD_DSP_TARGET_AVX2
+		float8_t operator()(float8_t x1, float8_t x2) {
+			return multiply_add(x1, load8f(static_cast<float>(a1)), multiply(x2, load8f(static_cast<float>(a2))));
+		}
 	};
 
-	template <typename N>
+	template <typename T, typename N>
 	inline
-	void linear_combination(const scalar_t* first1, const scalar_t* first2, N n, scalar_t* out, scalar_t a1, scalar_t a2) {
+	void linear_combination(const T* first1, const T* first2, N n, T* out, scalar_t a1, scalar_t a2) {
 		linear_combination_op op(a1, a2);
 		binary_transform(first1, first2, n, out, op);
 	}
 
-	template <typename N>
+	template <typename T, typename N>
 	inline
-	void mix(const scalar_t* first1, const scalar_t* first2, N n, scalar_t* out, scalar_t frac) {
+	void mix(const T* first1, const T* first2, N n, T* out, scalar_t frac) {
 		linear_combination(first1, first2, n, out, 1.0 - frac, frac);
 	}
 
@@ -92,6 +264,22 @@ namespace std_dsp {
 		double2_t operator()(double2_t x1, double2_t x2) {
 			return add(x1, x2);
 		}
+		inline STD_DSP_TARGET_AVX2
+		double4_t operator()(double4_t x1, double4_t x2) {
+			return add(x1, x2);
+		}
+		inline STD_DSP_TARGET_AVX512
+		double8_t operator()(double8_t x1, double8_t x2) {
+			return add(x1, x2);
+		}
+		inline
+		float4_t operator()(float4_t x1, float4_t x2) {
+			return add(x1, x2);
+		}
+		inline STD_DSP_TARGET_AVX2
+		float8_t operator()(float8_t x1, float8_t x2) {
+			return add(x1, x2);
+		}
 	};
 	struct multiply_op {
 		inline
@@ -103,6 +291,22 @@ namespace std_dsp {
 		double2_t operator()(double2_t x1, double2_t x2) {
 			return multiply(x1, x2);
 		}
+		inline STD_DSP_TARGET_AVX2
+		double4_t operator()(double4_t x1, double4_t x2) {
+			return multiply(x1, x2);
+		}
+		inline STD_DSP_TARGET_AVX512
+		double8_t operator()(double8_t x1, double8_t x2) {
+			return multiply(x1, x2);
+		}
+		inline
+		float4_t operator()(float4_t x1, float4_t x2) {
+			return multiply(x1, x2);
+		}
+		inline STD_DSP_TARGET_AVX2
+		float8_t operator()(float8_t x1, float8_t x2) {
+			return multiply(x1, x2);
+		}
 	};
 	struct multiply_with_scalar_and_add_op {
 		scalar_t scalar;
@@ -119,23 +323,39 @@ namespace std_dsp {
 		double2_t operator()(double2_t x1, double2_t x2) {
 			return add(x2, multiply(x1, scalar_v));
 		}
+		inline STD_DSP_TARGET_AVX2
+		double4_t operator()(double4_t x1, double4_t x2) {
+			return multiply_add(x1, load4(scalar), x2);
+		}
+		inline STD_DSP_TARGET_AVX512
+		double8_t operator()(double8_t x1, double8_t x2) {
+			return multiply_add(x1, load8(scalar), x2);
+		}
+		inline
+		float4_t operator()(float4_t x1, float4_t x2) {
+			return multiply_add(x1, load4f(static_cast<float>(scalar)), x2);
+		}
+		inline STD_DSP_TARGET_AVX2
+		float8_t operator()(float8_t x1, float8_t x2) {
+			return multiply_add(x1, load8f(static_cast<float>(scalar)), x2);
+		}
 	};
 
-	template <typename N>
+	template <typename T, typename N>
 	inline
-	void add(const scalar_t* first1, const scalar_t* first2, N n, scalar_t* out) {
+	void add(const T* first1, const T* first2, N n, T* out) {
 		binary_transform(first1, first2, n, out, add_op());
 	}
 
-	template <typename N>
+	template <typename T, typename N>
 	inline
-	void multiply(const scalar_t* first1, const scalar_t* first2, N n, scalar_t* out) {
+	void multiply(const T* first1, const T* first2, N n, T* out) {
 		binary_transform(first1, first2, n, out, multiply_op());
 	}
 
-	template <typename N>
+	template <typename T, typename N>
 	inline
-	void multiply_add(const scalar_t* first, N n, scalar_t* out, scalar_t scalar) {
+	void multiply_add(const T* first, N n, T* out, scalar_t scalar) {
 		binary_transform(first, out, n, out, multiply_with_scalar_and_add_op(scalar));
 	}
 }
@@ -3,12 +3,97 @@
 #define STD_DSP_COPY_TRANSFORMS_GUARD
 
 #include <iostream>
+#include <iterator>
 
 #include "../../base/std_dsp_computational_basis.h"
+#include "../../base/std_dsp_cpu_features.h"
+#include "../../base/std_dsp_simd_kernel.h"
 
 #include "functors.h"
 
 namespace std_dsp {
+	namespace detail {
+		//Processes the largest multiple of the vector width with AVX2 and returns the count.
+		//Peels to the alignment of out, then stores aligned.
+		template <typename T, typename N, typename Op>
+		inline STD_DSP_TARGET_AVX2
+		N copy_transform_avx2(const T* first, N n, T* out, Op& op) {
+			using V = typename vector_types<T>::avx2;
+			using kernel = simd_kernel<V, unroll_factor<algorithm_tags::copy_transform, V>::value, false, true>;
+			const N head = alignment_head<sizeof(V)>(out, n);
+			for(N i = 0; i < head; ++i)
+				out[i] = op(first[i]);
+			return head + kernel::transform(first + head, n - head, out + head, op);
+		}
+
+		//Processes all n elements with AVX-512, the head and the last partial vector with masked loads and stores
+		template <typename T, typename N, typename Op>
+		inline STD_DSP_TARGET_AVX512
+		N copy_transform_avx512(const T* first, N n, T* out, Op& op) {
+			using V = typename vector_types<T>::avx512;
+			using kernel = simd_kernel<V, unroll_factor<algorithm_tags::copy_transform, V>::value, false, true>;
+			const N head = alignment_head<sizeof(V)>(out, n);
+			if(head)
+				kernel::transform_tail(first, head, out, op);
+			const N vector_n = head + kernel::transform(first + head, n - head, out + head, op);
+			if(vector_n != n)
+				kernel::transform_tail(first + vector_n, n - vector_n, out + vector_n, op);
+			return n;
+		}
+
+		//Processes the largest multiple of the vector width with SSE. Peels to the alignment of out
+		//and loads aligned only when the input shares it.
+		template <typename I, typename N, typename O, typename Op>
+		inline
+		N copy_transform_sse(I, N, O, Op&, simd_tag<0>) {
+			return N(0);
+		}
+
+		template <typename T, typename N, typename Op>
+		inline
+		N copy_transform_sse(const T* first, N n, T* out, Op& op, simd_tag<1>) {
+			using V = typename vector_types<T>::sse;
+			using aligned_kernel = simd_kernel<V, unroll_factor<algorithm_tags::copy_transform, V>::value, true, true>;
+			using unaligned_kernel = simd_kernel<V, unroll_factor<algorithm_tags::copy_transform, V>::value, false, true>;
+			const N head = alignment_head<sizeof(V)>(out, n);
+			for(N i = 0; i < head; ++i)
+				out[i] = op(first[i]);
+
+			first += head;
+			if(is_aligned_to<sizeof(V)>(first))
+				return head + aligned_kernel::transform(first, n - head, out + head, op);
+			return head + unaligned_kernel::transform(first, n - head, out + head, op);
+		}
+
+		template <typename I, typename N, typename O, typename Op>
+		inline
+		N copy_transform_dispatch(I, N, O, Op&, simd_tag<0>) {
+			return N(0);
+		}
+
+		template <typename T, typename N, typename Op>
+		inline
+		N copy_transform_dispatch(const T* first, N n, T* out, Op& op, simd_tag<1>) {
+			if(use_avx2())
+				return copy_transform_avx2(first, n, out, op);
+			return N(0);
+		}
+
+		template <typename T, typename N, typename Op>
+		inline
+		N copy_transform_dispatch(const T* first, N n, T* out, Op& op, simd_tag<2>) {
+			if(use_avx512())
+				return copy_transform_avx512(first, n, out, op);
+			return copy_transform_dispatch(first, n, out, op, simd_tag<1>());
+		}
+
+		//The widest level the iterators and the operator allow for element type T
+		template <typename T, typename I, typename O, typename Op>
+		using copy_transform_tag = simd_tag_for<are_pointers<I, O>::value,
+			is_vector_op<Op(typename vector_types<T>::avx2)>::value,
+			is_vector_op<Op(typename vector_types<T>::avx512)>::value>;
+	}
+
 	template <typename I, typename N, typename O, typename Op>
 	inline
 	void copy_transform_scalar(I first, N n, O out, Op op) {
@@ -30,66 +115,125 @@ namespace std_dsp {
 		}
 	}
 
+	namespace detail {
+		template <typename N, typename Op>
+		inline
+		N copy_transform_vector_loop(const double* first, N n, double* out, Op& op, std::true_type) {
+			return copy_transform_sse(first, n, out, op, simd_tag<1>());
+		}
+
+		//Other iterators access memory through their own load2/store2, which are aligned
+		template <typename I, typename N, typename O, typename Op>
+		inline
+		N copy_transform_vector_loop(I first, N n, O out, Op& op, std::false_type) {
+			if(n == 0 || !check_alignment(first, out))
+				return N(0);
+
+			N head = 0;
+			if(is_odd_aligned(out)) {
+				*out = op(*first);
+				++first;
+				++out;
+				head = 1;
+			}
+
+			using kernel = simd_kernel<double2_t, unroll_factor<algorithm_tags::copy_transform, double2_t>::value, true>;
+			return head + kernel::transform(first, n - head, out, op);
+		}
+	}
+
 	template <typename I, typename N, typename O, typename Op>
 	inline
 	void copy_transform_vector(I first, N n, O out, Op op) {
-		std::pair<std::size_t, std::size_t> partitions = unroll_partition_8(n);
-		while(partitions.first) {
-			double2_t x0 = load2(first, 0);
-			double2_t x1 = load2(first, 2);
-			double2_t x2 = load2(first, 4);
-			double2_t x3 = load2(first, 6);
-
-			partitions.first -= 8;
-
-			x0 = op(x0);
-			x1 = op(x1);
-			x2 = op(x2);
-			x3 = op(x3);
-
-			store2(out, 0, x0);
-			store2(out, 2, x1);
-			store2(out, 4, x2);
-			store2(out, 6, x3);
-
-			first += 8;
-			out += 8;
-		}
+		const N wide_n = detail::copy_transform_dispatch(first, n, out, op,
+			detail::copy_transform_tag<double, I, O, Op>());
+		first += wide_n;
+		out += wide_n;
+		n -= wide_n;
 
-		while(partitions.second) {
-			--partitions.second;
+		const N vector_n = detail::copy_transform_vector_loop(first, n, out, op,
+			std::integral_constant<bool, detail::are_pointers<I, O>::value>());
+		first += vector_n;
+		out += vector_n;
+		n -= vector_n;
+
+		while(n) {
+			--n;
 			*out = op(*first);
 			++first;
 			++out;
 		}
 	}
 
-	template <typename I, typename N, typename O, typename Op>
-	inline
-	void copy_transform(I first, N n, O out, Op op) {
-		while(n) {
-			if(!check_alignment(first, out)) {
-				copy_transform_scalar(first, n, out, op);
-				return;
+	namespace detail {
+		//Selected by the value type of the input
+		template <typename T>
+		struct copy_transform_kernel {
+			template <typename I, typename N, typename O, typename Op>
+			inline
+			void operator()(I first, N n, O out, Op& op) {
+				while(n) {
+					--n;
+					*out = op(*first);
+					++first;
+					++out;
+				}
 			}
+		};
 
-			if(is_odd_aligned(first)) {
-				*out = op(*first);
-				++first;
-				++out;
-				--n;
+		template <>
+		struct copy_transform_kernel<double> {
+			template <typename I, typename N, typename O, typename Op>
+			inline
+			void operator()(I first, N n, O out, Op& op) {
+				while(n) {
+					auto fast_n = fast_count(first, out, n);
+					auto fast_first = get_fast_iterator(first);
+					auto fast_out = get_fast_iterator(out);
+
+					copy_transform_vector(fast_first, fast_n, fast_out, op);
+
+					n -= fast_n;
+					first += fast_n;
+					out += fast_n;
+				}
 			}
+		};
 
-			auto fast_n = fast_count(first, out, n);
-			auto fast_first = get_fast_iterator(first);
-			auto fast_out = get_fast_iterator(out);
+		//Each vector is loaded before it is stored, so in place use (first == out) is fine too
+		template <>
+		struct copy_transform_kernel<float> {
+			template <typename I, typename N, typename O, typename Op>
+			inline
+			void operator()(I first, N n, O out, Op& op) {
+				using sse_tag = simd_tag_for<are_pointers<I, O>::value,
+					is_vector_op<Op(float4_t)>::value, false>;
+				const N wide_n = copy_transform_dispatch(first, n, out, op,
+					copy_transform_tag<float, I, O, Op>());
+				first += wide_n;
+				out += wide_n;
+				n -= wide_n;
 
-			copy_transform_vector(fast_first, fast_n, fast_out, op);
+				const N sse_n = copy_transform_sse(first, n, out, op, sse_tag());
+				first += sse_n;
+				out += sse_n;
+				n -= sse_n;
 
-			n -= fast_n;
-			first += fast_n;
-			out += fast_n;
-		}
+				while(n) {
+					--n;
+					*out = op(*first);
+					++first;
+					++out;
+				}
+			}
+		};
+	}
+
+	template <typename I, typename N, typename O, typename Op>
+	inline
+	void copy_transform(I first, N n, O out, Op op) {
+		detail::copy_transform_kernel<typename std::iterator_traits<I>::value_type> kernel;
+		kernel(first, n, out, op);
 	}
 
 	template <typename I, typename N, typename O>
@@ -4,10 +4,71 @@
 
 #include <cstdlib>
 #include <cmath>
+#include <type_traits>
+#include <utility>
 
 #include "../../base/std_dsp_computational_basis.h"
 
 namespace std_dsp {
+	namespace detail {
+		template <typename... T>
+		struct make_void { using type = void; };
+
+		//Detects whether a functor implements the vector overload a wide kernel needs,
+		//so functors written only for double2_t keep working on the narrower path.
+		//Usage: is_vector_op<Op(double4_t, double4_t)>::value
+		template <typename SIGNATURE, typename = void>
+		struct is_vector_op : std::false_type {};
+
+		template <typename Op, typename... V>
+		struct is_vector_op<Op(V...), typename make_void<decltype(std::declval<Op&>()(std::declval<V>()...))>::type>
+			: std::true_type {};
+
+		template <typename Op, typename = void>
+		struct is_vector_generator4 : std::false_type {};
+
+		template <typename Op>
+		struct is_vector_generator4<Op, typename make_void<decltype(std::declval<Op&>().get4())>::type>
+			: std::true_type {};
+
+		template <typename Op, typename = void>
+		struct is_vector_generator8 : std::false_type {};
+
+		template <typename Op>
+		struct is_vector_generator8<Op, typename make_void<decltype(std::declval<Op&>().get8())>::type>
+			: std::true_type {};
+
+		template <typename Op, typename = void>
+		struct is_float_generator4 : std::false_type {};
+
+		template <typename Op>
+		struct is_float_generator4<Op, typename make_void<decltype(std::declval<Op&>().get4f())>::type>
+			: std::true_type {};
+
+		template <typename Op, typename = void>
+		struct is_float_generator8 : std::false_type {};
+
+		template <typename Op>
+		struct is_float_generator8<Op, typename make_void<decltype(std::declval<Op&>().get8f())>::type>
+			: std::true_type {};
+
+		//The wide kernels only take raw pointers
+		template <typename... I>
+		struct are_pointers : std::true_type {};
+
+		template <typename I, typename... R>
+		struct are_pointers<I, R...>
+			: std::integral_constant<bool, std::is_pointer<I>::value && are_pointers<R...>::value> {};
+
+		//Selects the widest kernel family usable for a call: 0 for none, 1 for AVX2, 2 for AVX-512.
+		//The runtime check against the host CPU happens in the dispatch functions.
+		template <int LEVEL>
+		using simd_tag = std::integral_constant<int, LEVEL>;
+
+		template <bool POINTERS, bool WIDTH4, bool WIDTH8>
+		using simd_tag_for = simd_tag<!POINTERS || !WIDTH4 ? 0 : (WIDTH8 ? 2 : 1)>;
+	}
+
 	namespace functors {
 		template <typename Op1, typename Op2>
 		struct binary_op {
@@ -23,7 +84,23 @@ namespace std_dsp {
 			inline
 			double2_t operator()(double2_t x) {
 				return op2(op1(x));
-			}			
+			}
+			inline STD_DSP_TARGET_AVX2
+			double4_t operator()(double4_t x) {
+				return op2(op1(x));
+			}
+			inline STD_DSP_TARGET_AVX512
+			double8_t operator()(double8_t x) {
+				return op2(op1(x));
+			}
+			inline
+			float4_t operator()(float4_t x) {
+				return op2(op1(x));
+			}
+			inline STD_DSP_TARGET_AVX2
+			float8_t operator()(float8_t x) {
+				return op2(op1(x));
+			}
 		};
 
 		template <typename R, typename RT, typename T>
@@ -49,6 +126,53 @@ namespace std_dsp {
 				r_op(rt_op(x));
 				return t_op(x);
 			}
+			inline STD_DSP_TARGET_AVX2
+			double4_t operator()(double4_t x) {
+				r_op(rt_op(x));
+				return t_op(x);
+			}
+			inline STD_DSP_TARGET_AVX512
+			double8_t operator()(double8_t x) {
+				r_op(rt_op(x));
+				return t_op(x);
+			}
+			inline STD_DSP_TARGET_AVX512
+			double8_t operator()(mask8_t mask, double8_t x) {
+				r_op(mask, rt_op(x));
+				return t_op(x);
+			}
+			//The reduction always runs in double precision
+			inline
+			float4_t operator()(float4_t x) {
+				const float4_t r = rt_op(x);
+				r_op(lower_double(r));
+				r_op(upper_double(r));
+				return t_op(x);
+			}
+			inline STD_DSP_TARGET_AVX2
+			float8_t operator()(float8_t x) {
+				const float8_t r = rt_op(x);
+				r_op(lower_double(r));
+				r_op(upper_double(r));
+				return t_op(x);
+			}
+
+			inline STD_DSP_TARGET_AVX2
+			void init4() {
+				r_op.init4();
+			}
+			inline STD_DSP_TARGET_AVX2
+			void fold4() {
+				r_op.fold4();
+			}
+			inline STD_DSP_TARGET_AVX512
+			void init8() {
+				r_op.init8();
+			}
+			inline STD_DSP_TARGET_AVX512
+			void fold8() {
+				r_op.fold8();
+			}
 
 			inline
 			scalar_t get() {
@@ -66,6 +190,18 @@ namespace std_dsp {
 
 			inline
 			double2_t get2() { return zero(); }
+
+			inline STD_DSP_TARGET_AVX2
+			double4_t get4() { return zero4(); }
+
+			inline STD_DSP_TARGET_AVX512
+			double8_t get8() { return zero8(); }
+
+			inline
+			float4_t get4f() { return zero4f(); }
+
+			inline STD_DSP_TARGET_AVX2
+			float8_t get8f() { return zero8f(); }
 		};
 
 		struct constant_generator_op {
@@ -82,6 +218,18 @@ namespace std_dsp {
 
 			inline
 			double2_t get2() { return v; }
+
+			inline STD_DSP_TARGET_AVX2
+			double4_t get4() { return load4(s); }
+
+			inline STD_DSP_TARGET_AVX512
+			double8_t get8() { return load8(s); }
+
+			inline
+			float4_t get4f() { return load4f(static_cast<float>(s)); }
+
+			inline STD_DSP_TARGET_AVX2
+			float8_t get8f() { return load8f(static_cast<float>(s)); }
 		};
 
 		namespace detail {
@@ -93,6 +241,24 @@ namespace std_dsp {
 			double2_t uniform2() {
 				return load2(uniform1(), uniform1());
 			}
+			inline STD_DSP_TARGET_AVX2
+			double4_t uniform4() {
+				return _mm256_set_pd(uniform1(), uniform1(), uniform1(), uniform1());
+			}
+			inline STD_DSP_TARGET_AVX512
+			double8_t uniform8() {
+				return _mm512_set_pd(uniform1(), uniform1(), uniform1(), uniform1(),
+					uniform1(), uniform1(), uniform1(), uniform1());
+			}
+			inline
+			float4_t uniform4f() {
+				return _mm_set_ps(static_cast<float>(uniform1()), static_cast<float>(uniform1()),
+					static_cast<float>(uniform1()), static_cast<float>(uniform1()));
+			}
+			inline STD_DSP_TARGET_AVX2
+			float8_t uniform8f() {
+				return _mm256_set_m128(uniform4f(), uniform4f());
+			}
 		}
 
 		struct random_generator_op {
@@ -110,7 +276,23 @@ namespace std_dsp {
 			scalar_t get1() { return offset + scale * detail::uniform1(); }
 
 			inline
-			double2_t get2() { return add(offset_v, multiply(scale_v, detail::uniform2())); }			
+			double2_t get2() { return add(offset_v, multiply(scale_v, detail::uniform2())); }
+
+			inline STD_DSP_TARGET_AVX2
+			double4_t get4() { return multiply_add(load4(scale), detail::uniform4(), load4(offset)); }
+
+			inline STD_DSP_TARGET_AVX512
+			double8_t get8() { return multiply_add(load8(scale), detail::uniform8(), load8(offset)); }
+
+			inline
+			float4_t get4f() {
+				return multiply_add(load4f(static_cast<float>(scale)), detail::uniform4f(), load4f(static_cast<float>(offset)));
+			}
+
+			inline STD_DSP_TARGET_AVX2
+			float8_t get8f() {
+				return multiply_add(load8f(static_cast<float>(scale)), detail::uniform8f(), load8f(static_cast<float>(offset)));
+			}
 		};
 	}
 
@@ -120,6 +302,14 @@ namespace std_dsp {
 			scalar_t operator()(scalar_t x) { return x; }
 			inline
 			double2_t operator()(double2_t x) { return x; }
+			inline STD_DSP_TARGET_AVX2
+			double4_t operator()(double4_t x) { return x; }
+			inline STD_DSP_TARGET_AVX512
+			double8_t operator()(double8_t x) { return x; }
+			inline
+			float4_t operator()(float4_t x) { return x; }
+			inline STD_DSP_TARGET_AVX2
+			float8_t operator()(float8_t x) { return x; }
 		};
 
 		struct add_op {
@@ -133,12 +323,28 @@ namespace std_dsp {
 
 			inline
 			scalar_t operator()(scalar_t x) {
-				return x * s;
+				return x + s;
 			}
 			inline
 			double2_t operator()(double2_t x) {
 				return add(x, v);
 			}
+			inline STD_DSP_TARGET_AVX2
+			double4_t operator()(double4_t x) {
+				return add(x, load4(s));
+			}
+			inline STD_DSP_TARGET_AVX512
+			double8_t operator()(double8_t x) {
+				return add(x, load8(s));
+			}
+			inline
+			float4_t operator()(float4_t x) {
+				return add(x, load4f(static_cast<float>(s)));
+			}
+			inline STD_DSP_TARGET_AVX2
+			float8_t operator()(float8_t x) {
+				return add(x, load8f(static_cast<float>(s)));
+			}
 		};
 
 		struct multiply_op {
@@ -158,6 +364,22 @@ namespace std_dsp {
 			double2_t operator()(double2_t x) {
 				return multiply(x, v);
 			}
+			inline STD_DSP_TARGET_AVX2
+			double4_t operator()(double4_t x) {
+				return multiply(x, load4(s));
+			}
+			inline STD_DSP_TARGET_AVX512
+			double8_t operator()(double8_t x) {
+				return multiply(x, load8(s));
+			}
+			inline
+			float4_t operator()(float4_t x) {
+				return multiply(x, load4f(static_cast<float>(s)));
+			}
+			inline STD_DSP_TARGET_AVX2
+			float8_t operator()(float8_t x) {
+				return multiply(x, load8f(static_cast<float>(s)));
+			}
 		};
 
 		struct abs_op {
@@ -175,6 +397,22 @@ namespace std_dsp {
 			double2_t operator()(double2_t x) {
 				return std_dsp::abs(x, sign_mask);
 			}
+			inline STD_DSP_TARGET_AVX2
+			double4_t operator()(double4_t x) {
+				return std_dsp::abs(x, load4(-0.0));
+			}
+			inline STD_DSP_TARGET_AVX512
+			double8_t operator()(double8_t x) {
+				return std_dsp::abs(x, load8(-0.0));
+			}
+			inline
+			float4_t operator()(float4_t x) {
+				return std_dsp::abs(x, load4f(-0.0f));
+			}
+			inline STD_DSP_TARGET_AVX2
+			float8_t operator()(float8_t x) {
+				return std_dsp::abs(x, load8f(-0.0f));
+			}
 		};		
 
 		struct square_op {
@@ -186,6 +424,22 @@ namespace std_dsp {
 			double2_t operator()(double2_t x) {
 				return multiply(x, x);
 			}
+			inline STD_DSP_TARGET_AVX2
+			double4_t operator()(double4_t x) {
+				return multiply(x, x);
+			}
+			inline STD_DSP_TARGET_AVX512
+			double8_t operator()(double8_t x) {
+				return multiply(x, x);
+			}
+			inline
+			float4_t operator()(float4_t x) {
+				return multiply(x, x);
+			}
+			inline STD_DSP_TARGET_AVX2
+			float8_t operator()(float8_t x) {
+				return multiply(x, x);
+			}
 		};
 
 		struct clip_op {
@@ -211,6 +465,22 @@ namespace std_dsp {
 			double2_t operator()(double2_t x) {
 				return minimum(maximum(x, min_level_v), max_level_v);
 			}
+			inline STD_DSP_TARGET_AVX2
+			double4_t operator()(double4_t x) {
+				return minimum(maximum(x, load4(min_level)), load4(max_level));
+			}
+			inline STD_DSP_TARGET_AVX512
+			double8_t operator()(double8_t x) {
+				return minimum(maximum(x, load8(min_level)), load8(max_level));
+			}
+			inline
+			float4_t operator()(float4_t x) {
+				return minimum(maximum(x, load4f(static_cast<float>(min_level))), load4f(static_cast<float>(max_level)));
+			}
+			inline STD_DSP_TARGET_AVX2
+			float8_t operator()(float8_t x) {
+				return minimum(maximum(x, load8f(static_cast<float>(min_level))), load8f(static_cast<float>(max_level)));
+			}
 		};
 
 		struct cubic_clip_op {
@@ -253,6 +523,54 @@ namespace std_dsp {
 				x = subtract(x, y);
 				return multiply(x, three_halves_v);
 			}
+
+			inline STD_DSP_TARGET_AVX2
+			double4_t operator()(double4_t x) {
+				x = multiply(x, load4(0.707945784384138));
+				x = maximum(x, load4(-1.0));
+				x = minimum(x, load4(1.0));
+				double4_t y = multiply(x, x);
+				y = multiply(y, x);
+				y = multiply(y, load4(one_third));
+				x = subtract(x, y);
+				return multiply(x, load4(three_halves));
+			}
+
+			inline STD_DSP_TARGET_AVX512
+			double8_t operator()(double8_t x) {
+				x = multiply(x, load8(0.707945784384138));
+				x = maximum(x, load8(-1.0));
+				x = minimum(x, load8(1.0));
+				double8_t y = multiply(x, x);
+				y = multiply(y, x);
+				y = multiply(y, load8(one_third));
+				x = subtract(x, y);
+				return multiply(x, load8(three_halves));
+			}
+
+			inline
+			float4_t operator()(float4_t x) {
+				x = multiply(x, load4f(0.707945784384138f));
+				x = maximum(x, load4f(-1.0f));
+				x = minimum(x, load4f(1.0f));
+				float4_t y = multiply(x, x);
+				y = multiply(y, x);
+				y = multiply(y, load4f(static_cast<float>(one_third)));
+				x = subtract(x, y);
+				return multiply(x, load4f(static_cast<float>(three_halves)));
+			}
+
+			inline STD_DSP_TARGET_AVX2
+			float8_t operator()(float8_t x) {
+				x = multiply(x, load8f(0.707945784384138f));
+				x = maximum(x, load8f(-1.0f));
+				x = minimum(x, load8f(1.0f));
+				float8_t y = multiply(x, x);
+				y = multiply(y, x);
+				y = multiply(y, load8f(static_cast<float>(one_third)));
+				x = subtract(x, y);
+				return multiply(x, load8f(static_cast<float>(three_halves)));
+			}
 		};		
 	}
 
@@ -260,6 +578,8 @@ namespace std_dsp {
 		struct min_value_op {
 			scalar_t s; //Scalar
 			double2_t v; //Vector
+			double4_t v4; //Wide vector, only live between init4 and fold4
+			double8_t v8; //Widest vector, only live between init8 and fold8
 
 			min_value_op() : s(0.0), v(load2(0.0, 0.0)) {}
 
@@ -267,6 +587,8 @@ namespace std_dsp {
 			void init(scalar_t first) {
 				s = first;
 				v = load2(first, first);
+				v4 = double4_t();
+				v8 = double8_t();
 			}
 
 			inline
@@ -278,6 +600,38 @@ namespace std_dsp {
 			void operator()(double2_t x) {
 				v = minimum(x, v);
 			}
+			inline STD_DSP_TARGET_AVX2
+			void operator()(double4_t x) {
+				v4 = minimum(x, v4);
+			}
+
+			inline STD_DSP_TARGET_AVX2
+			void init4() {
+				v4 = load4(s);
+			}
+			inline STD_DSP_TARGET_AVX2
+			void fold4() {
+				v = minimum(v, minimum(lower_half(v4), upper_half(v4)));
+			}
+			inline STD_DSP_TARGET_AVX512
+			void operator()(double8_t x) {
+				v8 = minimum(x, v8);
+			}
+			//Accumulates only the lanes in the mask
+			inline STD_DSP_TARGET_AVX512
+			void operator()(mask8_t mask, double8_t x) {
+				v8 = select(mask, minimum(x, v8), v8);
+			}
+
+			inline STD_DSP_TARGET_AVX512
+			void init8() {
+				v8 = load8(s);
+			}
+			inline STD_DSP_TARGET_AVX512
+			void fold8() {
+				const double4_t w = minimum(lower_half(v8), upper_half(v8));
+				v = minimum(v, minimum(lower_half(w), upper_half(w)));
+			}
 
 			scalar_t get() {
 				SSE_ALIGN scalar_t tmp[2];
@@ -300,11 +654,15 @@ namespace std_dsp {
 		struct max_value_op {
 			scalar_t s; //Scalar
 			double2_t v; //Vector
+			double4_t v4; //Wide vector, only live between init4 and fold4
+			double8_t v8; //Widest vector, only live between init8 and fold8
 
 			inline
 			void init(scalar_t first) {
 				s = first;
 				v = load2(first, first);
+				v4 = double4_t();
+				v8 = double8_t();
 			}
 
 			inline
@@ -316,6 +674,38 @@ namespace std_dsp {
 			void operator()(double2_t x) {
 				v = maximum(x, v);
 			}
+			inline STD_DSP_TARGET_AVX2
+			void operator()(double4_t x) {
+				v4 = maximum(x, v4);
+			}
+
+			inline STD_DSP_TARGET_AVX2
+			void init4() {
+				v4 = load4(s);
+			}
+			inline STD_DSP_TARGET_AVX2
+			void fold4() {
+				v = maximum(v, maximum(lower_half(v4), upper_half(v4)));
+			}
+			inline STD_DSP_TARGET_AVX512
+			void operator()(double8_t x) {
+				v8 = maximum(x, v8);
+			}
+			//Accumulates only the lanes in the mask
+			inline STD_DSP_TARGET_AVX512
+			void operator()(mask8_t mask, double8_t x) {
+				v8 = select(mask, maximum(x, v8), v8);
+			}
+
+			inline STD_DSP_TARGET_AVX512
+			void init8() {
+				v8 = load8(s);
+			}
+			inline STD_DSP_TARGET_AVX512
+			void fold8() {
+				const double4_t w = maximum(lower_half(v8), upper_half(v8));
+				v = maximum(v, maximum(lower_half(w), upper_half(w)));
+			}
 
 			scalar_t get() {
 				SSE_ALIGN scalar_t tmp[2];
@@ -338,11 +728,15 @@ namespace std_dsp {
 		struct sum_op {
 			scalar_t s; //Scalar
 			double2_t v; //Vector
+			double4_t v4; //Wide vector, only live between init4 and fold4
+			double8_t v8; //Widest vector, only live between init8 and fold8
 
 			inline
 			void init(scalar_t first) {
 				s = first;
 				v = load2(0.0, 0.0);
+				v4 = double4_t();
+				v8 = double8_t();
 			}
 
 			inline
@@ -353,6 +747,38 @@ namespace std_dsp {
 			void operator()(double2_t x) {
 				v = add(x, v);
 			}
+			inline STD_DSP_TARGET_AVX2
+			void operator()(double4_t x) {
+				v4 = add(x, v4);
+			}
+
+			inline STD_DSP_TARGET_AVX2
+			void init4() {
+				v4 = zero4();
+			}
+			inline STD_DSP_TARGET_AVX2
+			void fold4() {
+				v = add(v, add(lower_half(v4), upper_half(v4)));
+			}
+			inline STD_DSP_TARGET_AVX512
+			void operator()(double8_t x) {
+				v8 = add(x, v8);
+			}
+			//Accumulates only the lanes in the mask
+			inline STD_DSP_TARGET_AVX512
+			void operator()(mask8_t mask, double8_t x) {
+				v8 = select(mask, add(x, v8), v8);
+			}
+
+			inline STD_DSP_TARGET_AVX512
+			void init8() {
+				v8 = zero8();
+			}
+			inline STD_DSP_TARGET_AVX512
+			void fold8() {
+				const double4_t w = add(lower_half(v8), upper_half(v8));
+				v = add(v, add(lower_half(w), upper_half(w)));
+			}
 
 			scalar_t get() {
 				SSE_ALIGN scalar_t tmp[2];
@@ -365,11 +791,15 @@ namespace std_dsp {
 		struct product_op {
 			scalar_t s; //Scalar
 			double2_t v; //Vector
+			double4_t v4; //Wide vector, only live between init4 and fold4
+			double8_t v8; //Widest vector, only live between init8 and fold8
 
 			inline
 			void init(scalar_t first) {
 				s = first;
 				v = load2(1.0, 1.0);
+				v4 = double4_t();
+				v8 = double8_t();
 			}
 
 			inline
@@ -380,6 +810,38 @@ namespace std_dsp {
 			void operator()(double2_t x) {
 				v = multiply(x, v);
 			}
+			inline STD_DSP_TARGET_AVX2
+			void operator()(double4_t x) {
+				v4 = multiply(x, v4);
+			}
+
+			inline STD_DSP_TARGET_AVX2
+			void init4() {
+				v4 = load4(1.0);
+			}
+			inline STD_DSP_TARGET_AVX2
+			void fold4() {
+				v = multiply(v, multiply(lower_half(v4), upper_half(v4)));
+			}
+			inline STD_DSP_TARGET_AVX512
+			void operator()(double8_t x) {
+				v8 = multiply(x, v8);
+			}
+			//Accumulates only the lanes in the mask
+			inline STD_DSP_TARGET_AVX512
+			void operator()(mask8_t mask, double8_t x) {
+				v8 = select(mask, multiply(x, v8), v8);
+			}
+
+			inline STD_DSP_TARGET_AVX512
+			void init8() {
+				v8 = load8(1.0);
+			}
+			inline STD_DSP_TARGET_AVX512
+			void fold8() {
+				const double4_t w = multiply(lower_half(v8), upper_half(v8));
+				v = multiply(v, multiply(lower_half(w), upper_half(w)));
+			}
 
 			scalar_t get() {
 				SSE_ALIGN scalar_t tmp[2];
@@ -410,6 +872,36 @@ namespace std_dsp {
 			void operator()(double2_t x) {
 				inner_op(std_dsp::abs(x, sign_mask));
 			}
+			inline STD_DSP_TARGET_AVX2
+			void operator()(double4_t x) {
+				inner_op(std_dsp::abs(x, load4(-0.0)));
+			}
+
+			inline STD_DSP_TARGET_AVX2
+			void init4() {
+				inner_op.init4();
+			}
+			inline STD_DSP_TARGET_AVX2
+			void fold4() {
+				inner_op.fold4();
+			}
+			inline STD_DSP_TARGET_AVX512
+			void operator()(double8_t x) {
+				inner_op(std_dsp::abs(x, load8(-0.0)));
+			}
+			inline STD_DSP_TARGET_AVX512
+			void operator()(mask8_t mask, double8_t x) {
+				inner_op(mask, std_dsp::abs(x, load8(-0.0)));
+			}
+
+			inline STD_DSP_TARGET_AVX512
+			void init8() {
+				inner_op.init8();
+			}
+			inline STD_DSP_TARGET_AVX512
+			void fold8() {
+				inner_op.fold8();
+			}
 
 			inline
 			scalar_t get() {
@@ -436,6 +928,36 @@ namespace std_dsp {
 			void operator()(double2_t x) {
 				inner_op(multiply(x, x));
 			}
+			inline STD_DSP_TARGET_AVX2
+			void operator()(double4_t x) {
+				inner_op(multiply(x, x));
+			}
+
+			inline STD_DSP_TARGET_AVX2
+			void init4() {
+				inner_op.init4();
+			}
+			inline STD_DSP_TARGET_AVX2
+			void fold4() {
+				inner_op.fold4();
+			}
+			inline STD_DSP_TARGET_AVX512
+			void operator()(double8_t x) {
+				inner_op(multiply(x, x));
+			}
+			inline STD_DSP_TARGET_AVX512
+			void operator()(mask8_t mask, double8_t x) {
+				inner_op(mask, multiply(x, x));
+			}
+
+			inline STD_DSP_TARGET_AVX512
+			void init8() {
+				inner_op.init8();
+			}
+			inline STD_DSP_TARGET_AVX512
+			void fold8() {
+				inner_op.fold8();
+			}
 
 			inline
 			scalar_t get() {
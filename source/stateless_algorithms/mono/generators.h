@@ -3,86 +3,138 @@
 #define STD_DSP_GENERATORS_GUARD
 
 #include "../../base/std_dsp_computational_basis.h"
+#include "../../base/std_dsp_cpu_features.h"
+#include "../../base/std_dsp_simd_kernel.h"
 
 #include "functors.h"
 
 namespace std_dsp {
+	namespace detail {
+		//Fills the largest multiple of the vector width with AVX2 and returns the count.
+		//Peels to the alignment of out, then stores aligned.
+		template <typename T, typename N, typename Op>
+		inline STD_DSP_TARGET_AVX2
+		N generate_avx2(N n, T* out, Op& op) {
+			using V = typename vector_types<T>::avx2;
+			using kernel = simd_kernel<V, unroll_factor<algorithm_tags::generate, V>::value, false, true>;
+			const N head = alignment_head<sizeof(V)>(out, n);
+			for(N i = 0; i < head; ++i)
+				out[i] = static_cast<T>(op.get1());
+			return head + kernel::generate(n - head, out + head, op);
+		}
+
+		//Fills all n elements with AVX-512, the head and the last partial vector with masked stores
+		template <typename T, typename N, typename Op>
+		inline STD_DSP_TARGET_AVX512
+		N generate_avx512(N n, T* out, Op& op) {
+			using V = typename vector_types<T>::avx512;
+			using kernel = simd_kernel<V, unroll_factor<algorithm_tags::generate, V>::value, false, true>;
+			const N head = alignment_head<sizeof(V)>(out, n);
+			if(head)
+				kernel::generate_tail(head, out, op);
+			const N vector_n = head + kernel::generate(n - head, out + head, op);
+			if(vector_n != n)
+				kernel::generate_tail(n - vector_n, out + vector_n, op);
+			return n;
+		}
+
+		//Fills the largest multiple of the vector width with SSE, after peeling to its alignment
+		template <typename T, typename N, typename Op>
+		inline
+		N generate_sse(N, T*, Op&, simd_tag<0>) {
+			return N(0);
+		}
+
+		template <typename T, typename N, typename Op>
+		inline
+		N generate_sse(N n, T* out, Op& op, simd_tag<1>) {
+			using V = typename vector_types<T>::sse;
+			using kernel = simd_kernel<V, unroll_factor<algorithm_tags::generate, V>::value, false, true>;
+			const N head = alignment_head<sizeof(V)>(out, n);
+			for(N i = 0; i < head; ++i)
+				out[i] = static_cast<T>(op.get1());
+			return head + kernel::generate(n - head, out + head, op);
+		}
+
+		template <typename T, typename N, typename Op>
+		inline
+		N generate_dispatch(N, T*, Op&, simd_tag<0>) {
+			return N(0);
+		}
+
+		template <typename T, typename N, typename Op>
+		inline
+		N generate_dispatch(N n, T* out, Op& op, simd_tag<1>) {
+			if(use_avx2())
+				return generate_avx2(n, out, op);
+			return N(0);
+		}
+
+		template <typename T, typename N, typename Op>
+		inline
+		N generate_dispatch(N n, T* out, Op& op, simd_tag<2>) {
+			if(use_avx512())
+				return generate_avx512(n, out, op);
+			return generate_dispatch(n, out, op, simd_tag<1>());
+		}
+	}
+
 	template <typename N, typename Op>
 	void generate(N n, double* out, Op op) {
-		if(op.is_const()) {
-			const double x1 = op.get1();
-			const double2_t x2 = op.get2();
-
-			if(is_odd_aligned(out)) {
-				*out = x1;
-				++out;
-				--n;
-			}
-
-			std::pair<std::size_t, std::size_t> partitions = unroll_partition_8(n);
-			while(partitions.first) {
-				partitions.first -= 8;
-
-				store2(out, 0, x2);
-				store2(out, 2, x2);
-				store2(out, 4, x2);
-				store2(out, 6, x2);
-
-				out += 8;
-			}
-
-			while(partitions.second) {
-				--partitions.second;
-				*out = x1;
-				++out;
-			}
-		} else {
-			if(is_odd_aligned(out)) {
-				*out = op.get1();
-				++out;
-				--n;
-			}
-
-			std::pair<std::size_t, std::size_t> partitions = unroll_partition_8(n);
-			while(partitions.first) {
-				partitions.first -= 8;
-
-				double2_t x0 = op.get2();
-				double2_t x1 = op.get2();
-				double2_t x2 = op.get2();
-				double2_t x3 = op.get2();
-
-				store2(out, x0);
-				store2(out + 2, x1);
-				store2(out + 4, x2);
-				store2(out + 6, x3);
-
-				out += 8;
-			}
-
-			while(partitions.second) {
-				--partitions.second;
-				*out = op.get1();
-				++out;
-			}
+		using wide_tag = detail::simd_tag_for<true,
+			detail::is_vector_generator4<Op>::value,
+			detail::is_vector_generator8<Op>::value>;
+		const N wide_n = detail::generate_dispatch(n, out, op, wide_tag());
+		out += wide_n;
+		n -= wide_n;
+
+		const N vector_n = detail::generate_sse(n, out, op, detail::simd_tag<1>());
+		out += vector_n;
+		n -= vector_n;
+
+		while(n) {
+			--n;
+			*out = op.get1();
+			++out;
+		}
+	}
+
+	template <typename N, typename Op>
+	void generate(N n, float* out, Op op) {
+		using wide_tag = detail::simd_tag_for<true,
+			detail::is_float_generator8<Op>::value, false>;
+		using sse_tag = detail::simd_tag_for<true,
+			detail::is_float_generator4<Op>::value, false>;
+		const N wide_n = detail::generate_dispatch(n, out, op, wide_tag());
+		out += wide_n;
+		n -= wide_n;
+
+		const N sse_n = detail::generate_sse(n, out, op, sse_tag());
+		out += sse_n;
+		n -= sse_n;
+
+		while(n) {
+			--n;
+			*out = static_cast<float>(op.get1());
+			++out;
 		}
 	}
 
-	template <typename N>
+	template <typename N, typename T>
 	inline
-	void zero(N n, double* out) {
+	void zero(N n, T* out) {
 		generate(n, out, generator_functors::zero_generator_op());
 	}
 
-	template <typename N>
+	template <typename N, typename T>
 	inline
-	void assign(N n, double* out, double value) {
+	void assign(N n, T* out, double value) {
 		generate(n, out, generator_functors::constant_generator_op(value));
 	}
 
-	template <typename N>
+	template <typename N, typename T>
 	inline
-	void randomize(N n, double* out, double a, double b) {
+	void randomize(N n, T* out, double a, double b) {
 		generate(n, out, generator_functors::random_generator_op(a, b));
 	}
 }
@@ -3,48 +3,138 @@
 #define STD_DSP_TERNARY_TRANSFORMS_GUARD
 
 #include "../../base/std_dsp_computational_basis.h"
+#include "../../base/std_dsp_cpu_features.h"
+#include "../../base/std_dsp_simd_kernel.h"
 
 #include "functors.h"
 
 namespace std_dsp {
+	namespace detail {
+		//Processes the largest multiple of the vector width with AVX2 and returns the count.
+		//Peels to the alignment of out, then stores aligned.
+		template <typename T, typename N, typename Op>
+		inline STD_DSP_TARGET_AVX2
+		N ternary_transform_avx2(const T* first1, const T* first2, const T* first3, N n, T* out, Op& op) {
+			using V = typename vector_types<T>::avx2;
+			using kernel = simd_kernel<V, unroll_factor<algorithm_tags::ternary_transform, V>::value, false, true>;
+			const N head = alignment_head<sizeof(V)>(out, n);
+			for(N i = 0; i < head; ++i)
+				out[i] = op(first1[i], first2[i], first3[i]);
+			return head + kernel::transform(first1 + head, first2 + head, first3 + head, n - head, out + head, op);
+		}
+
+		//Processes all n elements with AVX-512, the head and the last partial vector with masked loads and stores
+		template <typename T, typename N, typename Op>
+		inline STD_DSP_TARGET_AVX512
+		N ternary_transform_avx512(const T* first1, const T* first2, const T* first3, N n, T* out, Op& op) {
+			using V = typename vector_types<T>::avx512;
+			using kernel = simd_kernel<V, unroll_factor<algorithm_tags::ternary_transform, V>::value, false, true>;
+			const N head = alignment_head<sizeof(V)>(out, n);
+			if(head)
+				kernel::transform_tail(first1, first2, first3, head, out, op);
+			const N vector_n = head + kernel::transform(first1 + head, first2 + head, first3 + head, n - head, out + head, op);
+			if(vector_n != n)
+				kernel::transform_tail(first1 + vector_n, first2 + vector_n, first3 + vector_n, n - vector_n, out + vector_n, op);
+			return n;
+		}
+
+		//Processes the largest multiple of the vector width with SSE. Peels to the alignment of out
+		//and loads aligned only when the inputs share it.
+		template <typename T, typename N, typename Op>
+		inline
+		N ternary_transform_sse(const T* first1, const T* first2, const T* first3, N n, T* out, Op& op) {
+			using V = typename vector_types<T>::sse;
+			using aligned_kernel = simd_kernel<V, unroll_factor<algorithm_tags::ternary_transform, V>::value, true, true>;
+			using unaligned_kernel = simd_kernel<V, unroll_factor<algorithm_tags::ternary_transform, V>::value, false, true>;
+			const N head = alignment_head<sizeof(V)>(out, n);
+			for(N i = 0; i < head; ++i)
+				out[i] = op(first1[i], first2[i], first3[i]);
+
+			first1 += head;
+			first2 += head;
+			first3 += head;
+			if(is_aligned_to<sizeof(V)>(first1) && is_aligned_to<sizeof(V)>(first2) && is_aligned_to<sizeof(V)>(first3))
+				return head + aligned_kernel::transform(first1, first2, first3, n - head, out + head, op);
+			return head + unaligned_kernel::transform(first1, first2, first3, n - head, out + head, op);
+		}
+
+		template <typename T, typename N, typename Op>
+		inline
+		N ternary_transform_dispatch(const T*, const T*, const T*, N, T*, Op&, simd_tag<0>) {
+			return N(0);
+		}
+
+		template <typename T, typename N, typename Op>
+		inline
+		N ternary_transform_dispatch(const T* first1, const T* first2, const T* first3, N n, T* out, Op& op, simd_tag<1>) {
+			if(use_avx2())
+				return ternary_transform_avx2(first1, first2, first3, n, out, op);
+			return N(0);
+		}
+
+		template <typename T, typename N, typename Op>
+		inline
+		N ternary_transform_dispatch(const T* first1, const T* first2, const T* first3, N n, T* out, Op& op, simd_tag<2>) {
+			if(use_avx512())
+				return ternary_transform_avx512(first1, first2, first3, n, out, op);
+			return ternary_transform_dispatch(first1, first2, first3, n, out, op, simd_tag<1>());
+		}
+
+		//The widest level the operator allows for element type T
+		template <typename T, typename Op>
+		using ternary_transform_tag = simd_tag_for<true,
+			is_vector_op<Op(typename vector_types<T>::avx2, typename vector_types<T>::avx2, typename vector_types<T>::avx2)>::value,
+			is_vector_op<Op(typename vector_types<T>::avx512, typename vector_types<T>::avx512, typename vector_types<T>::avx512)>::value>;
+	}
+
 	template <typename N, typename Op>
 	inline
 	void ternary_transform(const double* first1, const double* first2, const double* first3, N n, double* out, Op op) {
-		std::pair<std::size_t, std::size_t> partitions = unroll_partition_8(n);
-		while(partitions.first) {
-			double2_t x10 = load2(first1, 0);
-			double2_t x11 = load2(first1, 2);
-			double2_t x12 = load2(first1, 4);
-			double2_t x13 = load2(first1, 6);
-			double2_t x20 = load2(first2, 0);
-			double2_t x21 = load2(first2, 2);
-			double2_t x22 = load2(first2, 4);
-			double2_t x23 = load2(first2, 6);
-			double2_t x30 = load2(first3, 0);
-			double2_t x31 = load2(first3, 2);
-			double2_t x32 = load2(first3, 4);
-			double2_t x33 = load2(first3, 6);
-
-			partitions.first -= 8;
-
-			x10 = op(x10, x20, x30);
-			x11 = op(x11, x21, x31);
-			x12 = op(x12, x22, x32);
-			x13 = op(x13, x23, x33);
-
-			store2(out, 0, x10);
-			store2(out, 2, x11);
-			store2(out, 4, x12);
-			store2(out, 6, x13);
-
-			first1 += 8;
-			first2 += 8;
-			first3 += 8;
-			out += 8;
-		}
-
-		while(partitions.second) {
-			--partitions.second;
+		const N wide_n = detail::ternary_transform_dispatch(first1, first2, first3, n, out, op,
+			detail::ternary_transform_tag<double, Op>());
+		first1 += wide_n;
+		first2 += wide_n;
+		first3 += wide_n;
+		out += wide_n;
+		n -= wide_n;
+
+		const N vector_n = detail::ternary_transform_sse(first1, first2, first3, n, out, op);
+		first1 += vector_n;
+		first2 += vector_n;
+		first3 += vector_n;
+		out += vector_n;
+		n -= vector_n;
+
+		while(n) {
+			--n;
+			*out = op(*first1, *first2, *first3);
+			++first1;
+			++first2;
+			++first3;
+			++out;
+		}
+	}
+
+	template <typename N, typename Op>
+	inline
+	void ternary_transform(const float* first1, const float* first2, const float* first3, N n, float* out, Op op) {
+		const N wide_n = detail::ternary_transform_dispatch(first1, first2, first3, n, out, op,
+			detail::ternary_transform_tag<float, Op>());
+		first1 += wide_n;
+		first2 += wide_n;
+		first3 += wide_n;
+		out += wide_n;
+		n -= wide_n;
+
+		const N sse_n = detail::ternary_transform_sse(first1, first2, first3, n, out, op);
+		first1 += sse_n;
+		first2 += sse_n;
+		first3 += sse_n;
+		out += sse_n;
+		n -= sse_n;
+
+		while(n) {
+			--n;
 			*out = op(*first1, *first2, *first3);
 			++first1;
 			++first2;
@@ -63,11 +153,27 @@ namespace std_dsp {
 		double2_t operator()(double2_t x1, double2_t x2, double2_t x3) {
 			return add(x3, multiply(x1, x2));
 		}
+		inline STD_DSP_TARGET_AVX2
+		double4_t operator()(double4_t x1, double4_t x2, double4_t x3) {
+			return multiply_add(x1, x2, x3);
+		}
+		inline STD_DSP_TARGET_AVX512
+		double8_t operator()(double8_t x1, double8_t x2, double8_t x3) {
+			return multiply_add(x1, x2, x3);
+		}
+		inline
+		float4_t operator()(float4_t x1, float4_t x2, float4_t x3) {
+			return multiply_add(x1, x2, x3);
+		}
+		inline STD_DSP_TARGET_AVX2
+		float8_t operator()(float8_t x1, float8_t x2, float8_t x3) {
+			return multiply_add(x1, x2, x3);
+		}
 	};
 
-	template <typename N>
+	template <typename T, typename N>
 	inline
-	void multiply_add(const double* first1, const double* first2, N n, double* out) {
+	void multiply_add(const T* first1, const T* first2, N n, T* out) {
 		ternary_transform(first1, first2, out, n, out, multiply_add_op());
 	}
 
@@ -91,17 +197,33 @@ namespace std_dsp {
 			double2_t m2 = multiply(x2, a2_v);
 			return add(x3, add(m1, m2));
 		}
+		inline STD_DSP_TARGET_AVX2
+		double4_t operator()(double4_t x1, double4_t x2, double4_t x3) {
+			return multiply_add(x1, load4(a1), multiply_add(x2, load4(a2), x3));
+		}
+		inline STD_DSP_TARGET_AVX512
+		double8_t operator()(double8_t x1, double8_t x2, double8_t x3) {
+			return multiply_add(x1, load8(a1), multiply_add(x2, load8(a2), x3));
+		}
+		inline
+		float4_t operator()(float4_t x1, float4_t x2, float4_t x3) {
+			return multiply_add(x1, load4f(static_cast<float>(a1)), multiply_add(x2, load4f(static_cast<float>(a2)), x3));
+		}
+		inline STD_DSP_TARGET_AVX2
+		float8_t operator()(float8_t x1, float8_t x2, float8_t x3) {
+			return multiply_add(x1, load8f(static_cast<float>(a1)), multiply_add(x2, load8f(static_cast<float>(a2)), x3));
+		}
 	};
 
-	template <typename N>
+	template <typename T, typename N>
 	inline
-	void linear_combination_add(const double* first1, const double* first2, N n, double* out, double a1, double a2) {
-		ternary_transform(first1, first2, out, n, out, multiply_add_op());
+	void linear_combination_add(const T* first1, const T* first2, N n, T* out, double a1, double a2) {
+		ternary_transform(first1, first2, out, n, out, linear_combination_add_op(a1, a2));
 	}
 
-	template <typename N>
+	template <typename T, typename N>
 	inline
-	void mix_add(const double* first1, const double* first2, N n, double* out, double frac) {
+	void mix_add(const T* first1, const T* first2, N n, T* out, double frac) {
 		linear_combination_add(first1, first2, n, out, 1.0 - frac, frac);
 	}
 }
@@ -9,9 +9,9 @@
 #include "functors.h"
 
 namespace std_dsp {
-	template <typename N>
+	template <typename T, typename N>
 	inline
-	bool clip_with_indicator(double* first, N n, double abs_clip) {
+	bool clip_with_indicator(T* first, N n, double abs_clip) {
 		using reduction_functors::max_value_op;
 		using transform_functors::abs_op;
 		using transform_functors::clip_op;
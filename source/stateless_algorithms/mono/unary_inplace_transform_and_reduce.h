@@ -3,48 +3,123 @@
 #define STD_DSP_UNARY_INPLACE_TRANSFORM_AND_REDUCE_GUARD
 
 #include "../../base/std_dsp_computational_basis.h"
+#include "../../base/std_dsp_cpu_features.h"
+#include "../../base/std_dsp_simd_kernel.h"
 
 #include "functors.h"
 
 namespace std_dsp {
-    template <typename N, typename Op>
-	double unary_inplace_transform_and_reduce(double* first, N n, Op op) {
-		if(is_odd_aligned(first)) {
-			*first = op(*first);
-			++first;
-			--n;
+	namespace detail {
+		//Processes the largest multiple of the vector width with AVX2 and returns the count.
+		//Peels to the alignment of the vector size, then loads and stores aligned.
+		template <typename T, typename N, typename Op>
+		inline STD_DSP_TARGET_AVX2
+		N unary_inplace_transform_and_reduce_avx2(T* first, N n, Op& op) {
+			using V = typename vector_types<T>::avx2;
+			using kernel = simd_kernel<V, unroll_factor<algorithm_tags::unary_inplace_transform_and_reduce, V>::value, true>;
+			const N head = alignment_head<sizeof(V)>(first, n);
+			for(N i = 0; i < head; ++i)
+				first[i] = static_cast<T>(op(first[i]));
+			op.init4();
+			const N vector_n = head + kernel::transform(first + head, n - head, first + head, op);
+			op.fold4();
+			return vector_n;
 		}
 
-		std::pair<std::size_t, std::size_t> partitions = unroll_partition_8(n);
-		while(partitions.first) {
-			double2_t x0 = load2(first, 0);
-			double2_t x1 = load2(first, 2);
-			double2_t x2 = load2(first, 4);
-			double2_t x3 = load2(first, 6);
+		//Processes all n elements with AVX-512, the head and the last partial vector with masked loads and stores
+		template <typename T, typename N, typename Op>
+		inline STD_DSP_TARGET_AVX512
+		N unary_inplace_transform_and_reduce_avx512(T* first, N n, Op& op) {
+			using V = typename vector_types<T>::avx512;
+			using kernel = simd_kernel<V, unroll_factor<algorithm_tags::unary_inplace_transform_and_reduce, V>::value, true>;
+			const N head = alignment_head<sizeof(V)>(first, n);
+			op.init8();
+			if(head)
+				kernel::transform_and_reduce_tail(first, head, op);
+			const N vector_n = head + kernel::transform(first + head, n - head, first + head, op);
+			if(vector_n != n)
+				kernel::transform_and_reduce_tail(first + vector_n, n - vector_n, op);
+			op.fold8();
+			return n;
+		}
 
-			partitions.first -= 8;
+		//Processes the largest multiple of the vector width with SSE, after peeling to its alignment
+		template <typename T, typename N, typename Op>
+		inline
+		N unary_inplace_transform_and_reduce_sse(T* first, N n, Op& op) {
+			using V = typename vector_types<T>::sse;
+			using kernel = simd_kernel<V, unroll_factor<algorithm_tags::unary_inplace_transform_and_reduce, V>::value, true>;
+			const N head = alignment_head<sizeof(V)>(first, n);
+			for(N i = 0; i < head; ++i)
+				first[i] = static_cast<T>(op(first[i]));
+			return head + kernel::transform(first + head, n - head, first + head, op);
+		}
 
-			x0 = op(x0);
-			x1 = op(x1);
-			x2 = op(x2);
-			x3 = op(x3);
+		template <typename T, typename N, typename Op>
+		inline
+		N unary_inplace_transform_and_reduce_dispatch(T*, N, Op&, simd_tag<0>) {
+			return N(0);
+		}
 
-			store2(first, 0, x0);
-			store2(first, 2, x1);
-			store2(first, 4, x2);
-			store2(first, 6, x3);
+		template <typename T, typename N, typename Op>
+		inline
+		N unary_inplace_transform_and_reduce_dispatch(T* first, N n, Op& op, simd_tag<1>) {
+			if(use_avx2())
+				return unary_inplace_transform_and_reduce_avx2(first, n, op);
+			return N(0);
+		}
 
-			first += 8;
+		template <typename T, typename N, typename Op>
+		inline
+		N unary_inplace_transform_and_reduce_dispatch(T* first, N n, Op& op, simd_tag<2>) {
+			if(use_avx512())
+				return unary_inplace_transform_and_reduce_avx512(first, n, op);
+			return unary_inplace_transform_and_reduce_dispatch(first, n, op, simd_tag<1>());
 		}
+	}
+
+	template <typename N, typename Op>
+	double unary_inplace_transform_and_reduce(double* first, N n, Op op) {
+		using wide_tag = detail::simd_tag_for<true,
+			detail::is_vector_op<Op(double4_t)>::value,
+			detail::is_vector_op<Op(mask8_t, double8_t)>::value>;
+		const N wide_n = detail::unary_inplace_transform_and_reduce_dispatch(first, n, op, wide_tag());
+		first += wide_n;
+		n -= wide_n;
 
-		while(partitions.second) {
-			--partitions.second;
+		const N vector_n = detail::unary_inplace_transform_and_reduce_sse(first, n, op);
+		first += vector_n;
+		n -= vector_n;
+
+		while(n) {
+			--n;
 			*first = op(*first);
 			++first;
 		}
 
 		return op.get();
 	}
+
+	template <typename N, typename Op>
+	double unary_inplace_transform_and_reduce(float* first, N n, Op op) {
+		using wide_tag = detail::simd_tag_for<true,
+			detail::is_vector_op<Op(float8_t)>::value, false>;
+		const N wide_n = detail::unary_inplace_transform_and_reduce_dispatch(first, n, op, wide_tag());
+		first += wide_n;
+		n -= wide_n;
+
+		const N vector_n = detail::unary_inplace_transform_and_reduce_sse(first, n, op);
+		first += vector_n;
+		n -= vector_n;
+
+		while(n) {
+			--n;
+			*first = static_cast<float>(op(*first));
+			++first;
+		}
+
+		return op.get();
+	}
 }
 
 #endif
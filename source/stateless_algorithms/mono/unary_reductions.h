@@ -3,47 +3,163 @@
 #define STD_DSP_UNARY_REDUCTION_GUARD
 
 #include "../../base/std_dsp_computational_basis.h"
+#include "../../base/std_dsp_cpu_features.h"
+#include "../../base/std_dsp_simd_kernel.h"
 
 #include "functors.h"
 
 namespace std_dsp {
+	namespace detail {
+		//Reduces the largest multiple of the vector width with AVX2 and returns the count.
+		//Peels to the alignment of the vector size so no load splits a cache line.
+		template <typename T, typename N, typename Op>
+		inline STD_DSP_TARGET_AVX2
+		N unary_reduction_avx2(const T* first, N n, Op& op) {
+			using V = typename vector_types<T>::avx2;
+			using kernel = simd_kernel<V, unroll_factor<algorithm_tags::unary_reduction, V>::value, true>;
+			const N head = alignment_head<sizeof(V)>(first, n);
+			for(N i = 0; i < head; ++i)
+				op(first[i]);
+			op.init4();
+			const N vector_n = head + kernel::reduce(first + head, n - head, op);
+			op.fold4();
+			return vector_n;
+		}
+
+		//Reduces all n elements with AVX-512, the head and the last partial vector through a masked accumulate
+		template <typename T, typename N, typename Op>
+		inline STD_DSP_TARGET_AVX512
+		N unary_reduction_avx512(const T* first, N n, Op& op) {
+			using V = typename vector_types<T>::avx512;
+			using kernel = simd_kernel<V, unroll_factor<algorithm_tags::unary_reduction, V>::value, true>;
+			const N head = alignment_head<sizeof(V)>(first, n);
+			op.init8();
+			if(head)
+				kernel::reduce_tail(first, head, op);
+			const N vector_n = head + kernel::reduce(first + head, n - head, op);
+			if(vector_n != n)
+				kernel::reduce_tail(first + vector_n, n - vector_n, op);
+			op.fold8();
+			return n;
+		}
+
+		//Reduces the largest multiple of the vector width with SSE, after peeling to its alignment
+		template <typename T, typename N, typename Op>
+		inline
+		N unary_reduction_sse(const T* first, N n, Op& op) {
+			using V = typename vector_types<T>::sse;
+			using kernel = simd_kernel<V, unroll_factor<algorithm_tags::unary_reduction, V>::value, true>;
+			const N head = alignment_head<sizeof(V)>(first, n);
+			for(N i = 0; i < head; ++i)
+				op(first[i]);
+			return head + kernel::reduce(first + head, n - head, op);
+		}
+
+		template <typename T, typename N, typename Op>
+		inline
+		N unary_reduction_dispatch(const T*, N, Op&, simd_tag<0>) {
+			return N(0);
+		}
+
+		template <typename T, typename N, typename Op>
+		inline
+		N unary_reduction_dispatch(const T* first, N n, Op& op, simd_tag<1>) {
+			if(use_avx2())
+				return unary_reduction_avx2(first, n, op);
+			return N(0);
+		}
+
+		template <typename T, typename N, typename Op>
+		inline
+		N unary_reduction_dispatch(const T* first, N n, Op& op, simd_tag<2>) {
+			if(use_avx512())
+				return unary_reduction_avx512(first, n, op);
+			return unary_reduction_dispatch(first, n, op, simd_tag<1>());
+		}
+
+		//Widens each float vector to two double vectors so the accumulation stays in double
+		template <typename Op>
+		struct widening_reduction_op {
+			Op& op;
+
+			explicit widening_reduction_op(Op& op) : op(op) {}
+
+			inline
+			void operator()(float x) {
+				op(static_cast<double>(x));
+			}
+			inline
+			void operator()(float4_t x) {
+				op(lower_double(x));
+				op(upper_double(x));
+			}
+			inline STD_DSP_TARGET_AVX2
+			void operator()(float8_t x) {
+				op(lower_double(x));
+				op(upper_double(x));
+			}
+
+			inline STD_DSP_TARGET_AVX2
+			void init4() {
+				op.init4();
+			}
+			inline STD_DSP_TARGET_AVX2
+			void fold4() {
+				op.fold4();
+			}
+		};
+	}
+
 	template <typename N, typename Op>
 	inline
 	double unary_reduction(const double* first, N n, Op op) {
-		if(is_odd_aligned(first)) {
+		using wide_tag = detail::simd_tag_for<true,
+			detail::is_vector_op<Op(double4_t)>::value,
+			detail::is_vector_op<Op(double8_t)>::value>;
+		const N wide_n = detail::unary_reduction_dispatch(first, n, op, wide_tag());
+		first += wide_n;
+		n -= wide_n;
+
+		const N vector_n = detail::unary_reduction_sse(first, n, op);
+		first += vector_n;
+		n -= vector_n;
+
+		while(n) {
+			--n;
 			op(*first);
 			++first;
-			--n;
 		}
 
-		std::pair<std::size_t, std::size_t> partitions = unroll_partition_8(n);
-		while(partitions.first) {
-			double2_t x0 = load2(first, 0);
-			double2_t x1 = load2(first, 2);
-			double2_t x2 = load2(first, 4);
-			double2_t x3 = load2(first, 6);
-
-			first += 8;
-			partitions.first -= 8;
-
-			op(x0);
-			op(x1);
-			op(x2);
-			op(x3);
-		}
+		return op.get();
+	}
 
-		while(partitions.second) {
-			--partitions.second;
-			op(*first);
+	//Floats are reduced in double precision through the double vector operators
+	template <typename N, typename Op>
+	inline
+	double unary_reduction(const float* first, N n, Op op) {
+		using wide_tag = detail::simd_tag_for<true,
+			detail::is_vector_op<Op(double4_t)>::value, false>;
+		detail::widening_reduction_op<Op> widening_op(op);
+		const N wide_n = detail::unary_reduction_dispatch(first, n, widening_op, wide_tag());
+		first += wide_n;
+		n -= wide_n;
+
+		const N vector_n = detail::unary_reduction_sse(first, n, widening_op);
+		first += vector_n;
+		n -= vector_n;
+
+		while(n) {
+			--n;
+			op(static_cast<double>(*first));
 			++first;
 		}
 
 		return op.get();
 	}
 
-	template <typename N>
+	template <typename T, typename N>
 	inline
-	double min_value(const double* first, N n) {
+	double min_value(const T* first, N n) {
 		assert(n > 0);
         reduction_functors::min_value_op op;
 		op.init(*first);
@@ -51,9 +167,9 @@ namespace std_dsp {
 		return unary_reduction(first, n, op);
 	}
 
-	template <typename N>
+	template <typename T, typename N>
 	inline
-	double max_value(const double* first, N n) {
+	double max_value(const T* first, N n) {
 		assert(n > 0);
 		reduction_functors::max_value_op op;
 		op.init(*first);
@@ -61,9 +177,9 @@ namespace std_dsp {
 		return unary_reduction(first, n, op);
 	}
 
-	template <typename N>
+	template <typename T, typename N>
 	inline
-	double min_abs_value(const double* first, N n) {
+	double min_abs_value(const T* first, N n) {
 		assert(n > 0);
         reduction_functors::min_value_op inner_op;
 		reduction_functors::abs_op<reduction_functors::min_value_op> op(inner_op);
@@ -72,9 +188,9 @@ namespace std_dsp {
 		return unary_reduction(first, n, op);
 	}
 
-	template <typename N>
+	template <typename T, typename N>
 	inline
-	double max_abs_value(const double* first, N n) {
+	double max_abs_value(const T* first, N n) {
 		assert(n > 0);
         reduction_functors::max_value_op inner_op;
 		reduction_functors::abs_op<reduction_functors::max_value_op> op(inner_op);
@@ -83,9 +199,9 @@ namespace std_dsp {
 		return unary_reduction(first, n, op);
 	}
 
-	template <typename N>
+	template <typename T, typename N>
 	inline
-	double sum(const double* first, N n) {
+	double sum(const T* first, N n) {
 		reduction_functors::sum_op op;
 		if(n == 0)
 			return 0.0;
@@ -94,9 +210,9 @@ namespace std_dsp {
 		return unary_reduction(first, n, op);
 	}
 
-	template <typename N>
+	template <typename T, typename N>
 	inline
-	double sum_of_squares(const double* first, N n) {
+	double sum_of_squares(const T* first, N n) {
         reduction_functors::sum_op inner_op;
 		reduction_functors::square_op<reduction_functors::sum_op> op(inner_op);
 		if(n == 0)
@@ -106,9 +222,9 @@ namespace std_dsp {
 		return unary_reduction(first, n, op);
 	}
 
-	template <typename N>
+	template <typename T, typename N>
 	inline
-	double product(const double* first, N n) {
+	double product(const T* first, N n) {
 		reduction_functors::product_op op;
 		if(n == 0)
 			return 1.0;
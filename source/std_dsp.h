@@ -5,7 +5,13 @@
 //Containers
 
 #include "containers/buffer.h"
-//#include "containers/delay_line.h"
+#include "containers/delay_line.h"
+#include "containers/spsc_ring_buffer.h"
+
+//Views
+
+#include "range/range.h"
+#include "range/view_algorithms.h"
 
 //Iterators
 #include "iterators/circular_iterator.h"
@@ -17,6 +23,19 @@
 #include "stateless_algorithms/mono.h"
 #include "stateless_algorithms/stereo.h"
 
+//Interpolation
+
+#include "interpolation/interpolation.h"
+
+//Filters
+
+#include "std_dsp_biquad_filter.h"
+#include "filters/biquad_design.h"
+
+//Effects
+
+#include "effects/fdn_reverb.h"
+
 //Stereo
 
 #include "stereo/interleave.h"
@@ -49,6 +49,7 @@
 #include <array>
 
 #include "../base/std_dsp_computational_basis.h"
+#include "../stateless_algorithms/mono/functors.h"
 
 namespace std_dsp {
 	namespace detail {
@@ -108,6 +109,12 @@ namespace std_dsp {
 						first2 += 8;
 						out += 16;
 					}
+				} else {
+					const N vector_n = unaligned_loop(first1, first2, n, out, are_pointers<I1, I2, O>());
+					first1 += vector_n;
+					first2 += vector_n;
+					out += 2 * vector_n;
+					n -= vector_n;
 				}
 
 				while(n) {
@@ -122,6 +129,94 @@ namespace std_dsp {
 					++out;
 				}		
 			}
+
+		private:
+			template <typename I1, typename I2, typename N, typename O>
+			static N unaligned_loop(I1, I2, N, O, std::false_type) {
+				return N(0);
+			}
+
+			//Pointers at mismatched offsets, processes the largest multiple of 4 frames
+			template <typename N>
+			static N unaligned_loop(const double* first1, const double* first2, N n, double* out, std::true_type) {
+				const N vector_n = n & ~N(3);
+				N remaining = vector_n;
+				while(remaining) {
+					remaining -= 4;
+
+					double2_t x1 = load2u(first1, 0);
+					double2_t x2 = load2u(first1, 2);
+					double2_t y1 = load2u(first2, 0);
+					double2_t y2 = load2u(first2, 2);
+
+					store2u(out, 0, interleave_lo(x1, y1));
+					store2u(out, 2, interleave_hi(x1, y1));
+					store2u(out, 4, interleave_lo(x2, y2));
+					store2u(out, 6, interleave_hi(x2, y2));
+
+					first1 += 4;
+					first2 += 4;
+					out += 8;
+				}
+				return vector_n;
+			}
+		};
+	}
+
+	namespace detail {
+		template <>
+		struct interleave_op<float> {
+			template <typename I1, typename I2, typename N, typename O>
+			void operator()(I1 first1, I2 first2, N n, O out) {
+				const N vector_n = vector_loop(first1, first2, n, out, are_pointers<I1, I2, O>());
+				first1 += vector_n;
+				first2 += vector_n;
+				out += 2 * vector_n;
+				n -= vector_n;
+
+				while(n) {
+					--n;
+			
+					*out = *first1;
+					++first1;
+					++out;
+
+					*out = *first2;
+					++first2;
+					++out;
+				}
+			}
+
+		private:
+			template <typename I1, typename I2, typename N, typename O>
+			static N vector_loop(I1, I2, N, O, std::false_type) {
+				return N(0);
+			}
+
+			//Unaligned loads and stores, processes the largest multiple of 8 frames
+			template <typename N>
+			static N vector_loop(const float* first1, const float* first2, N n, float* out, std::true_type) {
+				const N vector_n = n & ~N(7);
+				N remaining = vector_n;
+				while(remaining) {
+					remaining -= 8;
+
+					float4_t x1 = load4u(first1, 0);
+					float4_t x2 = load4u(first1, 4);
+					float4_t y1 = load4u(first2, 0);
+					float4_t y2 = load4u(first2, 4);
+
+					store4u(out, 0, interleave_lo(x1, y1));
+					store4u(out, 4, interleave_hi(x1, y1));
+					store4u(out, 8, interleave_lo(x2, y2));
+					store4u(out, 12, interleave_hi(x2, y2));
+
+					first1 += 8;
+					first2 += 8;
+					out += 16;
+				}
+				return vector_n;
+			}
 		};
 	}
 
@@ -297,6 +392,12 @@ namespace std_dsp {
 						out1 += 8;
 						out2 += 8;
 					}
+				} else {
+					const N vector_n = unaligned_loop(first, n, out1, out2, are_pointers<I, O1, O2>());
+					first += 2 * vector_n;
+					out1 += vector_n;
+					out2 += vector_n;
+					n -= vector_n;
 				}
 
 				while(n) {
@@ -311,6 +412,94 @@ namespace std_dsp {
 					++out2;
 				}
 			}
+
+		private:
+			template <typename I, typename N, typename O1, typename O2>
+			static N unaligned_loop(I, N, O1, O2, std::false_type) {
+				return N(0);
+			}
+
+			//Pointers at mismatched offsets, processes the largest multiple of 4 frames
+			template <typename N>
+			static N unaligned_loop(const double* first, N n, double* out1, double* out2, std::true_type) {
+				const N vector_n = n & ~N(3);
+				N remaining = vector_n;
+				while(remaining) {
+					remaining -= 4;
+
+					double2_t x1 = load2u(first, 0);
+					double2_t x2 = load2u(first, 2);
+					double2_t x3 = load2u(first, 4);
+					double2_t x4 = load2u(first, 6);
+
+					store2u(out1, 0, interleave_lo(x1, x2));
+					store2u(out1, 2, interleave_lo(x3, x4));
+					store2u(out2, 0, interleave_hi(x1, x2));
+					store2u(out2, 2, interleave_hi(x3, x4));
+
+					first += 8;
+					out1 += 4;
+					out2 += 4;
+				}
+				return vector_n;
+			}
+		};
+	}
+
+	namespace detail {
+		template <>
+		struct deinterleave_op<float> {
+			template <typename I, typename N, typename O1, typename O2>
+			void operator()(I first, N n, O1 out1, O2 out2) {
+				const N vector_n = vector_loop(first, n, out1, out2, are_pointers<I, O1, O2>());
+				first += 2 * vector_n;
+				out1 += vector_n;
+				out2 += vector_n;
+				n -= vector_n;
+
+				while(n) {
+					--n;
+
+					*out1 = *first;
+					++first;
+					++out1;
+
+					*out2 = *first;
+					++first;
+					++out2;
+				}
+			}
+
+		private:
+			template <typename I, typename N, typename O1, typename O2>
+			static N vector_loop(I, N, O1, O2, std::false_type) {
+				return N(0);
+			}
+
+			//Unaligned loads and stores, processes the largest multiple of 8 frames
+			template <typename N>
+			static N vector_loop(const float* first, N n, float* out1, float* out2, std::true_type) {
+				const N vector_n = n & ~N(7);
+				N remaining = vector_n;
+				while(remaining) {
+					remaining -= 8;
+
+					float4_t x1 = load4u(first, 0);
+					float4_t x2 = load4u(first, 4);
+					float4_t x3 = load4u(first, 8);
+					float4_t x4 = load4u(first, 12);
+
+					store4u(out1, 0, even_lanes(x1, x2));
+					store4u(out1, 4, even_lanes(x3, x4));
+					store4u(out2, 0, odd_lanes(x1, x2));
+					store4u(out2, 4, odd_lanes(x3, x4));
+
+					first += 16;
+					out1 += 8;
+					out2 += 8;
+				}
+				return vector_n;
+			}
 		};
 	}
 
@@ -9,8 +9,60 @@
 #include <array>
 
 #include "../base/std_dsp_computational_basis.h"
+#include "../base/std_dsp_simd_kernel.h"
+#include "../stateless_algorithms/mono/functors.h"
 
 namespace std_dsp {
+	namespace detail {
+		//Peels frames to the alignment of out1, then accesses memory aligned when all four sequences
+		//share it and unaligned otherwise. Returns the number of frames processed.
+		template <typename T, typename N, typename Op>
+		inline
+		N stereo_transform_sse(const T* first1, const T* first2, N n, T* out1, T* out2, Op& op) {
+			using V = typename vector_types<T>::sse;
+			using aligned_kernel = simd_kernel<V, unroll_factor<algorithm_tags::stereo_transform, V>::value, true>;
+			using unaligned_kernel = simd_kernel<V, unroll_factor<algorithm_tags::stereo_transform, V>::value, false>;
+			const N head = alignment_head<sizeof(V)>(out1, n);
+			for (N i = 0; i < head; ++i) {
+				auto result = op(std::make_pair(first1[i], first2[i]));
+				out1[i] = static_cast<T>(result.first);
+				out2[i] = static_cast<T>(result.second);
+			}
+
+			first1 += head;
+			first2 += head;
+			out1 += head;
+			out2 += head;
+			if (is_aligned_to<sizeof(V)>(first1) && is_aligned_to<sizeof(V)>(first2) && is_aligned_to<sizeof(V)>(out2))
+				return head + aligned_kernel::transform_pair(first1, first2, n - head, out1, out2, op);
+			return head + unaligned_kernel::transform_pair(first1, first2, n - head, out1, out2, op);
+		}
+
+		//Interleaved frames, peels whole frames to the alignment of out when that reaches it.
+		//Returns the number of frames processed.
+		template <typename T, typename N, typename Op>
+		inline
+		N stereo_transform_interleaved_sse(const T* first, N n, T* out, Op& op) {
+			using V = typename vector_types<T>::sse;
+			using aligned_kernel = simd_kernel<V, unroll_factor<algorithm_tags::stereo_transform, V>::value, true>;
+			using unaligned_kernel = simd_kernel<V, unroll_factor<algorithm_tags::stereo_transform, V>::value, false>;
+			N head = alignment_head<sizeof(V)>(out, 2 * n) / 2;
+			if (!is_aligned_to<sizeof(V)>(out + 2 * head))
+				head = 0;
+			for (N i = 0; i < head; ++i) {
+				auto result = op(std::make_pair(first[2 * i], first[2 * i + 1]));
+				out[2 * i] = static_cast<T>(result.first);
+				out[2 * i + 1] = static_cast<T>(result.second);
+			}
+
+			first += 2 * head;
+			out += 2 * head;
+			if (is_aligned_to<sizeof(V)>(first) && is_aligned_to<sizeof(V)>(out))
+				return head + aligned_kernel::transform(first, 2 * (n - head), out, op) / 2;
+			return head + unaligned_kernel::transform(first, 2 * (n - head), out, op) / 2;
+		}
+	}
+
 	template <typename T>
 	struct stereo_transform_kernel {
 		template <typename I1, typename I2, typename N, typename O1, typename O2, typename Op>
@@ -41,40 +93,64 @@ namespace std_dsp {
 		void operator()(I1 first1, I2 first2, N n, O1 out1, O2 out2, Op op) {
 			assert(n >= 0);
 
-			if (!is_odd_aligned(first1) && !is_odd_aligned(first2) && !is_odd_aligned(out1) && !is_odd_aligned(out2)) {
-				while (n >= N(8)) {
-					n -= N(8);
-
-					double2_t x1 = load2(first1, 0);
-					double2_t x2 = load2(first1, 2);
-					double2_t x3 = load2(first1, 4);
-					double2_t x4 = load2(first1, 6);
-					double2_t y1 = load2(first2, 0);
-					double2_t y2 = load2(first2, 2);
-					double2_t y3 = load2(first2, 4);
-					double2_t y4 = load2(first2, 6);
-
-					first1 += 8;
-					first2 += 8;
-
-					std::pair<double2_t, double2_t> r1 = op(std::make_pair(x1, y1));
-					std::pair<double2_t, double2_t> r2 = op(std::make_pair(x2, y2));
-					std::pair<double2_t, double2_t> r3 = op(std::make_pair(x3, y3));
-					std::pair<double2_t, double2_t> r4 = op(std::make_pair(x4, y4));
-
-					store2(out1, 0, r1.first);
-					store2(out1, 2, r2.first);
-					store2(out1, 4, r3.first);
-					store2(out1, 6, r4.first);
-					store2(out2, 0, r1.second);
-					store2(out2, 2, r2.second);
-					store2(out2, 4, r3.second);
-					store2(out2, 6, r4.second);
-
-					out1 += 8;
-					out2 += 8;
-				}
+			const N vector_n = vector_loop(first1, first2, n, out1, out2, op,
+				std::integral_constant<bool, detail::are_pointers<I1, I2, O1, O2>::value>());
+			first1 += vector_n;
+			first2 += vector_n;
+			out1 += vector_n;
+			out2 += vector_n;
+			n -= vector_n;
+
+			while (n) {
+				--n;
+
+				auto result = op(std::make_pair(*first1, *first2));
+
+				++first1;
+				++first2;
+
+				*out1 = result.first;
+				*out2 = result.second;
+
+				++out1;
+				++out2;
 			}
+		}
+
+	private:
+		template <typename N, typename Op>
+		inline
+		static N vector_loop(const double* first1, const double* first2, N n, double* out1, double* out2, Op& op, std::true_type) {
+			return detail::stereo_transform_sse(first1, first2, n, out1, out2, op);
+		}
+
+		//Other iterators access memory through their own load2/store2, which are aligned
+		template <typename I1, typename I2, typename N, typename O1, typename O2, typename Op>
+		inline
+		static N vector_loop(I1 first1, I2 first2, N n, O1 out1, O2 out2, Op& op, std::false_type) {
+			if (is_odd_aligned(first1) || is_odd_aligned(first2) || is_odd_aligned(out1) || is_odd_aligned(out2))
+				return N(0);
+
+			using kernel = simd_kernel<double2_t, unroll_factor<algorithm_tags::stereo_transform, double2_t>::value, true>;
+			return kernel::transform_pair(first1, first2, n, out1, out2, op);
+		}
+	};
+
+	template <>
+	struct stereo_transform_kernel<float> {
+		template <typename I1, typename I2, typename N, typename O1, typename O2, typename Op>
+		inline
+		void operator()(I1 first1, I2 first2, N n, O1 out1, O2 out2, Op op) {
+			assert(n >= 0);
+
+			using vector_tag = std::integral_constant<bool, detail::are_pointers<I1, I2, O1, O2>::value &&
+				detail::is_vector_op<Op(std::pair<float4_t, float4_t>)>::value>;
+			const N vector_n = vector_loop(first1, first2, n, out1, out2, op, vector_tag());
+			first1 += vector_n;
+			first2 += vector_n;
+			out1 += vector_n;
+			out2 += vector_n;
+			n -= vector_n;
 
 			while (n) {
 				--n;
@@ -91,6 +167,19 @@ namespace std_dsp {
 				++out2;
 			}
 		}
+
+	private:
+		template <typename I1, typename I2, typename N, typename O1, typename O2, typename Op>
+		inline
+		static N vector_loop(I1, I2, N, O1, O2, Op&, std::false_type) {
+			return N(0);
+		}
+
+		template <typename N, typename Op>
+		inline
+		static N vector_loop(const float* first1, const float* first2, N n, float* out1, float* out2, Op& op, std::true_type) {
+			return detail::stereo_transform_sse(first1, first2, n, out1, out2, op);
+		}
 	};
 
 	template <typename T>
@@ -122,40 +211,61 @@ namespace std_dsp {
 		inline
 		void operator()(I first, N n, O out, Op op) {
 
-			while (n >= 8) {
-				n -= 8;
-
-				double2_t x1 = load2(first, 0);
-				double2_t x2 = load2(first, 2);
-				double2_t x3 = load2(first, 4);
-				double2_t x4 = load2(first, 6);
-				double2_t x5 = load2(first, 8);
-				double2_t x6 = load2(first, 10);
-				double2_t x7 = load2(first, 12);
-				double2_t x8 = load2(first, 14);
-
-				first += 16;
-
-				x1 = op(x1);
-				x2 = op(x2);
-				x3 = op(x3);
-				x4 = op(x4);
-				x5 = op(x5);
-				x6 = op(x6);
-				x7 = op(x7);
-				x8 = op(x8);
-
-				store2(out, 0, x1);
-				store2(out, 2, x2);
-				store2(out, 4, x3);
-				store2(out, 6, x4);
-				store2(out, 8, x5);
-				store2(out, 10, x6);
-				store2(out, 12, x7);
-				store2(out, 14, x8);
-
-				out += 16;
+			const N vector_n = vector_loop(first, n, out, op,
+				std::integral_constant<bool, detail::are_pointers<I, O>::value>());
+			first += 2 * vector_n;
+			out += 2 * vector_n;
+			n -= vector_n;
+
+			while (n) {
+				--n;
+
+				auto x1 = *first;
+				++first;
+				auto x2 = *first;
+				++first;
+
+				auto result = op(std::make_pair(x1, x2));
+
+				*out = result.first;
+				++out;
+				*out = result.second;
+				++out;
 			}
+		}
+
+	private:
+		//Each double2_t holds one whole frame
+		template <typename N, typename Op>
+		inline
+		static N vector_loop(const double* first, N n, double* out, Op& op, std::true_type) {
+			return detail::stereo_transform_interleaved_sse(first, n, out, op);
+		}
+
+		//Other iterators access memory through their own load2/store2, which are aligned
+		template <typename I, typename N, typename O, typename Op>
+		inline
+		static N vector_loop(I first, N n, O out, Op& op, std::false_type) {
+			if (!check_alignment(first, out) || is_odd_aligned(first))
+				return N(0);
+
+			using kernel = simd_kernel<double2_t, unroll_factor<algorithm_tags::stereo_transform, double2_t>::value, true>;
+			return kernel::transform(first, 2 * n, out, op) / 2;
+		}
+	};
+
+	//A float4_t holds two interleaved frames [l0, r0, l1, r1]
+	template <>
+	struct stereo_transform_interleaved_kernel<float> {
+		template <typename I, typename N, typename O, typename Op>
+		inline
+		void operator()(I first, N n, O out, Op op) {
+			using vector_tag = std::integral_constant<bool, detail::are_pointers<I, O>::value &&
+				detail::is_vector_op<Op(float4_t)>::value>;
+			const N vector_n = vector_loop(first, n, out, op, vector_tag());
+			first += 2 * vector_n;
+			out += 2 * vector_n;
+			n -= vector_n;
 
 			while (n) {
 				--n;
@@ -173,6 +283,19 @@ namespace std_dsp {
 				++out;
 			}
 		}
+
+	private:
+		template <typename I, typename N, typename O, typename Op>
+		inline
+		static N vector_loop(I, N, O, Op&, std::false_type) {
+			return N(0);
+		}
+
+		template <typename N, typename Op>
+		inline
+		static N vector_loop(const float* first, N n, float* out, Op& op, std::true_type) {
+			return detail::stereo_transform_interleaved_sse(first, n, out, op);
+		}
 	};
 
 	template <typename I1, typename I2, typename N, typename O1, typename O2, typename Op>
@@ -247,6 +370,10 @@ namespace std_dsp {
 		double2_t operator()(double2_t x) {
 			return rotate(x);
 		}
+		inline
+		float4_t operator()(float4_t x) {
+			return rotate(x);
+		}
 	};
 	struct duplicate_left_op {
 		template <typename T>
@@ -258,6 +385,10 @@ namespace std_dsp {
 		double2_t operator()(double2_t x) {
 			return interleave_lo(x, x);
 		}
+		inline
+		float4_t operator()(float4_t x) {
+			return duplicate_even(x);
+		}
 	};
 	struct duplicate_right_op {
 		template <typename T>
@@ -269,6 +400,10 @@ namespace std_dsp {
 		double2_t operator()(double2_t x) {
 			return interleave_hi(x, x);
 		}
+		inline
+		float4_t operator()(float4_t x) {
+			return duplicate_odd(x);
+		}
 	};
 
 	// - Floating point operators -
@@ -298,6 +433,15 @@ namespace std_dsp {
 			const double2_t y = multiply(half, add(x, xr));
 			return y;
 		}
+		inline
+		std::pair<float4_t, float4_t> operator()(std::pair<float4_t, float4_t> x) {
+			const float4_t y = multiply(load4f(0.5f), add(x.first, x.second));
+			return std::make_pair(y, y);
+		}
+		inline
+		float4_t operator()(float4_t x) {
+			return multiply(load4f(0.5f), add(x, rotate(x)));
+		}
 	};
 	struct mid_side_op {
 		inline
@@ -320,8 +464,21 @@ namespace std_dsp {
 		}
 		inline
 		double2_t operator()(double2_t x) {
-			return rotate(add_hi_sub_lo(x, x));
-		}		
+			return rotate(add_hi_sub_lo(x, rotate(x)));
+		}
+		inline
+		std::pair<float4_t, float4_t> operator()(const std::pair<float4_t, float4_t>& x) {
+			const float4_t m = add(x.first, x.second);
+			const float4_t s = subtract(x.first, x.second);
+			return std::make_pair(m, s);
+		}
+		inline
+		float4_t operator()(float4_t x) {
+			const float4_t xr = rotate(x);
+			const float4_t m = add(x, xr);
+			const float4_t s = subtract(x, xr);
+			return interleave_lo(even_lanes(m, m), even_lanes(s, s));
+		}
 	};
 	struct mid_side_inv_op {
 		inline
@@ -346,8 +503,22 @@ namespace std_dsp {
 		inline
 		double2_t operator()(double2_t x) {
 			static const double2_t half = load2(0.5);
-			return multiply(half, rotate(add_hi_sub_lo(x, x)));
-		}		
+			return multiply(half, rotate(add_hi_sub_lo(x, rotate(x))));
+		}
+		inline
+		std::pair<float4_t, float4_t> operator()(const std::pair<float4_t, float4_t>& x) {
+			const float4_t half = load4f(0.5f);
+			const float4_t m = add(x.first, x.second);
+			const float4_t s = subtract(x.first, x.second);
+			return std::make_pair(multiply(half, m), multiply(half, s));
+		}
+		inline
+		float4_t operator()(float4_t x) {
+			const float4_t xr = rotate(x);
+			const float4_t m = add(x, xr);
+			const float4_t s = subtract(x, xr);
+			return multiply(load4f(0.5f), interleave_lo(even_lanes(m, m), even_lanes(s, s)));
+		}
 	};
 	struct phase_invert_left_op {
 		inline
@@ -0,0 +1,86 @@
+//Unit tests for the denormal flush guard and the undenormalize policy
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <limits>
+
+#include "../../base/std_dsp_denormals.h"
+#include "../../containers/buffer.h"
+#include "../../std_dsp_biquad_filter.h"
+
+namespace {
+	struct policy_scope {
+		policy_scope(std_dsp::undenormalize_policy policy) { std_dsp::set_undenormalize_policy(policy); }
+		~policy_scope() { std_dsp::set_undenormalize_policy(std_dsp::undenormalize_policy::always); }
+	};
+}
+
+TEST(DenormalsTest, ScopedFlush) {
+
+	const double smallest = std::numeric_limits<double>::min();
+	volatile double tiny = smallest / 16.0;
+	volatile double half = 0.5;
+	const unsigned int before = _mm_getcsr();
+
+	EXPECT_FALSE(std_dsp::denormals_flushed());
+	EXPECT_NE(0.0, tiny * half);
+	{
+		std_dsp::scoped_denormal_flush guard;
+		EXPECT_TRUE(std_dsp::denormals_flushed());
+		//DAZ reads the denormal as zero
+		EXPECT_EQ(0.0, tiny * half);
+		//FTZ writes zero for a result below the normal range
+		volatile double x = smallest;
+		EXPECT_EQ(0.0, x * half);
+
+		{
+			std_dsp::scoped_denormal_flush nested;
+			EXPECT_TRUE(std_dsp::denormals_flushed());
+		}
+		EXPECT_TRUE(std_dsp::denormals_flushed());
+	}
+	EXPECT_FALSE(std_dsp::denormals_flushed());
+	EXPECT_EQ(before & ~0x3Fu, _mm_getcsr() & ~0x3Fu);
+}
+
+TEST(DenormalsTest, Policy) {
+
+	EXPECT_EQ(std_dsp::undenormalize_policy::always, std_dsp::active_undenormalize_policy());
+
+	std_dsp::buffer_t<std_dsp::dynamic_storage<2>> b(8);
+	std_dsp::biquad_state<1> s;
+
+	//The software passes run by default, guard or not
+	{
+		std_dsp::scoped_denormal_flush guard;
+		b.fill(1.e-20);
+		b.undenormalize();
+		EXPECT_EQ(0.0, b[0][3]);
+
+		s.w1[0] = 1.e-20;
+		s.w2[0] = 1.e-20;
+		s.undenormalize();
+		EXPECT_EQ(0.0, s.w1[0]);
+	}
+
+	policy_scope scope(std_dsp::undenormalize_policy::unless_flushed);
+
+	//Without the hardware flush they still run
+	EXPECT_TRUE(std_dsp::undenormalize_needed());
+	b.fill(1.e-20);
+	b.undenormalize();
+	EXPECT_EQ(0.0, b[1][5]);
+
+	//With it they are skipped
+	std_dsp::scoped_denormal_flush guard;
+	EXPECT_FALSE(std_dsp::undenormalize_needed());
+	b.fill(1.e-20);
+	b.undenormalize();
+	EXPECT_EQ(1.e-20, b[1][5]);
+
+	s.w1[0] = 1.e-20;
+	s.w2[0] = 1.e-20;
+	s.undenormalize();
+	EXPECT_EQ(1.e-20, s.w1[0]);
+}
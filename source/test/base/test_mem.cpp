@@ -19,6 +19,9 @@ void test_storage(S& s) {
 	EXPECT_EQ(0, std_dsp::get_alignment(s.begin(0)));
 	EXPECT_EQ(0, std_dsp::get_alignment(s.begin(1)));
 
+	for (std_dsp::integer_t i = 0; i < CHANNELS; ++i)
+		EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(s.begin(i)) % std_dsp::cache_line_size);
+
 	//Check size
 
 	EXPECT_EQ(CHANNELS * SIZE, std::distance(s.begin(), s.end()));
@@ -31,10 +34,9 @@ void test_storage(S& s) {
 
 	//Check physical size
 
-	if ((SIZE & 1) == 0)
-		EXPECT_EQ(CHANNELS * SIZE, s.physical_size());
-	else
-		EXPECT_EQ(CHANNELS * (1+SIZE), s.physical_size());
+	EXPECT_LE(SIZE, s.stride());
+	EXPECT_EQ(0, s.stride() % 8);
+	EXPECT_EQ(CHANNELS * s.stride(), s.physical_size());
 
 	//Write split
 
@@ -121,3 +123,78 @@ TEST(StorageTest, DynamicStorageTest) {
 	}
 
 }
+
+TEST(StorageTest, StridePolicies) {
+
+	//Legacy packing pads odd sizes to even only
+
+	EXPECT_EQ(256, std_dsp::even_stride::stride(255));
+	EXPECT_EQ(256, std_dsp::even_stride::stride(256));
+	EXPECT_EQ(256, (std_dsp::even_stride::fixed<255>::value));
+
+	{
+		std_dsp::static_storage<3, 255, std_dsp::even_stride> s;
+		EXPECT_EQ(3 * 256, s.physical_size());
+		EXPECT_EQ(256, std::distance(s.begin(0), s.begin(1)));
+	}
+
+	//Cache line rounding
+
+	EXPECT_EQ(0, std_dsp::cache_line_stride::stride(0));
+	EXPECT_EQ(8, std_dsp::cache_line_stride::stride(1));
+	EXPECT_EQ(256, std_dsp::cache_line_stride::stride(255));
+	EXPECT_EQ(1024, std_dsp::cache_line_stride::stride(1024));
+	EXPECT_EQ(1032, (std_dsp::cache_line_stride::fixed<1025>::value));
+
+	//Strides that are multiples of 1 KiB get an extra cache line
+
+	EXPECT_EQ(0, std_dsp::anti_aliasing_stride::stride(0));
+	EXPECT_EQ(120, std_dsp::anti_aliasing_stride::stride(120));
+	EXPECT_EQ(136, std_dsp::anti_aliasing_stride::stride(128));
+	EXPECT_EQ(1032, std_dsp::anti_aliasing_stride::stride(1024));
+	EXPECT_EQ(1032, std_dsp::anti_aliasing_stride::stride(1020));
+	EXPECT_EQ(1032, (std_dsp::anti_aliasing_stride::fixed<1024>::value));
+
+	//The default rounds to cache lines only, the extra line is opt in
+
+	{
+		std_dsp::dynamic_storage<2> s(1024);
+		EXPECT_EQ(1024, std::distance(s.begin(0), s.begin(1)));
+		test_storage<2, 1024>(s);
+	}
+
+	{
+		std_dsp::dynamic_storage<2, std_dsp::anti_aliasing_stride> s(1024);
+		EXPECT_EQ(1032, std::distance(s.begin(0), s.begin(1)));
+		test_storage<2, 1024>(s);
+	}
+
+	{
+		std_dsp::static_storage<2, 1024, std_dsp::anti_aliasing_stride> s;
+		EXPECT_EQ(2 * 1032, s.physical_size());
+		test_storage<2, 1024>(s);
+	}
+}
+
+TEST(StorageTest, DynamicStorageCopy) {
+
+	std_dsp::dynamic_storage<2> a(100);
+	std::fill(a.begin(0), a.end(0), 1.0);
+	std::fill(a.begin(1), a.end(1), 2.0);
+
+	std_dsp::dynamic_storage<2> b(a);
+	EXPECT_TRUE(std_dsp::compare(b.begin(1), 2.0, 100));
+
+	std_dsp::dynamic_storage<2> c(10);
+	c = a;
+	EXPECT_EQ(100, c.size());
+	EXPECT_TRUE(std_dsp::compare(c.begin(0), 1.0, 100));
+	EXPECT_TRUE(std_dsp::compare(c.begin(1), 2.0, 100));
+
+	std_dsp::dynamic_storage<> d(3, 50);
+	std::fill(d.begin(2), d.end(2), 3.0);
+	std_dsp::dynamic_storage<> e;
+	e = d;
+	EXPECT_EQ(3, e.channels());
+	EXPECT_TRUE(std_dsp::compare(e.begin(2), 3.0, 50));
+}
@@ -0,0 +1,235 @@
+
+//Unit tests for the delay line
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "../test_signals.h"
+
+#include "../../containers/delay_line.h"
+
+namespace {
+	//Reference: the sample written t samples ago, with zeros before the start
+	double written(std::int64_t t, std::int64_t channel) {
+		return t < 0 ? 0.0 : static_cast<double>(t) + 10000.0 * channel;
+	}
+}
+
+TEST(DelayLineTest, Spans) {
+
+	std_dsp::delay_line<1> d(16);
+	d.rotate(12);
+
+	auto w = d.write_spans(0, 6);
+	EXPECT_EQ(4, w.n1);
+	EXPECT_EQ(2, w.n2);
+	EXPECT_TRUE(w.wraps());
+
+	auto r = d.read_spans(0, 3, 3);
+	EXPECT_EQ(3, r.n1);
+	EXPECT_EQ(0, r.n2);
+	EXPECT_FALSE(r.wraps());
+
+	r = d.read_spans(0, 14, 5);
+	EXPECT_EQ(5, r.size());
+	EXPECT_EQ(d.write_spans(0, 1).first1 - 14 + 16, r.first1);
+}
+
+template <typename D>
+void test_block_delay(D& d, std::int64_t block) {
+	const std::int64_t delays[] = { 0, 1, 36, 37, 100, 199 };
+
+	std::vector<double> in(block), out(block);
+	std::int64_t t = 0;
+	for(int b = 0; b < 40; ++b) {
+		for(std::int64_t c = 0; c < 2; ++c) {
+			for(std::int64_t i = 0; i < block; ++i)
+				in[i] = written(t + i, c);
+			d.write(c, in.data(), block);
+		}
+
+		//With the block written, a delay of k reads back what was written k samples before it
+		for(std::int64_t delay : delays) {
+			for(std::int64_t c = 0; c < 2; ++c) {
+				d.read(c, delay, block, out.data());
+				for(std::int64_t i = 0; i < block; ++i)
+					ASSERT_EQ(written(t + i - delay, c), out[i]) << "block " << b << " delay " << delay;
+				ASSERT_EQ(written(t - delay, c), d.tap(c, delay));
+			}
+		}
+
+		d.rotate(block);
+		t += block;
+	}
+}
+
+TEST(DelayLineTest, BlockDelay) {
+
+	const std::int64_t block = 37;
+	std_dsp::delay_line<2> d(std_dsp::minimum_buffer_size(199, block));
+	EXPECT_EQ(std_dsp::minimum_buffer_size(199, block), d.size());
+	test_block_delay(d, block);
+}
+
+TEST(DelayLineTest, MaskedBlockDelay) {
+
+	const std::int64_t block = 37;
+	std_dsp::masked_delay_line<2> d(std_dsp::minimum_buffer_size(199, block));
+	EXPECT_EQ(256, d.size());
+	test_block_delay(d, block);
+
+	std_dsp::static_masked_delay_line<2, 256> s;
+	test_block_delay(s, block);
+}
+
+TEST(DelayLineTest, MirroredBlockDelay) {
+
+	const std::int64_t block = 37;
+	std_dsp::mirrored_delay_line<2> d(std_dsp::minimum_buffer_size(199, block));
+	EXPECT_EQ(0, d.size() % 512);
+	test_block_delay(d, block);
+
+	//Blocks over the wrap point are a single span
+	d.rotate(d.size() - d.get_write_head() - 3);
+	EXPECT_FALSE(d.write_spans(0, 10).wraps());
+	EXPECT_FALSE(d.read_spans(1, 5, 10).wraps());
+}
+
+//The longest delay, size() - 1, reaches the oldest sample the buffer still holds
+template <typename D>
+void test_longest_delay(D& d) {
+	const std::int64_t size = d.size();
+	std::vector<double> out(size);
+	for(std::int64_t t = 0; t < 3 * size; ++t) {
+		const double x = written(t, 0);
+		d.write(0, &x, 1);
+
+		ASSERT_EQ(written(t - (size - 1), 0), d.tap(0, size - 1)) << "time " << t;
+		d.read(0, size - 1, size, out.data());
+		for(std::int64_t i = 0; i < size; ++i)
+			ASSERT_EQ(written(t - (size - 1) + i, 0), out[i]) << "time " << t;
+
+		d.rotate(1);
+	}
+}
+
+TEST(DelayLineTest, LongestDelay) {
+
+	std_dsp::delay_line<1> d(std_dsp::minimum_buffer_size(20, 1));
+	EXPECT_EQ(22, d.size());
+	test_longest_delay(d);
+
+	std_dsp::masked_delay_line<1> m(std_dsp::minimum_buffer_size(20, 1));
+	test_longest_delay(m);
+}
+
+template <typename D>
+void test_taps(D& d) {
+	const std::int64_t block = 300;
+	const std_dsp::delay_tap taps[] = { { 0, 0.5 }, { 1, -1.0 }, { 17, 0.25 }, { 299, 2.0 }, { 300, 1.5 }, { 123, -0.75 }, { 400, 0.125 } };
+
+	std::vector<double> in(block), out(block), expected(block);
+	std::int64_t t = 0;
+	for(int b = 0; b < 6; ++b) {
+		for(std::int64_t i = 0; i < block; ++i)
+			in[i] = written(t + i, 0);
+		d.write(0, in.data(), block);
+
+		//Every tap count, even and odd, against one read per tap
+		for(std::int64_t count = 0; count <= 7; ++count) {
+			std::fill(out.begin(), out.end(), 1.0);
+			std::fill(expected.begin(), expected.end(), 1.0);
+			d.read_taps_add(0, taps, count, block, out.data());
+			for(std::int64_t k = 0; k < count; ++k)
+				d.read_add(0, taps[k].delay, block, expected.data(), taps[k].gain);
+			for(std::int64_t i = 0; i < block; ++i)
+				ASSERT_DOUBLE_EQ(expected[i], out[i]) << "block " << b << " taps " << count;
+		}
+
+		d.rotate(block);
+		t += block;
+	}
+}
+
+TEST(DelayLineTest, MultiTap) {
+
+	std_dsp::delay_line<1> d(std_dsp::minimum_buffer_size(400, 300));
+	test_taps(d);
+
+	std_dsp::masked_delay_line<1> m(std_dsp::minimum_buffer_size(400, 300));
+	test_taps(m);
+
+	std_dsp::mirrored_delay_line<1> r(std_dsp::minimum_buffer_size(400, 300));
+	test_taps(r);
+}
+
+TEST(DelayLineTest, MaskedIterator) {
+
+	double x[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+	auto it = std_dsp::make_masked_circular_iterator(x, 6, 8);
+
+	EXPECT_EQ(6.0, *it);
+	EXPECT_EQ(7.0, it[1]);
+	EXPECT_EQ(0.0, it[2]);
+	EXPECT_EQ(5.0, it[-1]);
+	EXPECT_EQ(6.0, it[-16]);
+	EXPECT_EQ(1.0, *(it + 3));
+	EXPECT_EQ(3.0, *(it - 11));
+
+	auto jt = it;
+	++jt;
+	++jt;
+	EXPECT_EQ(0.0, *jt);
+	EXPECT_EQ(2, jt - it);
+	EXPECT_EQ(6, it - jt);
+	--jt;
+	--jt;
+	--jt;
+	EXPECT_EQ(5.0, *jt);
+	EXPECT_TRUE(make_delay_iterator(it, 1) == jt);
+
+	//The contiguous run ends at the end of the buffer
+	EXPECT_EQ(2, fast_count(it, 5));
+
+	//Algorithms run over the wrap point in contiguous pieces
+	double y[5];
+	std_dsp::copy(it, 5, y);
+	EXPECT_EQ(6.0, y[0]);
+	EXPECT_EQ(7.0, y[1]);
+	EXPECT_EQ(0.0, y[2]);
+	EXPECT_EQ(2.0, y[4]);
+}
+
+TEST(DelayLineTest, Transforms) {
+
+	std_dsp::static_delay_line<1, 64> d;
+	std::vector<double> in(40), dry(40), out(40);
+	for(int i = 0; i < 40; ++i) {
+		in[i] = i + 1.0;
+		dry[i] = 0.5;
+	}
+
+	d.rotate(50);
+	d.write_transform(0, in.data(), 40, std_dsp::transform_functors::multiply_op(2.0));
+	d.write_add(0, in.data(), 40, 1.0);
+	d.rotate(40);
+
+	//Wet plus dry through the binary kernels
+	d.read_binary_transform(0, 40, dry.data(), 40, out.data(), std_dsp::add_op());
+	for(int i = 0; i < 40; ++i)
+		EXPECT_EQ(3.0 * (i + 1.0) + 0.5, out[i]);
+
+	std::fill(out.begin(), out.end(), 1.0);
+	d.read_add(0, 40, 40, out.data(), -1.0);
+	EXPECT_EQ(1.0 - 3.0, out[0]);
+	EXPECT_EQ(1.0 - 3.0 * 40, out[39]);
+
+	//Iterators agree with the spans
+	auto it = d.begin(0, 40);
+	EXPECT_EQ(3.0, *it);
+	++it;
+	EXPECT_EQ(6.0, *it);
+}
@@ -0,0 +1,128 @@
+//Unit tests for the single producer, single consumer ring
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "../../containers/spsc_ring_buffer.h"
+
+TEST(SpscRingBufferTest, PushPop) {
+
+	std_dsp::spsc_ring<2> r(100);
+	EXPECT_EQ(100, r.capacity());
+	EXPECT_EQ(100, r.write_available());
+	EXPECT_EQ(0, r.read_available());
+
+	std::vector<double> l(70), rt(70), out_l(70), out_r(70);
+	const double* in[2] = { l.data(), rt.data() };
+	double* out[2] = { out_l.data(), out_r.data() };
+
+	//Three rounds move the positions over the end of the storage
+	double t = 0.0;
+	for(int round = 0; round < 3; ++round) {
+		for(int i = 0; i < 70; ++i) {
+			l[i] = t + i;
+			rt[i] = -(t + i);
+		}
+		EXPECT_EQ(70, r.push(in, 70));
+		EXPECT_EQ(30, r.write_available());
+		EXPECT_EQ(70, r.read_available());
+
+		EXPECT_EQ(70, r.pop(out, 80));
+		for(int i = 0; i < 70; ++i) {
+			ASSERT_EQ(t + i, out_l[i]);
+			ASSERT_EQ(-(t + i), out_r[i]);
+		}
+		t += 70.0;
+	}
+
+	//A full ring takes nothing more
+	std::vector<double> big(150, 1.0);
+	EXPECT_EQ(100, r.push(std::vector<const double*>(2, big.data()).data(), 150));
+	EXPECT_EQ(0, r.push(in, 1));
+	EXPECT_EQ(0, r.write_available());
+}
+
+TEST(SpscRingBufferTest, Spans) {
+
+	std_dsp::spsc_ring<1> r(15);
+	double x[10] = { 0 };
+	r.push(x, 10);
+	EXPECT_EQ(10, r.pop(x, 10));
+
+	//The next write starts 10 samples into 16 and wraps after 6
+	ASSERT_EQ(15, r.write_available());
+	auto w = r.write_spans(0, 9);
+	EXPECT_EQ(6, w.n1);
+	EXPECT_EQ(3, w.n2);
+	for(int i = 0; i < 6; ++i)
+		w.first1[i] = i;
+	for(int i = 0; i < 3; ++i)
+		w.first2[i] = 6 + i;
+
+	EXPECT_EQ(0, r.read_available());
+	r.commit_write(9);
+	ASSERT_EQ(9, r.read_available());
+	auto s = r.read_spans(0, 9);
+	EXPECT_EQ(6, s.n1);
+	EXPECT_EQ(8.0, s.first2[2]);
+	r.commit_read(9);
+	EXPECT_EQ(0, r.read_available());
+
+	//Mirrored rings never split
+	std_dsp::mirrored_spsc_ring<1> m(100);
+	EXPECT_GE(m.capacity(), 100);
+	std::vector<double> y(m.capacity(), 2.0);
+	m.push(y.data(), m.capacity() - 3);
+	m.pop(y.data(), m.capacity() - 3);
+	EXPECT_FALSE(m.write_spans(0, 10).wraps());
+}
+
+template <typename R>
+void test_threads(R& r) {
+	const std::int64_t total = 50000;
+	std::atomic<bool> failed(false);
+
+	std::thread consumer([&]() {
+		std::vector<double> out(97);
+		std::int64_t t = 0;
+		while(t < total) {
+			const std::int64_t n = r.pop(out.data(), 1 + t % 97);
+			if(n == 0)
+				std::this_thread::yield();
+			for(std::int64_t i = 0; i < n; ++i) {
+				if(out[i] != static_cast<double>(t + i))
+					failed = true;
+			}
+			t += n;
+		}
+	});
+
+	std::vector<double> in(61);
+	std::int64_t t = 0;
+	while(t < total) {
+		const std::int64_t n = (std::min)(total - t, 1 + t % 61);
+		for(std::int64_t i = 0; i < n; ++i)
+			in[i] = static_cast<double>(t + i);
+		const std::int64_t pushed = r.push(in.data(), n);
+		if(pushed == 0)
+			std::this_thread::yield();
+		t += pushed;
+	}
+
+	consumer.join();
+	EXPECT_FALSE(failed);
+}
+
+TEST(SpscRingBufferTest, Threads) {
+
+	std_dsp::spsc_ring<1> r(256);
+	test_threads(r);
+
+	std_dsp::mirrored_spsc_ring<1> m(256);
+	test_threads(m);
+}
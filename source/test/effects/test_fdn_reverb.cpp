@@ -0,0 +1,110 @@
+//Unit tests for the feedback delay network reverb
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "../../base/std_dsp_mem.h"
+#include "../../effects/fdn_reverb.h"
+
+namespace {
+	double energy(const std::vector<double>& x, std::size_t first, std::size_t last) {
+		double e = 0.0;
+		for(std::size_t i = first; i < last; ++i)
+			e += x[i] * x[i];
+		return e;
+	}
+
+	template <typename R>
+	void impulse_response(R& reverb, std::int64_t n, std::int64_t block, std::vector<double>& left, std::vector<double>& right) {
+		std::vector<double> in(n, 0.0);
+		in[0] = 1.0;
+		left.assign(n, 0.0);
+		right.assign(n, 0.0);
+		for(std::int64_t i = 0; i < n; i += block) {
+			const std::int64_t m = (std::min)(block, n - i);
+			reverb.process(in.data() + i, in.data() + i, m, left.data() + i, right.data() + i);
+		}
+	}
+}
+
+template <typename MATRIX>
+void test_orthogonal() {
+	std_dsp::dynamic_storage<8> rows(5);
+	double scratch[5];
+	double before = 0.0;
+	for(std::int64_t i = 0; i < 8; ++i) {
+		for(std::int64_t k = 0; k < 5; ++k) {
+			rows.begin(i)[k] = std::sin(1.3 * i + 0.7 * k);
+			before += rows.begin(i)[k] * rows.begin(i)[k];
+		}
+	}
+
+	MATRIX::apply(rows, scratch, 5);
+
+	double after = 0.0;
+	for(std::int64_t i = 0; i < 8; ++i) {
+		for(std::int64_t k = 0; k < 5; ++k) {
+			const double x = rows.begin(i)[k] * MATRIX::scale(8);
+			after += x * x;
+		}
+	}
+	EXPECT_NEAR(before, after, 1e-12);
+}
+
+TEST(FdnReverbTest, OrthogonalFeedback) {
+
+	test_orthogonal<std_dsp::hadamard_feedback>();
+	test_orthogonal<std_dsp::householder_feedback>();
+}
+
+TEST(FdnReverbTest, DecayTime) {
+
+	const double fs = 48000.0;
+	std_dsp::fdn_reverb<8> reverb(fs);
+	reverb.set_decay(1.0, 1.0);
+
+	std::vector<double> left, right;
+	impulse_response(reverb, 48000, 512, left, right);
+
+	//Silent until the shortest line comes around
+	std::int64_t shortest = reverb.delay(0);
+	for(std::int64_t i = 1; i < 8; ++i)
+		shortest = (std::min)(shortest, reverb.delay(i));
+	EXPECT_EQ(0.0, energy(left, 0, static_cast<std::size_t>(shortest)));
+	EXPECT_GT(energy(left, static_cast<std::size_t>(shortest), static_cast<std::size_t>(shortest) + 1), 0.0);
+
+	//60 dB per second, 30 dB over half a second
+	const double early = energy(left, 9600, 14400) + energy(right, 9600, 14400);
+	const double late = energy(left, 33600, 38400) + energy(right, 33600, 38400);
+	EXPECT_NEAR(30.0, 10.0 * std::log10(early / late), 4.0);
+
+	//The channels are decorrelated
+	double cross = 0.0;
+	for(std::size_t i = 0; i < left.size(); ++i)
+		cross += left[i] * right[i];
+	EXPECT_LT(std::fabs(cross), 0.5 * std::sqrt(energy(left, 0, left.size()) * energy(right, 0, right.size())));
+}
+
+TEST(FdnReverbTest, BlockSizeIndependent) {
+
+	std_dsp::fdn_reverb<16> a(44100.0);
+	std_dsp::fdn_reverb<16> b(44100.0);
+	a.set_modulation(8.0, 0.5);
+	b.set_modulation(8.0, 0.5);
+
+	std::vector<double> la, ra, lb, rb;
+	impulse_response(a, 20000, 4096, la, ra);
+	impulse_response(b, 20000, 37, lb, rb);
+	for(std::size_t i = 0; i < la.size(); ++i) {
+		ASSERT_NEAR(la[i], lb[i], 1e-12) << i;
+		ASSERT_NEAR(ra[i], rb[i], 1e-12) << i;
+	}
+
+	std_dsp::fdn_reverb<4, std_dsp::householder_feedback> h(44100.0);
+	impulse_response(h, 20000, 4096, la, ra);
+	EXPECT_GT(energy(la, 0, la.size()), 0.0);
+	EXPECT_LT(energy(la, 19000, 20000), energy(la, 2000, 3000));
+}
@@ -0,0 +1,168 @@
+//Unit tests for the coefficient designers
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstdint>
+
+#include "../../filters/biquad_design.h"
+
+namespace {
+	const double FS = 48000.0;
+
+	double db(double x) { return std::pow(10.0, x / 20.0); }
+
+	//Poles strictly inside the unit circle
+	bool stable(const std_dsp::biquad_coeffs& c) {
+		return std::fabs(c.a2) < 1.0 && std::fabs(c.a1) < 1.0 + c.a2;
+	}
+}
+
+TEST(BiquadDesignTest, Cookbook) {
+
+	using std_dsp::rbj_shape;
+	const double fc = 1000.0;
+
+	std_dsp::biquad_coeffs c = std_dsp::rbj_biquad(rbj_shape::low_pass, fc, std::sqrt(0.5), 0.0, FS);
+	EXPECT_NEAR(1.0, std_dsp::magnitude(&c, 1, 0.0, FS), 1e-12);
+	EXPECT_NEAR(std::sqrt(0.5), std_dsp::magnitude(&c, 1, fc, FS), 1e-12);
+
+	c = std_dsp::rbj_biquad(rbj_shape::high_pass, fc, std::sqrt(0.5), 0.0, FS);
+	EXPECT_NEAR(1.0, std_dsp::magnitude(&c, 1, 0.5 * FS, FS), 1e-12);
+	EXPECT_NEAR(std::sqrt(0.5), std_dsp::magnitude(&c, 1, fc, FS), 1e-12);
+
+	c = std_dsp::rbj_biquad(rbj_shape::band_pass, fc, 2.0, 0.0, FS);
+	EXPECT_NEAR(1.0, std_dsp::magnitude(&c, 1, fc, FS), 1e-12);
+
+	c = std_dsp::rbj_biquad(rbj_shape::notch, fc, 2.0, 0.0, FS);
+	EXPECT_NEAR(0.0, std_dsp::magnitude(&c, 1, fc, FS), 1e-9);
+
+	c = std_dsp::rbj_biquad(rbj_shape::all_pass, fc, 2.0, 0.0, FS);
+	for(double f = 0.0; f < 0.5 * FS; f += 997.0)
+		EXPECT_NEAR(1.0, std_dsp::magnitude(&c, 1, f, FS), 1e-12);
+
+	c = std_dsp::rbj_biquad(rbj_shape::peaking, fc, 1.0, 6.0, FS);
+	EXPECT_NEAR(db(6.0), std_dsp::magnitude(&c, 1, fc, FS), 1e-12);
+	EXPECT_NEAR(1.0, std_dsp::magnitude(&c, 1, 0.0, FS), 1e-12);
+
+	c = std_dsp::rbj_biquad(rbj_shape::low_shelf, fc, std::sqrt(0.5), -9.0, FS);
+	EXPECT_NEAR(db(-9.0), std_dsp::magnitude(&c, 1, 0.0, FS), 1e-12);
+	EXPECT_NEAR(1.0, std_dsp::magnitude(&c, 1, 0.5 * FS, FS), 1e-9);
+
+	c = std_dsp::rbj_biquad(rbj_shape::high_shelf, fc, std::sqrt(0.5), 4.0, FS);
+	EXPECT_NEAR(1.0, std_dsp::magnitude(&c, 1, 0.0, FS), 1e-12);
+	EXPECT_NEAR(db(4.0), std_dsp::magnitude(&c, 1, 0.5 * FS, FS), 1e-9);
+}
+
+TEST(BiquadDesignTest, Butterworth) {
+
+	std_dsp::biquad_coeffs c[16];
+	for(std::int64_t order = 1; order <= 12; ++order) {
+		const std::int64_t n = std_dsp::butterworth(std_dsp::filter_pass::low_pass, order, 2000.0, FS, c);
+		ASSERT_EQ(std_dsp::design_sections(order), n);
+		EXPECT_NEAR(1.0, std_dsp::magnitude(c, n, 0.0, FS), 1e-9) << order;
+		EXPECT_NEAR(std::sqrt(0.5), std_dsp::magnitude(c, n, 2000.0, FS), 1e-9) << order;
+
+		//Maximally flat: no ripple anywhere
+		double previous = 2.0;
+		for(double f = 0.0; f < 0.5 * FS; f += 250.0) {
+			const double m = std_dsp::magnitude(c, n, f, FS);
+			EXPECT_LE(m, previous + 1e-12) << order << " at " << f;
+			previous = m;
+		}
+		for(std::int64_t i = 0; i < n; ++i)
+			EXPECT_TRUE(stable(c[i]));
+
+		const std::int64_t h = std_dsp::butterworth(std_dsp::filter_pass::high_pass, order, 2000.0, FS, c);
+		EXPECT_NEAR(1.0, std_dsp::magnitude(c, h, 0.5 * FS, FS), 1e-9) << order;
+		EXPECT_NEAR(std::sqrt(0.5), std_dsp::magnitude(c, h, 2000.0, FS), 1e-9) << order;
+		EXPECT_NEAR(0.0, std_dsp::magnitude(c, h, 0.0, FS), 1e-9) << order;
+	}
+}
+
+TEST(BiquadDesignTest, Chebyshev) {
+
+	std_dsp::biquad_coeffs c[16];
+	for(std::int64_t order = 2; order <= 9; ++order) {
+		const std::int64_t n = std_dsp::chebyshev(std_dsp::filter_pass::low_pass, order, 1.0, 3000.0, FS, c);
+
+		//The passband stays within the ripple and ends at its bottom
+		for(double f = 0.0; f <= 3000.0; f += 25.0) {
+			const double m = std_dsp::magnitude(c, n, f, FS);
+			EXPECT_LE(m, 1.0 + 1e-9) << order << " at " << f;
+			EXPECT_GE(m, db(-1.0) - 1e-9) << order << " at " << f;
+		}
+		EXPECT_NEAR(db(-1.0), std_dsp::magnitude(c, n, 3000.0, FS), 1e-9) << order;
+		EXPECT_LT(std_dsp::magnitude(c, n, 12000.0, FS), db(-20.0)) << order;
+		for(std::int64_t i = 0; i < n; ++i)
+			EXPECT_TRUE(stable(c[i]));
+	}
+}
+
+TEST(BiquadDesignTest, Elliptic) {
+
+	std_dsp::biquad_coeffs c[16];
+	for(std::int64_t order = 2; order <= 10; ++order) {
+		for(int high = 0; high < 2; ++high) {
+			const std_dsp::filter_pass pass = high ? std_dsp::filter_pass::high_pass : std_dsp::filter_pass::low_pass;
+			const std::int64_t n = std_dsp::elliptic(pass, order, 0.5, 60.0, 1000.0, FS, c);
+			ASSERT_EQ(std_dsp::design_sections(order), n);
+			for(std::int64_t i = 0; i < n; ++i)
+				EXPECT_TRUE(stable(c[i]));
+
+			//Passband within the ripple
+			const double lo = high ? 1000.0 : 0.0;
+			const double hi = high ? 0.5 * FS : 1000.0;
+			for(double f = lo; f <= hi; f += (hi - lo) / 400.0) {
+				const double m = std_dsp::magnitude(c, n, f, FS);
+				EXPECT_LE(m, 1.0 + 1e-9) << order << " at " << f;
+				EXPECT_GE(m, db(-0.5) - 1e-9) << order << " at " << f;
+			}
+		}
+
+		//From order 6 on the transition is over by 1.5 kHz, and nothing past it rises above the floor
+		if(order >= 6) {
+			const std::int64_t n = std_dsp::elliptic(std_dsp::filter_pass::low_pass, order, 0.5, 60.0, 1000.0, FS, c);
+			for(double f = 1500.0; f < 0.5 * FS; f += 7.0)
+				EXPECT_LE(std_dsp::magnitude(c, n, f, FS), db(-60.0) * (1.0 + 1e-6)) << order << " at " << f;
+		}
+	}
+}
+
+TEST(BiquadDesignTest, Cache) {
+
+	std_dsp::rbj_cache<64> cache;
+	const std_dsp::biquad_coeffs direct = std_dsp::rbj_biquad(std_dsp::rbj_shape::peaking, 440.0, 2.0, 3.0, FS);
+
+	std_dsp::biquad_coeffs c = cache(std_dsp::rbj_shape::peaking, 440.0, 2.0, 3.0, FS);
+	EXPECT_EQ(0, cache.hits());
+	EXPECT_EQ(1, cache.misses());
+	EXPECT_EQ(direct.a1, c.a1);
+	EXPECT_EQ(direct.b0, c.b0);
+
+	c = cache(std_dsp::rbj_shape::peaking, 440.0, 2.0, 3.0, FS);
+	EXPECT_EQ(1, cache.hits());
+	EXPECT_EQ(direct.b2, c.b2);
+
+	//Any field that differs is another design
+	c = cache(std_dsp::rbj_shape::peaking, 440.0, 2.0, 3.5, FS);
+	c = cache(std_dsp::rbj_shape::notch, 440.0, 2.0, 3.0, FS);
+	EXPECT_EQ(1, cache.hits());
+	EXPECT_EQ(3, cache.misses());
+
+	//Stepped automation keeps hitting
+	for(int pass = 0; pass < 3; ++pass) {
+		for(int step = 0; step < 16; ++step) {
+			const double fc = 100.0 * (step + 1);
+			c = cache(std_dsp::rbj_shape::low_pass, fc, 0.7, 0.0, FS);
+			const std_dsp::biquad_coeffs d = std_dsp::rbj_biquad(std_dsp::rbj_shape::low_pass, fc, 0.7, 0.0, FS);
+			EXPECT_EQ(d.a2, c.a2);
+			EXPECT_EQ(d.b1, c.b1);
+		}
+	}
+	EXPECT_GT(cache.hits(), 20);
+
+	cache.clear();
+	EXPECT_EQ(0, cache.hits());
+	EXPECT_EQ(0, cache.misses());
+}
@@ -0,0 +1,358 @@
+//Unit tests for the biquad filters and cascades
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include "../test_signals.h"
+
+#include "../../std_dsp_biquad_filter.h"
+
+namespace {
+	//A peaking section per band, stable for every index
+	std_dsp::biquad_coeffs test_section(int i) {
+		const double w = 0.05 + 0.17 * i;
+		const double r = 0.9 - 0.01 * i;
+		std_dsp::biquad_coeffs c;
+		c.a1 = -2.0 * r * std::cos(w);
+		c.a2 = r * r;
+		c.b0 = 1.0 + 0.1 * i;
+		c.b1 = -1.5 * std::cos(w);
+		c.b2 = 0.5;
+		return c;
+	}
+
+	std::vector<double> test_input(std::int64_t n) {
+		std::vector<double> x(n);
+		for(std::int64_t i = 0; i < n; ++i)
+			x[i] = std::sin(0.3 * i) + 0.5 * std::cos(1.7 * i) + (i == 0 ? 1.0 : 0.0);
+		return x;
+	}
+
+	using std_dsp::test_signals::available_levels;
+	using std_dsp::test_signals::simd_level_scope;
+}
+
+TEST(BiquadFilterTest, MonoAndStereo) {
+
+	const std_dsp::biquad_coeffs c1 = test_section(1);
+	const std_dsp::biquad_coeffs c2 = test_section(4);
+	const std::vector<double> x = test_input(100);
+
+	//Reference: the difference equation
+	std::vector<double> y(100);
+	double w1 = 0.0, w2 = 0.0;
+	for(int i = 0; i < 100; ++i) {
+		const double w0 = x[i] - c1.a1 * w1 - c1.a2 * w2;
+		y[i] = c1.b0 * w0 + c1.b1 * w1 + c1.b2 * w2;
+		w2 = w1;
+		w1 = w0;
+	}
+
+	std_dsp::biquad_state<1> s;
+	s.reset();
+	std::vector<double> out(100);
+	s = std_dsp::biquad(x.data(), 60, out.data(), c1, s);
+	s = std_dsp::biquad(x.data() + 60, 40, out.data() + 60, c1, s);
+	for(int i = 0; i < 100; ++i)
+		EXPECT_NEAR(y[i], out[i], 1e-12 * (1.0 + std::fabs(y[i])));
+
+	//Interleaved stereo with a filter per channel
+	std::vector<double> st(200), st_out(200), right(100);
+	for(int i = 0; i < 100; ++i) {
+		st[2 * i] = x[i];
+		st[2 * i + 1] = x[99 - i];
+	}
+	std_dsp::biquad_state<2> s2;
+	s2.reset();
+	s2 = std_dsp::biquad(st.data(), 100, st_out.data(), c1, c2, s2);
+
+	std::vector<double> reversed(x.rbegin(), x.rend());
+	s.reset();
+	s = std_dsp::biquad(reversed.data(), 100, right.data(), c2, s);
+	for(int i = 0; i < 100; ++i) {
+		EXPECT_NEAR(y[i], st_out[2 * i], 1e-12 * (1.0 + std::fabs(y[i])));
+		EXPECT_NEAR(right[i], st_out[2 * i + 1], 1e-12 * (1.0 + std::fabs(right[i])));
+	}
+	EXPECT_NEAR(s.w1[0], s2.w1[1], 1e-12 * (1.0 + std::fabs(s.w1[0])));
+}
+
+TEST(BiquadFilterTest, Ramp) {
+
+	const std_dsp::biquad_coeffs from = test_section(1);
+	const std_dsp::biquad_coeffs to = test_section(6);
+	const std::vector<double> x = test_input(200);
+
+	//Reference: the coefficients recomputed every sample
+	std::vector<double> y(200);
+	double w1 = 0.0, w2 = 0.0;
+	for(int i = 0; i < 200; ++i) {
+		const double t = i < 128 ? (i + 1) / 128.0 : 1.0;
+		const double a1 = from.a1 + t * (to.a1 - from.a1);
+		const double a2 = from.a2 + t * (to.a2 - from.a2);
+		const double b0 = from.b0 + t * (to.b0 - from.b0);
+		const double b1 = from.b1 + t * (to.b1 - from.b1);
+		const double b2 = from.b2 + t * (to.b2 - from.b2);
+		const double w0 = x[i] - a1 * w1 - a2 * w2;
+		y[i] = b0 * w0 + b1 * w1 + b2 * w2;
+		w2 = w1;
+		w1 = w0;
+	}
+
+	std_dsp::biquad_state<1> s;
+	s.reset();
+	std::vector<double> out(200);
+	s = std_dsp::biquad_ramp(x.data(), 128, out.data(), from, to, s);
+	s = std_dsp::biquad(x.data() + 128, 72, out.data() + 128, to, s);
+	for(int i = 0; i < 200; ++i)
+		EXPECT_NEAR(y[i], out[i], 1e-12 * (1.0 + std::fabs(y[i])));
+
+	//The same glide spread over blocks that do not line up with it
+	std_dsp::smoothed_biquad f(from);
+	f.set_target(to, 128);
+	std::vector<double> blocks(200);
+	for(int i = 0; i < 200; i += 48) {
+		EXPECT_EQ(i < 128, f.smoothing());
+		f.process(x.data() + i, (std::min)(48, 200 - i), blocks.data() + i);
+	}
+	EXPECT_FALSE(f.smoothing());
+	EXPECT_EQ(to.a1, f.coeffs().a1);
+	EXPECT_EQ(to.b0, f.coeffs().b0);
+	for(int i = 0; i < 200; ++i)
+		EXPECT_NEAR(y[i], blocks[i], 1e-12 * (1.0 + std::fabs(y[i])));
+
+	//Without a target it is a plain section
+	f.set(from);
+	f.reset();
+	s.reset();
+	std::vector<double> plain(200);
+	s = std_dsp::biquad(x.data(), 200, plain.data(), from, s);
+	f.process(x.data(), 200, blocks.data());
+	for(int i = 0; i < 200; ++i)
+		EXPECT_EQ(plain[i], blocks[i]);
+}
+
+TEST(BiquadFilterTest, Cascade) {
+
+	for(const std_dsp::simd_level level : available_levels()) {
+		simd_level_scope scope(level);
+
+		const std::int64_t sizes[] = { 0, 1, 2, 3, 7, 8, 9, 100, 1000 };
+		for(int sections = 0; sections <= 17; ++sections) {
+			std::vector<std_dsp::biquad_coeffs> c(sections);
+			for(int j = 0; j < sections; ++j)
+				c[j] = test_section(j);
+
+			for(std::int64_t n : sizes) {
+				const std::vector<double> x = test_input(2 * n);
+
+				//Reference: one section after the other over the whole signal
+				std::vector<double> y(x);
+				for(int j = 0; j < sections; ++j) {
+					std_dsp::biquad_state<1> s;
+					s.reset();
+					std_dsp::biquad(y.data(), 2 * n, y.data(), c[j], s);
+				}
+
+				//Two blocks, the second in place
+				std::vector<std_dsp::biquad_state<1>> s(sections);
+				for(auto& sj : s)
+					sj.reset();
+				std::vector<double> out(x);
+				std_dsp::biquad_cascade(x.data(), n, out.data(), c.data(), s.data(), sections);
+				std_dsp::biquad_cascade(out.data() + n, n, out.data() + n, c.data(), s.data(), sections);
+
+				for(std::int64_t i = 0; i < 2 * n; ++i)
+					ASSERT_NEAR(y[i], out[i], 1e-9 * (1.0 + std::fabs(y[i]))) << sections << " sections, " << n << " samples, at " << i;
+			}
+		}
+	}
+}
+
+TEST(BiquadFilterTest, CascadeFilter) {
+
+	std_dsp::biquad_coeffs c[5];
+	for(int j = 0; j < 5; ++j)
+		c[j] = test_section(j);
+
+	std_dsp::biquad_cascade_filter<16> f(c, 5);
+	EXPECT_EQ(5, f.sections());
+
+	const std::vector<double> x = test_input(300);
+	std::vector<double> a(300), b(300);
+	f.process(x.data(), 300, a.data());
+
+	f.reset();
+	for(int i = 0; i < 300; i += 64)
+		f.process(x.data() + i, (std::min)(64, 300 - i), b.data() + i);
+	for(int i = 0; i < 300; ++i)
+		EXPECT_NEAR(a[i], b[i], 1e-12 * (1.0 + std::fabs(a[i])));
+
+	//Identity sections pass the signal through
+	f.set_sections(nullptr, 0);
+	f.process(x.data(), 300, a.data());
+	for(int i = 0; i < 300; ++i)
+		EXPECT_EQ(x[i], a[i]);
+}
+
+TEST(BiquadFilterTest, Channels) {
+
+	for(const std_dsp::simd_level level : available_levels()) {
+		simd_level_scope scope(level);
+
+		const std::int64_t n = 150;
+		for(std::int64_t channels = 1; channels <= 16; ++channels) {
+			std::vector<std_dsp::biquad_coeffs> c(channels);
+			for(std::int64_t j = 0; j < channels; ++j)
+				c[j] = test_section(static_cast<int>(j % 9));
+
+			//Planar input, channel j a shifted copy of the test signal
+			const std::vector<double> x = test_input(n + channels);
+			std::vector<double> planar(channels * n), y(channels * n);
+			for(std::int64_t j = 0; j < channels; ++j) {
+				std::copy_n(x.begin() + j, n, planar.begin() + j * n);
+
+				std_dsp::biquad_state<1> s;
+				s.reset();
+				std_dsp::biquad(planar.data() + j * n, n, y.data() + j * n, c[j], s);
+			}
+
+			//Per channel coefficients, in two calls
+			std::vector<double> out(channels * n);
+			std::vector<std_dsp::biquad_state<1>> s(channels);
+			for(auto& state : s)
+				state.reset();
+			const std_dsp::buffer_view<const double> in(planar.data(), channels, n, n, 1);
+			const std_dsp::buffer_view<double> to(out.data(), channels, n, n, 1);
+			std_dsp::biquad(in.take(70), to.take(70), c.data(), s.data());
+			std_dsp::biquad(in.drop(70), to.drop(70), c.data(), s.data());
+			for(std::int64_t i = 0; i < channels * n; ++i)
+				ASSERT_NEAR(y[i], out[i], 1e-12 * (1.0 + std::fabs(y[i]))) << channels << " channels, at " << i;
+
+			//Interleaved in place, one filter for all channels
+			std::vector<double> interleaved(channels * n);
+			for(std::int64_t j = 0; j < channels; ++j) {
+				for(std::int64_t i = 0; i < n; ++i)
+					interleaved[i * channels + j] = planar[j * n + i];
+			}
+			for(auto& state : s)
+				state.reset();
+			const std_dsp::buffer_view<double> frames(interleaved.data(), channels, n, 1, channels);
+			std_dsp::biquad(frames, frames, c[0], s.data());
+			for(std::int64_t j = 0; j < channels; ++j) {
+				std_dsp::biquad_state<1> state;
+				state.reset();
+				std::vector<double> reference(n);
+				state = std_dsp::biquad(planar.data() + j * n, n, reference.data(), c[0], state);
+				for(std::int64_t i = 0; i < n; ++i)
+					ASSERT_NEAR(reference[i], interleaved[i * channels + j], 1e-12 * (1.0 + std::fabs(reference[i]))) << channels << " channels";
+				EXPECT_NEAR(state.w1[0], s[j].w1[0], 1e-12 * (1.0 + std::fabs(state.w1[0])));
+			}
+		}
+	}
+}
+
+TEST(BiquadFilterTest, Batch) {
+
+	for(const std_dsp::simd_level level : available_levels()) {
+		simd_level_scope scope(level);
+
+		//Voices in buffers of their own, every other one filtered in place
+		const std::int64_t voices = 203;
+		const std::int64_t n = 90;
+		std::vector<std::vector<double>> in(voices), out(voices), y(voices);
+		std::vector<const double*> in_ptrs(voices);
+		std::vector<double*> out_ptrs(voices);
+		std::vector<std_dsp::biquad_coeffs> c(voices);
+		std::vector<std_dsp::biquad_state<1>> s(voices);
+		for(std::int64_t v = 0; v < voices; ++v) {
+			const std::vector<double> x = test_input(n + v);
+			in[v].assign(x.begin() + v, x.end());
+			out[v].assign(n, 0.0);
+			c[v] = test_section(static_cast<int>(v % 9));
+			s[v].reset();
+
+			std_dsp::biquad_state<1> state;
+			state.reset();
+			y[v].resize(n);
+			std_dsp::biquad(in[v].data(), n, y[v].data(), c[v], state);
+
+			in_ptrs[v] = in[v].data();
+			out_ptrs[v] = v % 2 == 0 ? in[v].data() : out[v].data();
+		}
+
+		//Two calls, the second continuing from the states the first left
+		std_dsp::biquad_batch(in_ptrs.data(), out_ptrs.data(), 40, c.data(), s.data(), voices);
+		for(std::int64_t v = 0; v < voices; ++v) {
+			in_ptrs[v] += 40;
+			out_ptrs[v] += 40;
+		}
+		std_dsp::biquad_batch(in_ptrs.data(), out_ptrs.data(), n - 40, c.data(), s.data(), voices);
+
+		for(std::int64_t v = 0; v < voices; ++v) {
+			const std::vector<double>& result = v % 2 == 0 ? in[v] : out[v];
+			for(std::int64_t i = 0; i < n; ++i)
+				ASSERT_NEAR(y[v][i], result[i], 1e-12 * (1.0 + std::fabs(y[v][i]))) << "voice " << v << " at " << i;
+		}
+	}
+}
+
+TEST(BiquadFilterTest, ParallelBiquad) {
+
+	for(const std_dsp::simd_level level : available_levels()) {
+		simd_level_scope scope(level);
+
+		//RBJ low pass sections from gentle to very resonant and very low
+		const double cases[][2] = { { 0.2, 0.7 }, { 0.01, 0.7 }, { 0.05, 10.0 }, { 0.001, 2.0 } };
+		const std::int64_t n = 4001;
+		std::vector<double> x(n);
+		std::uint32_t seed = 12345;
+		for(auto& v : x) {
+			seed = seed * 1664525u + 1013904223u;
+			v = static_cast<double>(seed) / 2147483648.0 - 1.0;
+		}
+
+		for(const auto& k : cases) {
+			const double w = 6.283185307179586 * k[0];
+			const double alpha = std::sin(w) / (2.0 * k[1]);
+			const double a0 = 1.0 + alpha;
+			std_dsp::biquad_coeffs c;
+			c.a1 = -2.0 * std::cos(w) / a0;
+			c.a2 = (1.0 - alpha) / a0;
+			c.b0 = (1.0 - std::cos(w)) / 2.0 / a0;
+			c.b1 = (1.0 - std::cos(w)) / a0;
+			c.b2 = c.b0;
+
+			//Reference in extended precision
+			std::vector<long double> y(n);
+			long double w1 = 0.0L, w2 = 0.0L;
+			for(std::int64_t i = 0; i < n; ++i) {
+				const long double w0 = x[i] - static_cast<long double>(c.a1) * w1 - static_cast<long double>(c.a2) * w2;
+				y[i] = c.b0 * w0 + c.b1 * w1 + c.b2 * w2;
+				w2 = w1;
+				w1 = w0;
+			}
+
+			std_dsp::parallel_biquad f(c);
+			const double bound = f.error_bound();
+			EXPECT_LT(bound, 1.e-6) << k[0];
+
+			//Odd block sizes leave a scalar tail every call
+			std::vector<double> out(n);
+			for(std::int64_t i = 0; i < n; i += 37)
+				f.process(x.data() + i, (std::min)(std::int64_t(37), n - i), out.data() + i);
+
+			double error = 0.0;
+			for(std::int64_t i = 0; i < n; ++i)
+				error = (std::max)(error, static_cast<double>(std::fabs(out[i] - y[i])));
+			EXPECT_LE(error, bound) << k[0];
+		}
+
+		//Unstable sections have no bound
+		std_dsp::biquad_coeffs unstable = { -2.0, 1.01, 1.0, 0.0, 0.0 };
+		EXPECT_EQ(HUGE_VAL, std_dsp::biquad_block_error_bound(unstable, 8));
+	}
+}
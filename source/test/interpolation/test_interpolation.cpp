@@ -0,0 +1,122 @@
+//Unit tests for the fractional delay interpolators
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "../test_signals.h"
+
+#include "../../containers/delay_line.h"
+#include "../../interpolation/interpolation.h"
+
+namespace {
+	//Polynomials the interpolators reproduce exactly, zero before the start
+	double ramp(double t) { return t < 0.0 ? 0.0 : 0.5 * t - 3.0; }
+	double cubic(double t) { const double u = t / 100.0; return t < 0.0 ? 0.0 : u * u * u - 2.0 * u * u + u - 1.0; }
+	double quintic(double t) { const double u = t / 100.0; return t < 0.0 ? 0.0 : u * u * u * u * u - u * u * u + 0.5 * u; }
+
+	using std_dsp::test_signals::available_levels;
+	using std_dsp::test_signals::simd_level_scope;
+}
+
+template <typename D, typename INTERPOLATOR, typename SIGNAL>
+void test_modulated_read(D& d, INTERPOLATOR interpolator, SIGNAL signal) {
+	const std::int64_t block = 100;
+	std::vector<double> in(block), delays(block), out(block);
+	std::int64_t t = 0;
+	for(int b = 0; b < 12; ++b) {
+		for(std::int64_t i = 0; i < block; ++i) {
+			in[i] = signal(static_cast<double>(t + i));
+			//Sweeps between 3 and 200 samples
+			delays[i] = 101.5 + 98.5 * std::sin(0.0123 * static_cast<double>(t + i));
+		}
+		d.write(0, in.data(), block);
+		d.read_fractional(0, delays.data(), block, out.data(), interpolator);
+
+		for(std::int64_t i = 0; i < block; ++i) {
+			const double p = static_cast<double>(t + i) - delays[i];
+			if(p - 3.0 >= 0.0) {
+				ASSERT_NEAR(signal(p), out[i], 1e-9) << "block " << b << " sample " << i;
+			}
+		}
+
+		d.rotate(block);
+		t += block;
+	}
+}
+
+TEST(InterpolationTest, ExactForPolynomials) {
+
+	//Every level evaluates the rows with its own vector width
+	for(const std_dsp::simd_level level : available_levels()) {
+		simd_level_scope scope(level);
+
+		std_dsp::delay_line<1> d(std_dsp::minimum_buffer_size(206, 100));
+		test_modulated_read(d, std_dsp::linear_interpolation(), ramp);
+		d.clear();
+		test_modulated_read(d, std_dsp::hermite_interpolation(), ramp);
+		d.clear();
+		test_modulated_read(d, std_dsp::lagrange_interpolation<3>(), cubic);
+		d.clear();
+		test_modulated_read(d, std_dsp::lagrange_interpolation<5>(), quintic);
+	}
+}
+
+TEST(InterpolationTest, WrapPolicies) {
+
+	for(const std_dsp::simd_level level : available_levels()) {
+		simd_level_scope scope(level);
+
+		std_dsp::masked_delay_line<1> m(std_dsp::minimum_buffer_size(206, 100));
+		test_modulated_read(m, std_dsp::lagrange_interpolation<5>(), quintic);
+
+		std_dsp::mirrored_delay_line<1> r(std_dsp::minimum_buffer_size(206, 100));
+		test_modulated_read(r, std_dsp::hermite_interpolation(), ramp);
+	}
+}
+
+TEST(InterpolationTest, IntegerDelays) {
+
+	//A whole delay reads the stored sample
+	std_dsp::delay_line<1> d(64);
+	std::vector<double> in(20), delays(20, 7.0), out(20);
+	for(int i = 0; i < 20; ++i)
+		in[i] = std::sin(0.7 * i);
+	d.write(0, in.data(), 20);
+
+	for(const std_dsp::simd_level level : available_levels()) {
+		simd_level_scope scope(level);
+
+		d.read_fractional(0, delays.data(), 20, out.data(), std_dsp::lagrange_interpolation<5>());
+		for(int i = 7; i < 20; ++i)
+			EXPECT_NEAR(in[i - 7], out[i], 1e-14);
+		d.read_fractional(0, delays.data(), 20, out.data(), std_dsp::hermite_interpolation());
+		for(int i = 7; i < 20; ++i)
+			EXPECT_EQ(in[i - 7], out[i]);
+	}
+}
+
+TEST(InterpolationTest, Thiran) {
+
+	//At low frequencies the allpass delays a sine by its fractional delay
+	const double w = 0.01;
+	const double delay = 10.3;
+	std_dsp::delay_line<1> d(256);
+	std_dsp::thiran_interpolation allpass;
+	std::vector<double> in(64), delays(64, delay), out(64);
+	std::int64_t t = 0;
+	for(int b = 0; b < 40; ++b) {
+		for(int i = 0; i < 64; ++i)
+			in[i] = std::sin(w * static_cast<double>(t + i));
+		d.write(0, in.data(), 64);
+		d.read_fractional(0, delays.data(), 64, out.data(), allpass);
+		if(b >= 10) {
+			for(int i = 0; i < 64; ++i)
+				ASSERT_NEAR(std::sin(w * (static_cast<double>(t + i) - delay)), out[i], 1e-5);
+		}
+		d.rotate(64);
+		t += 64;
+	}
+}
@@ -0,0 +1,104 @@
+
+//Unit tests for the real-time scratch arena
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+#include "../../memory/buffer_allocator.h"
+
+TEST(ScratchArenaTest, LifoAllocation) {
+
+	std_dsp::scratch_arena<256> arena;
+	EXPECT_EQ(256, arena.capacity());
+	EXPECT_EQ(0, arena.used());
+
+	{
+		std_dsp::scratch_arena<256>::buffer a(arena, 3);
+		EXPECT_EQ(3, a.size());
+		EXPECT_EQ(8, arena.used());
+		EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(a.get()) % std_dsp::cache_line_size);
+
+		{
+			std_dsp::scratch_arena<256>::buffer b(arena, 100);
+			EXPECT_EQ(8 + 104, arena.used());
+			EXPECT_EQ(a.get() + 8, b.get());
+			EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(b.get()) % std_dsp::cache_line_size);
+
+			std::fill(a.begin(), a.end(), 1.0);
+			std::fill(b.begin(), b.end(), 2.0);
+			EXPECT_EQ(1.0, a.get()[2]);
+		}
+
+		EXPECT_EQ(8, arena.used());
+
+		//Released memory is handed out again
+		std_dsp::scratch_arena<256>::buffer c(arena, 16);
+		EXPECT_EQ(a.get() + 8, c.get());
+	}
+
+	EXPECT_EQ(0, arena.used());
+}
+
+TEST(ScratchArenaTest, DynamicCapacity) {
+
+	std_dsp::scratch_arena<> arena(1000);
+	EXPECT_EQ(1000, arena.capacity());
+
+	std_dsp::scratch_arena<>::buffer a(arena, 1000);
+	EXPECT_EQ(0, arena.available());
+	EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(a.get()) % std_dsp::cache_line_size);
+}
+
+TEST(ScratchArenaTest, OverflowPolicies) {
+
+	{
+		std_dsp::scratch_arena<64> arena;
+		std_dsp::scratch_arena<64>::buffer a(arena, 64);
+		EXPECT_THROW(std_dsp::scratch_arena<64>::buffer b(arena, 1), std::bad_alloc);
+		EXPECT_EQ(64, arena.used());
+	}
+
+	{
+		std_dsp::scratch_arena<64, std_dsp::null_on_overflow> arena;
+		std_dsp::scratch_arena<64, std_dsp::null_on_overflow>::buffer a(arena, 65);
+		EXPECT_EQ(nullptr, a.get());
+		EXPECT_EQ(0, arena.used());
+	}
+
+	{
+		using arena_t = std_dsp::scratch_arena<64, std_dsp::heap_on_overflow, true>;
+		arena_t arena;
+		arena_t::buffer a(arena, 40);
+		{
+			arena_t::buffer b(arena, 40);
+			ASSERT_NE(nullptr, b.get());
+			std::fill(b.begin(), b.end(), 1.0);
+			EXPECT_EQ(40, arena.used());
+		}
+		EXPECT_EQ(1, arena.overflows());
+	}
+}
+
+TEST(ScratchArenaTest, HighWaterMark) {
+
+	using arena_t = std_dsp::scratch_arena<1024, std_dsp::throw_on_overflow, true>;
+	arena_t arena;
+
+	{
+		arena_t::buffer a(arena, 100);
+		{
+			arena_t::buffer b(arena, 200);
+		}
+		arena_t::buffer c(arena, 10);
+	}
+
+	EXPECT_EQ(0, arena.used());
+	EXPECT_EQ(104 + 200, arena.high_water_mark());
+	EXPECT_EQ(0, arena.overflows());
+
+	arena.reset_statistics();
+	EXPECT_EQ(0, arena.high_water_mark());
+}
@@ -0,0 +1,120 @@
+
+//Unit tests for the recycling buffer pool
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include "../../memory/buffer_pool.h"
+
+TEST(BufferPoolTest, SizeClasses) {
+
+	EXPECT_EQ(8, std_dsp::buffer_pool::block_size(1));
+	EXPECT_EQ(8, std_dsp::buffer_pool::block_size(8));
+	EXPECT_EQ(16, std_dsp::buffer_pool::block_size(9));
+	EXPECT_EQ(1024, std_dsp::buffer_pool::block_size(1000));
+	EXPECT_EQ(2048, std_dsp::buffer_pool::block_size(1025));
+}
+
+TEST(BufferPoolTest, RecyclesBlocks) {
+
+	std_dsp::buffer_pool pool;
+
+	double* a = pool.allocate(1000);
+	EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(a) % std_dsp::cache_line_size);
+	std::fill(a, a + 1024, 1.0);
+	pool.deallocate(a, 1000);
+	EXPECT_EQ(1, pool.cached());
+
+	//Any size of the same class gets the block back
+	double* b = pool.allocate(600);
+	EXPECT_EQ(a, b);
+	EXPECT_EQ(0, pool.cached());
+
+	//A different class does not
+	double* c = pool.allocate(100);
+	EXPECT_NE(a, c);
+
+	pool.deallocate(b, 600);
+	pool.deallocate(c, 100);
+	EXPECT_EQ(2, pool.cached());
+
+	pool.release();
+	EXPECT_EQ(0, pool.cached());
+}
+
+TEST(BufferPoolTest, Reserve) {
+
+	std_dsp::buffer_pool pool;
+	pool.reserve(512, 3);
+	EXPECT_EQ(3, pool.cached());
+	pool.reserve(300, 2);
+	EXPECT_EQ(3, pool.cached());
+
+	double* a = pool.allocate(512);
+	double* b = pool.allocate(512);
+	EXPECT_EQ(1, pool.cached());
+	pool.deallocate(a, 512);
+	pool.deallocate(b, 512);
+}
+
+TEST(BufferPoolTest, PooledStorage) {
+
+	const double* first;
+	{
+		std_dsp::pooled_storage<2> s;
+		EXPECT_EQ(&std_dsp::thread_buffer_pool(), &s.get_allocator().get_pool());
+	}
+
+	{
+		std_dsp::dynamic_storage<2, std_dsp::default_stride, std_dsp::pool_allocator> s(500);
+		std::fill(s.begin(0), s.end(0), 1.0);
+		first = s.begin();
+
+		//Same stride, same block
+		s.resize(497);
+		EXPECT_EQ(first, s.begin());
+
+		std_dsp::dynamic_storage<2, std_dsp::default_stride, std_dsp::pool_allocator> t(s);
+		EXPECT_TRUE(std_dsp::compare(t.begin(0), 1.0, 497));
+	}
+
+	std_dsp::buffer_pool& tp = std_dsp::thread_buffer_pool();
+	EXPECT_EQ(2, tp.cached());
+
+	//A rebuild of the same shape reuses the released blocks without allocating
+	{
+		std_dsp::pooled_storage<2> s(500);
+		std_dsp::pooled_storage<2> t(500);
+		EXPECT_EQ(0, tp.cached());
+		EXPECT_TRUE(s.begin() == first || t.begin() == first);
+	}
+	tp.release();
+}
+
+TEST(BufferPoolTest, ReleaseOnAnotherThread) {
+
+	std_dsp::buffer_pool& tp = std_dsp::thread_buffer_pool();
+	tp.release();
+
+	//A block allocated here and freed on a second thread joins the second thread's pool
+	std::unique_ptr<std_dsp::pooled_storage<1>> s(new std_dsp::pooled_storage<1>(500));
+	std_dsp::integer_t cached_there = 0;
+	std::thread([&]() {
+		s.reset();
+		cached_there = std_dsp::thread_buffer_pool().cached();
+	}).join();
+	EXPECT_EQ(1, cached_there);
+	EXPECT_EQ(0, tp.cached());
+
+	//A storage outliving the thread that built it releases into the pool of this one
+	std::thread([&]() {
+		s.reset(new std_dsp::pooled_storage<1>(500));
+	}).join();
+	s.reset();
+	EXPECT_EQ(1, tp.cached());
+	tp.release();
+}
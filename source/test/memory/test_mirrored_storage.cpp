@@ -0,0 +1,55 @@
+//Unit tests for the double mapped ring buffer storage
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include "../../base/std_dsp_mem.h"
+#include "../../memory/mirrored_storage.h"
+
+TEST(MirroredStorageTest, Mirror) {
+
+	std_dsp::mirrored_storage<2> s(1000);
+	ASSERT_GE(s.size(), 1000);
+	EXPECT_EQ(s.size(), std_dsp::mirrored_storage<2>::capacity(1000));
+	EXPECT_EQ(2 * s.size(), s.stride());
+	EXPECT_EQ(0.0, s.begin(1)[s.size() - 1]);
+
+	//A write running over the end of a channel lands at its beginning
+	const std::int64_t n = s.size();
+	for(std::int64_t c = 0; c < 2; ++c) {
+		for(std::int64_t i = 0; i < 8; ++i)
+			s.begin(c)[n - 4 + i] = i + 100.0 * c;
+	}
+	for(std::int64_t c = 0; c < 2; ++c) {
+		for(std::int64_t i = 0; i < 4; ++i) {
+			EXPECT_EQ(4 + i + 100.0 * c, s.begin(c)[i]);
+			EXPECT_EQ(i + 100.0 * c, s.begin(c)[n - 4 + i]);
+		}
+		s.begin(c)[7] = -1.0;
+		EXPECT_EQ(-1.0, s.begin(c)[n + 7]);
+	}
+}
+
+TEST(MirroredStorageTest, CopyAndMove) {
+
+	std_dsp::mirrored_storage<1> s(10);
+	std::fill(s.begin(0), s.end(0), 2.0);
+
+	std_dsp::mirrored_storage<1> t(s);
+	EXPECT_EQ(s.size(), t.size());
+	EXPECT_NE(s.get(), t.get());
+	t.begin(0)[0] = 3.0;
+	EXPECT_EQ(3.0, t.begin(0)[t.size()]);
+	EXPECT_EQ(2.0, s.begin(0)[0]);
+
+	std_dsp::mirrored_storage<1> u(std::move(t));
+	EXPECT_EQ(nullptr, t.get());
+	EXPECT_EQ(3.0, u.begin(0)[u.size()]);
+
+	u.resize(0);
+	EXPECT_EQ(0, u.size());
+	EXPECT_EQ(nullptr, u.get());
+}
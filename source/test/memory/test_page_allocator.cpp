@@ -0,0 +1,62 @@
+
+//Unit tests for the huge page, prefaulting and locking allocator
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "../../base/std_dsp_mem.h"
+#include "../../memory/page_allocator.h"
+
+TEST(PageAllocatorTest, AllocateAndPrefault) {
+
+	const unsigned option_sets[] = {
+		std_dsp::page_options::defaults,
+		std_dsp::page_options::defaults | std_dsp::page_options::explicit_huge_pages,
+		std_dsp::page_options::prefault,
+	};
+
+	for(unsigned options : option_sets) {
+		std_dsp::page_allocator a(options);
+		const std_dsp::integer_t n = 3 * (1 << 20) / 8 + 5;
+		double* p = a.allocate(n);
+		ASSERT_NE(nullptr, p);
+		EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(p) % std_dsp::cache_line_size);
+		EXPECT_TRUE(a.is_resident(p, n));
+
+		std::fill(p, p + n, 0.25);
+		EXPECT_TRUE(std_dsp::compare(p + n - 100, 0.25, 100));
+		a.deallocate(p, n);
+	}
+}
+
+#ifndef WIN32
+TEST(PageAllocatorTest, HugePageAlignment) {
+
+	//Blocks asking for huge pages start on a 2 MiB boundary, so every 2 MiB of them can be backed
+	const std::uintptr_t huge_page = std::uintptr_t(2) << 20;
+	const std_dsp::integer_t sizes[] = { 1, (1 << 20) / 8, (2 << 20) / 8, 5 * (1 << 20) / 8 + 3 };
+	std_dsp::page_allocator a(std_dsp::page_options::transparent_huge_pages | std_dsp::page_options::prefault);
+	for(std_dsp::integer_t n : sizes) {
+		double* p = a.allocate(n);
+		ASSERT_NE(nullptr, p);
+		EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(p) % huge_page) << n;
+		std::fill(p, p + n, 0.5);
+		EXPECT_TRUE(a.is_resident(p, n));
+		a.deallocate(p, n);
+	}
+}
+#endif
+
+TEST(PageAllocatorTest, LockedStorage) {
+
+	std_dsp::locked_storage<2> s(1 << 18);
+	EXPECT_TRUE(s.get_allocator().is_resident(s.begin(), s.physical_size()));
+	std::fill(s.begin(1), s.end(1), 1.0);
+	EXPECT_TRUE(std_dsp::compare(s.begin(1), 1.0, 1 << 18));
+
+	s.resize(1000);
+	std::fill(s.begin(0), s.end(0), 2.0);
+	EXPECT_TRUE(std_dsp::compare(s.begin(0), 2.0, 1000));
+}
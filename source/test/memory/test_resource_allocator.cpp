@@ -0,0 +1,89 @@
+
+//Unit tests for memory resource backed storage
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+#include "../../base/std_dsp_mem.h"
+#include "../../containers/buffer.h"
+#include "../../memory/resource_allocator.h"
+
+namespace {
+	//Counts the bytes outstanding and checks the alignment requested
+	struct counting_resource {
+		std::size_t outstanding = 0;
+		std::size_t allocations = 0;
+
+		void* allocate(std::size_t bytes, std::size_t alignment) {
+			EXPECT_EQ(std_dsp::cache_line_size, alignment);
+			outstanding += bytes;
+			++allocations;
+			return std_dsp::alloc_buf(bytes / sizeof(double));
+		}
+		void deallocate(void* p, std::size_t bytes, std::size_t) {
+			outstanding -= bytes;
+			std_dsp::free_buf(static_cast<double*>(p));
+		}
+	};
+
+	using counting_allocator = std_dsp::resource_allocator<counting_resource>;
+}
+
+TEST(ResourceAllocatorTest, StorageUsesResource) {
+
+	counting_resource r;
+	{
+		std_dsp::dynamic_storage<2, std_dsp::default_stride, counting_allocator> s(100, counting_allocator(&r));
+		EXPECT_EQ(1u, r.allocations);
+		EXPECT_EQ(s.physical_size() * sizeof(double), r.outstanding);
+
+		//Copies and moves keep the resource
+		auto t = s;
+		EXPECT_EQ(&r, t.get_allocator().get_resource());
+		EXPECT_EQ(2 * s.physical_size() * sizeof(double), r.outstanding);
+
+		auto u = std::move(t);
+		EXPECT_EQ(2u, r.allocations);
+
+		s.resize(1000);
+		EXPECT_EQ(3u, r.allocations);
+	}
+	EXPECT_EQ(0u, r.outstanding);
+
+	{
+		std_dsp::dynamic_storage<0, std_dsp::default_stride, counting_allocator> s(3, 10, counting_allocator(&r));
+		EXPECT_EQ(3 * s.stride() * sizeof(double), r.outstanding);
+	}
+	EXPECT_EQ(0u, r.outstanding);
+}
+
+TEST(ResourceAllocatorTest, Buffer) {
+
+	counting_resource r;
+	{
+		std_dsp::buffer_t<std_dsp::dynamic_storage<2, std_dsp::default_stride, counting_allocator>> b(64, counting_allocator(&r));
+		b.fill(1.0);
+		EXPECT_EQ(128.0, std_dsp::sum(b.cview()));
+		EXPECT_EQ(1u, r.allocations);
+	}
+	EXPECT_EQ(0u, r.outstanding);
+}
+
+#ifdef STD_DSP_HAS_PMR
+TEST(ResourceAllocatorTest, MonotonicResource) {
+
+	std::pmr::monotonic_buffer_resource arena(1 << 16);
+	std_dsp::pmr_storage<2> s(1000, std_dsp::pmr_allocator(&arena));
+	std_dsp::pmr_storage<2> t(1000, std_dsp::pmr_allocator(&arena));
+	EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(s.begin(1)) % std_dsp::cache_line_size);
+	EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(t.begin()) % std_dsp::cache_line_size);
+	std::fill(s.begin(1), s.end(1), 1.0);
+	EXPECT_TRUE(std_dsp::compare(s.begin(1), 1.0, 1000));
+
+	std_dsp::pmr_storage<1> d(10);
+	EXPECT_EQ(std::pmr::get_default_resource(), d.get_allocator().get_resource());
+}
+#endif
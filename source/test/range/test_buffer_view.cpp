@@ -0,0 +1,140 @@
+
+//Unit tests for buffer_view and the algorithms over views
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "../test_signals.h"
+
+#include "../../base/std_dsp_mem.h"
+#include "../../containers/buffer.h"
+#include "../../range/range.h"
+#include "../../range/view_algorithms.h"
+
+TEST(BufferViewTest, Slicing) {
+
+	std_dsp::dynamic_storage<2> s(100);
+	for(std_dsp::integer_t c = 0; c < 2; ++c)
+		for(std_dsp::integer_t i = 0; i < 100; ++i)
+			s.begin(c)[i] = 1000.0 * c + i;
+
+	std_dsp::buffer_view<double> v = std_dsp::make_view(s);
+	EXPECT_EQ(2, v.channels());
+	EXPECT_EQ(100, v.size());
+	EXPECT_TRUE(v.is_planar());
+	EXPECT_FALSE(v.is_contiguous());
+	EXPECT_EQ(1042.0, v(1, 42));
+
+	auto parts = v.split(30);
+	EXPECT_EQ(30, parts.first.size());
+	EXPECT_EQ(70, parts.second.size());
+	EXPECT_EQ(1030.0, parts.second(1, 0));
+	EXPECT_EQ(55.0, v.slice(50, 10)(0, 5));
+
+	std_dsp::buffer_view<double> rest = v;
+	std_dsp::buffer_view<double> head = rest.take_and_advance(10);
+	EXPECT_EQ(10, head.size());
+	EXPECT_EQ(90, rest.size());
+	EXPECT_EQ(10.0, rest(0, 0));
+
+	std_dsp::buffer_view<const double> r = v.channel(1);
+	EXPECT_EQ(1, r.channels());
+	EXPECT_EQ(1003.0, r(0, 3));
+
+	std::vector<double> frames(6);
+	auto iv = std_dsp::make_interleaved_view(frames.data(), 2, 3);
+	EXPECT_TRUE(iv.is_interleaved());
+	EXPECT_TRUE(iv.is_contiguous());
+	iv(1, 2) = 5.0;
+	EXPECT_EQ(5.0, frames[5]);
+	EXPECT_EQ(&frames[3], &iv.drop(1)(1, 0));
+}
+
+TEST(BufferViewTest, TransformsAcrossLayouts) {
+
+	const std_dsp::integer_t n = 600;
+	std_dsp::dynamic_storage<2> a(n);
+	std::vector<double> interleaved(2 * n);
+	for(std_dsp::integer_t i = 0; i < n; ++i) {
+		a.begin(0)[i] = std_dsp::test_signals::alternate_sign_increasing<double>(i);
+		a.begin(1)[i] = 0.5 * i;
+	}
+	auto av = std_dsp::make_view(a);
+	auto iv = std_dsp::make_interleaved_view(interleaved.data(), 2, n);
+
+	//Planar to interleaved is interleave
+	std_dsp::copy(std_dsp::buffer_view<const double>(av), iv);
+	EXPECT_TRUE(std_dsp::check_is_interleaving(a.begin(0), a.begin(1), n, interleaved.data()));
+
+	//Interleaved in place
+	std_dsp::multiply(iv, 2.0);
+	EXPECT_EQ(2.0 * a.begin(1)[7], iv(1, 7));
+
+	//Interleaved into planar through the gathered path, on an odd sub-range
+	std_dsp::dynamic_storage<2> b(n);
+	auto bv = std_dsp::make_view(b);
+	std_dsp::zero(bv);
+	std_dsp::abs(iv.slice(3, 400), bv.slice(3, 400));
+	for(std_dsp::integer_t c = 0; c < 2; ++c) {
+		EXPECT_EQ(0.0, bv(c, 2));
+		EXPECT_EQ(0.0, bv(c, 403));
+		for(std_dsp::integer_t i = 3; i < 403; ++i)
+			EXPECT_EQ(std::fabs(2.0 * av(c, i)), bv(c, i));
+	}
+
+	//Binary with mixed layouts, out += in * 0.5
+	std_dsp::multiply_add(iv, bv, 0.5);
+	EXPECT_NEAR(std::fabs(2.0 * av(0, 5)) + av(0, 5), bv(0, 5), 1e-12);
+	EXPECT_NEAR(av(1, 500), bv(1, 500), 1e-12);
+
+	//Reductions cover every channel
+	EXPECT_EQ(2.0 * std_dsp::max_abs_value(av), std_dsp::max_abs_value(iv));
+	EXPECT_NEAR(2.0 * 0.5 * (n - 1), std_dsp::max_value(iv.channel(1)), 1e-12);
+	EXPECT_NEAR(2.0 * std_dsp::sum(a.begin(0), n) + 2.0 * std_dsp::sum(a.begin(1), n), std_dsp::sum(iv), 1e-9);
+	EXPECT_NEAR(std_dsp::sum(av), std_dsp::sum(a.begin(0), n) + std_dsp::sum(a.begin(1), n), 1e-9);
+}
+
+TEST(BufferViewTest, StereoTransforms) {
+
+	const std_dsp::integer_t n = 300;
+	std_dsp::dynamic_storage<2> a(n);
+	for(std_dsp::integer_t i = 0; i < n; ++i) {
+		a.begin(0)[i] = 1.0 + i;
+		a.begin(1)[i] = -2.0 * i;
+	}
+	auto av = std_dsp::make_view(a);
+
+	//Planar
+	std_dsp::dynamic_storage<2> b(n);
+	std_dsp::swap_channels(av, std_dsp::make_view(b));
+	EXPECT_EQ(a.begin(1)[10], b.begin(0)[10]);
+	EXPECT_EQ(a.begin(0)[10], b.begin(1)[10]);
+
+	//Planar into interleaved
+	std::vector<double> x(2 * n);
+	auto xv = std_dsp::make_interleaved_view(x.data(), 2, n);
+	std_dsp::mid_side(av, xv);
+
+	//Interleaved in place, back again
+	std_dsp::mid_side_inv(xv, xv);
+
+	//Interleaved into planar
+	std_dsp::dynamic_storage<2> c(n);
+	std_dsp::copy(xv, std_dsp::make_view(c));
+	EXPECT_TRUE(std_dsp::compare(c.begin(0), a.begin(0), n, 1e-9));
+	EXPECT_TRUE(std_dsp::compare(c.begin(1), a.begin(1), n, 1e-9));
+}
+
+TEST(BufferViewTest, BufferUtilities) {
+
+	std_dsp::buffer<3> b(37);
+	b.fill(2.0);
+	EXPECT_EQ(3, b.view().channels());
+	EXPECT_EQ(2.0 * 3 * 37, std_dsp::sum(b.cview()));
+
+	b.clear(10);
+	EXPECT_EQ(2.0 * 3 * 27, std_dsp::sum(b.cview()));
+	EXPECT_EQ(0.0, std_dsp::max_value(b.cview().take(10)));
+}
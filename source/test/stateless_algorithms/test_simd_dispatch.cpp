@@ -0,0 +1,367 @@
+
+//Unit tests for the runtime instruction set dispatch of the mono algorithms
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "../test_signals.h"
+
+#include "../../base/std_dsp_mem.h"
+#include "../../base/std_dsp_cpu_features.h"
+#include "../../base/std_dsp_simd_kernel.h"
+#include "../../stateless_algorithms/mono.h"
+
+namespace {
+	//Counts chosen to exercise the unrolled bodies, single vectors and the (masked) tails
+	const std_dsp::integer_t COUNTS[] = { 1, 7, 8, 16, 33, 45, 255, 256 };
+
+	using std_dsp::test_signals::available_levels;
+	using std_dsp::test_signals::simd_level_scope;
+}
+
+TEST(SimdDispatchTest, LevelOrdering) {
+
+	EXPECT_LE(static_cast<int>(std_dsp::active_simd_level()), static_cast<int>(std_dsp::max_simd_level()));
+
+	const std_dsp::simd_level before = std_dsp::active_simd_level();
+	{
+		simd_level_scope scope(std_dsp::simd_level::sse2);
+		EXPECT_EQ(std_dsp::simd_level::sse2, std_dsp::active_simd_level());
+		{
+			simd_level_scope inner(std_dsp::max_simd_level());
+			EXPECT_EQ(std_dsp::max_simd_level(), std_dsp::active_simd_level());
+		}
+		//Scopes nest, the inner one puts back the outer level
+		EXPECT_EQ(std_dsp::simd_level::sse2, std_dsp::active_simd_level());
+	}
+
+	EXPECT_EQ(before, std_dsp::active_simd_level());
+
+}
+
+TEST(SimdDispatchTest, Reductions) {
+
+	const std_dsp::integer_t SIZE = 256;
+	std_dsp::static_storage<1, SIZE> buf;
+
+	for (std_dsp::integer_t i = 0; i < SIZE; ++i)
+		buf.begin(0)[i] = std_dsp::test_signals::alternate_sign_increasing<double>(i) / SIZE;
+
+	for (auto level : available_levels()) {
+		simd_level_scope scope(level);
+
+		for (auto n : COUNTS) {
+			const double* first = buf.begin(0);
+
+			double ref_sum = 0.0;
+			double ref_min = first[0];
+			double ref_max_abs = 0.0;
+			for (std_dsp::integer_t i = 0; i < n; ++i) {
+				ref_sum += first[i];
+				ref_min = (std::min)(ref_min, first[i]);
+				ref_max_abs = (std::max)(ref_max_abs, fabs(first[i]));
+			}
+
+			EXPECT_NEAR(ref_sum, std_dsp::sum(first, n), 0.000001);
+			EXPECT_EQ(ref_min, std_dsp::min_value(first, n));
+			EXPECT_EQ(ref_max_abs, std_dsp::max_abs_value(first, n));
+
+			//Odd aligned start
+			if (n > 1) {
+				EXPECT_NEAR(ref_sum - first[0], std_dsp::sum(first + 1, n - 1), 0.000001);
+			}
+		}
+	}
+
+}
+
+TEST(SimdDispatchTest, Transforms) {
+
+	const std_dsp::integer_t SIZE = 256;
+	std_dsp::static_storage<4, SIZE> buf;
+
+	for (std_dsp::integer_t i = 0; i < SIZE; ++i) {
+		buf.begin(0)[i] = std_dsp::test_signals::sine<double>(64, i, 1.0);
+		buf.begin(1)[i] = std_dsp::test_signals::alternate_sign_increasing<double>(i) / SIZE;
+	}
+
+	for (auto level : available_levels()) {
+		simd_level_scope scope(level);
+
+		for (auto n : COUNTS) {
+			const double* x = buf.begin(0);
+			const double* y = buf.begin(1);
+			double* out = buf.begin(2);
+			double* acc = buf.begin(3);
+
+			std_dsp::add(x, y, n, out);
+			for (std_dsp::integer_t i = 0; i < n; ++i)
+				EXPECT_NEAR(x[i] + y[i], out[i], 0.000001);
+
+			std_dsp::linear_combination(x, y, n, out, 0.25, 0.75);
+			for (std_dsp::integer_t i = 0; i < n; ++i)
+				EXPECT_NEAR(0.25 * x[i] + 0.75 * y[i], out[i], 0.000001);
+
+			std_dsp::copy(x, n, acc);
+			std_dsp::multiply_add(x, y, n, acc);
+			for (std_dsp::integer_t i = 0; i < n; ++i)
+				EXPECT_NEAR(x[i] + x[i] * y[i], acc[i], 0.000001);
+
+			std_dsp::multiply(y, n, out, -2.0);
+			for (std_dsp::integer_t i = 0; i < n; ++i)
+				EXPECT_NEAR(-2.0 * y[i], out[i], 0.000001);
+
+			std_dsp::clip(x, n, out, -0.5, 0.5);
+			for (std_dsp::integer_t i = 0; i < n; ++i)
+				EXPECT_NEAR((std::max)(-0.5, (std::min)(0.5, x[i])), out[i], 0.000001);
+		}
+	}
+
+}
+
+TEST(SimdDispatchTest, KernelUnrollFactors) {
+
+	const std_dsp::integer_t SIZE = 256;
+	std_dsp::static_storage<3, SIZE> buf;
+
+	for (std_dsp::integer_t i = 0; i < SIZE; ++i) {
+		buf.begin(0)[i] = std_dsp::test_signals::sine<double>(64, i, 1.0);
+		buf.begin(1)[i] = std_dsp::test_signals::alternate_sign_increasing<double>(i) / SIZE;
+	}
+
+	using kernel1 = std_dsp::simd_kernel<std_dsp::double2_t, 1>;
+	using kernel3 = std_dsp::simd_kernel<std_dsp::double2_t, 3>;
+
+	for (auto n : COUNTS) {
+		//Odd offsets, the unaligned kernels accept any position
+		const double* x = buf.begin(0) + 1;
+		const double* y = buf.begin(1) + 1;
+		double* out = buf.begin(2) + 1;
+		if (n > SIZE - 1)
+			n = SIZE - 1;
+
+		std_dsp::add_op op;
+		const std_dsp::integer_t n1 = kernel1::transform(x, y, n, out, op);
+		EXPECT_EQ(n & ~std_dsp::integer_t(1), n1);
+		for (std_dsp::integer_t i = 0; i < n1; ++i)
+			EXPECT_EQ(x[i] + y[i], out[i]);
+
+		std::fill(buf.begin(2), buf.end(2), 0.0);
+		const std_dsp::integer_t n3 = kernel3::transform(x, y, n, out, op);
+		EXPECT_EQ(n1, n3);
+		for (std_dsp::integer_t i = 0; i < n3; ++i)
+			EXPECT_EQ(x[i] + y[i], out[i]);
+		EXPECT_EQ(0.0, out[n3]);
+	}
+
+}
+
+TEST(SimdDispatchTest, ArbitraryOffsets) {
+
+	const std_dsp::integer_t SIZE = 256;
+	std::vector<double> x(SIZE + 8);
+	std::vector<double> y(SIZE + 8);
+	std::vector<double> out(SIZE + 8);
+	std::vector<float> xf(SIZE + 8);
+	std::vector<float> outf(SIZE + 8);
+
+	for (std_dsp::integer_t i = 0; i < SIZE + 8; ++i) {
+		x[i] = std_dsp::test_signals::sine<double>(64, i, 1.0);
+		y[i] = std_dsp::test_signals::alternate_sign_increasing<double>(i) / SIZE;
+		xf[i] = static_cast<float>(x[i]);
+	}
+
+	//Input and output offsets that leave the inputs matching and mismatching the output alignment
+	const int OFFSETS[][3] = { { 0, 0, 0 }, { 1, 1, 1 }, { 0, 1, 0 }, { 1, 0, 3 }, { 3, 5, 7 }, { 2, 6, 1 } };
+
+	for (auto level : available_levels()) {
+		simd_level_scope scope(level);
+
+		for (auto n : COUNTS) {
+			for (const auto& offset : OFFSETS) {
+				const double* x0 = x.data() + offset[0];
+				const double* y0 = y.data() + offset[1];
+				double* out0 = out.data() + offset[2];
+
+				std_dsp::add(x0, y0, n, out0);
+				for (std_dsp::integer_t i = 0; i < n; ++i)
+					EXPECT_EQ(x0[i] + y0[i], out0[i]);
+
+				std_dsp::copy(y0, n, out0);
+				std_dsp::multiply_add(x0, y0, n, out0);
+				for (std_dsp::integer_t i = 0; i < n; ++i)
+					EXPECT_NEAR(y0[i] + x0[i] * y0[i], out0[i], 0.000001);
+
+				std_dsp::multiply(x0, n, out0, 0.5);
+				for (std_dsp::integer_t i = 0; i < n; ++i)
+					EXPECT_EQ(0.5 * x0[i], out0[i]);
+
+				std_dsp::multiply(out0, n, 2.0);
+				for (std_dsp::integer_t i = 0; i < n; ++i)
+					EXPECT_EQ(x0[i], out0[i]);
+
+				double ref_sum = 0.0;
+				for (std_dsp::integer_t i = 0; i < n; ++i)
+					ref_sum += x0[i];
+				EXPECT_NEAR(ref_sum, std_dsp::sum(x0, n), 0.000001);
+
+				std_dsp::assign(n, out0, 2.0);
+				EXPECT_TRUE(std_dsp::compare(out0, 2.0, n));
+
+				const float* xf0 = xf.data() + offset[0];
+				float* outf0 = outf.data() + offset[2];
+
+				std_dsp::multiply(xf0, n, outf0, 0.5);
+				for (std_dsp::integer_t i = 0; i < n; ++i)
+					EXPECT_FLOAT_EQ(0.5f * xf0[i], outf0[i]);
+
+				double ref_sumf = 0.0;
+				for (std_dsp::integer_t i = 0; i < n; ++i)
+					ref_sumf += xf0[i];
+				EXPECT_NEAR(ref_sumf, std_dsp::sum(xf0, n), 0.00001);
+
+				std_dsp::copy(xf0, n, outf0);
+				std_dsp::clip_with_indicator(outf0, n, 0.5);
+				for (std_dsp::integer_t i = 0; i < n; ++i)
+					EXPECT_FLOAT_EQ((std::max)(-0.5f, (std::min)(0.5f, xf0[i])), outf0[i]);
+			}
+		}
+	}
+
+}
+
+TEST(SimdDispatchTest, Generators) {
+
+	const std_dsp::integer_t SIZE = 256;
+	std_dsp::static_storage<1, SIZE> buf;
+
+	for (auto level : available_levels()) {
+		simd_level_scope scope(level);
+
+		for (auto n : COUNTS) {
+			std::fill(buf.begin(0), buf.end(0), -1.0);
+
+			std_dsp::assign(n, buf.begin(0), 3.0);
+			EXPECT_TRUE(std_dsp::compare(buf.begin(0), 3.0, n));
+			EXPECT_TRUE(std_dsp::compare(buf.begin(0) + n, -1.0, SIZE - n));
+
+			std_dsp::randomize(n, buf.begin(0), -0.5, 0.5);
+			EXPECT_LE(std_dsp::max_abs_value(buf.begin(0), n), 0.5);
+		}
+	}
+
+}
+
+TEST(SimdDispatchTest, FloatReductions) {
+
+	const std_dsp::integer_t SIZE = 256;
+	std::vector<float> buf(SIZE + 1);
+
+	for (std_dsp::integer_t i = 0; i <= SIZE; ++i)
+		buf[i] = std_dsp::test_signals::alternate_sign_increasing<float>(i) / SIZE;
+
+	for (auto level : available_levels()) {
+		simd_level_scope scope(level);
+
+		for (auto n : COUNTS) {
+			//Offset by one float, the float kernels use unaligned loads
+			const float* first = buf.data() + 1;
+
+			double ref_sum = 0.0;
+			double ref_min = first[0];
+			double ref_max_abs = 0.0;
+			for (std_dsp::integer_t i = 0; i < n; ++i) {
+				ref_sum += first[i];
+				ref_min = (std::min)(ref_min, static_cast<double>(first[i]));
+				ref_max_abs = (std::max)(ref_max_abs, static_cast<double>(fabs(first[i])));
+			}
+
+			EXPECT_NEAR(ref_sum, std_dsp::sum(first, n), 0.000001);
+			EXPECT_EQ(ref_min, std_dsp::min_value(first, n));
+			EXPECT_EQ(ref_max_abs, std_dsp::max_abs_value(first, n));
+		}
+	}
+
+}
+
+TEST(SimdDispatchTest, FloatTransforms) {
+
+	const std_dsp::integer_t SIZE = 256;
+	std::vector<float> x(SIZE);
+	std::vector<float> y(SIZE);
+	std::vector<float> out(SIZE);
+	std::vector<float> acc(SIZE);
+
+	for (std_dsp::integer_t i = 0; i < SIZE; ++i) {
+		x[i] = std_dsp::test_signals::sine<float>(64, i, 1.0);
+		y[i] = std_dsp::test_signals::alternate_sign_increasing<float>(i) / SIZE;
+	}
+
+	for (auto level : available_levels()) {
+		simd_level_scope scope(level);
+
+		for (auto n : COUNTS) {
+			std_dsp::add(x.data(), y.data(), n, out.data());
+			for (std_dsp::integer_t i = 0; i < n; ++i)
+				EXPECT_FLOAT_EQ(x[i] + y[i], out[i]);
+
+			std_dsp::linear_combination(x.data(), y.data(), n, out.data(), 0.25, 0.75);
+			for (std_dsp::integer_t i = 0; i < n; ++i)
+				EXPECT_NEAR(0.25f * x[i] + 0.75f * y[i], out[i], 0.00001);
+
+			std_dsp::copy(x.data(), n, acc.data());
+			std_dsp::multiply_add(x.data(), y.data(), n, acc.data());
+			for (std_dsp::integer_t i = 0; i < n; ++i)
+				EXPECT_NEAR(x[i] + x[i] * y[i], acc[i], 0.00001);
+
+			std_dsp::copy(x.data(), n, acc.data());
+			std_dsp::linear_combination_add(x.data(), y.data(), n, acc.data(), 0.5, -1.0);
+			for (std_dsp::integer_t i = 0; i < n; ++i)
+				EXPECT_NEAR(1.5f * x[i] - y[i], acc[i], 0.00001);
+
+			std_dsp::multiply(y.data(), n, out.data(), -2.0);
+			for (std_dsp::integer_t i = 0; i < n; ++i)
+				EXPECT_FLOAT_EQ(-2.0f * y[i], out[i]);
+
+			std_dsp::copy(x.data(), n, out.data());
+			std_dsp::clip(out.data(), n, -0.5, 0.5);
+			for (std_dsp::integer_t i = 0; i < n; ++i)
+				EXPECT_FLOAT_EQ((std::max)(-0.5f, (std::min)(0.5f, x[i])), out[i]);
+
+			std_dsp::copy(x.data(), n, out.data());
+			const bool clipped = std_dsp::clip_with_indicator(out.data(), n, 0.5);
+			bool ref_clipped = false;
+			for (std_dsp::integer_t i = 0; i < n; ++i)
+				ref_clipped = ref_clipped || fabs(x[i]) >= 0.5f;
+			EXPECT_EQ(ref_clipped, clipped);
+			EXPECT_LE(std_dsp::max_abs_value(out.data(), n), 0.5);
+		}
+	}
+
+}
+
+TEST(SimdDispatchTest, FloatGenerators) {
+
+	const std_dsp::integer_t SIZE = 256;
+	std::vector<float> buf(SIZE);
+
+	for (auto level : available_levels()) {
+		simd_level_scope scope(level);
+
+		for (auto n : COUNTS) {
+			std::fill(buf.begin(), buf.end(), -1.0f);
+
+			std_dsp::assign(n, buf.data(), 3.0);
+			EXPECT_EQ(n, std::count(buf.begin(), buf.begin() + n, 3.0f));
+			EXPECT_EQ(SIZE - n, std::count(buf.begin() + n, buf.end(), -1.0f));
+
+			std_dsp::randomize(n, buf.data(), -0.5, 0.5);
+			EXPECT_LE(std_dsp::max_abs_value(buf.data(), n), 0.5);
+		}
+	}
+
+}
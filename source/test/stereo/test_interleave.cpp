@@ -5,6 +5,7 @@
 
 #include <array>
 #include <cstdint>
+#include <vector>
 
 #include "../test_signals.h"
 
@@ -71,7 +72,7 @@ TEST(InterleaveTest, InterleaveAlignedDoubles) {
 	std_dsp::static_storage<2, 1023> a;
 	std_dsp::static_storage<2, 1023> b;
 
-	for (std::size_t i = 0; i < 1023; ++i) {
+	for (std::size_t i = 0; i < 2 * 1023; ++i) {
 		*(a.begin() + i) = std_dsp::test_signals::alternate_sign_increasing<double>(i);
 	}
 
@@ -95,6 +96,39 @@ TEST(InterleaveTest, InterleaveAlignedDoubles) {
 
 }
 
+TEST(InterleaveTest, InterleaveFloats) {
+
+	std::vector<float> a(2 * 1023 + 1);
+	std::vector<float> b(2 * 1023 + 1);
+
+	for (std::size_t i = 0; i < a.size(); ++i) {
+		a[i] = std_dsp::test_signals::alternate_sign_increasing<float>(i);
+	}
+
+	std_dsp::interleave(a.data(), a.data() + 1023, 1023, b.data());
+
+	EXPECT_TRUE(std_dsp::check_is_interleaving(a.data(), a.data() + 1023, 1023, b.data()));
+
+	std::fill(a.begin(), a.end(), -1.0f);
+
+	std_dsp::deinterleave(b.data(), 1023, a.data(), a.data() + 1023);
+
+	EXPECT_TRUE(std_dsp::check_is_interleaving(a.data(), a.data() + 1023, 1023, b.data()));
+
+	std::fill(b.begin(), b.end(), -1.0f);
+
+	//The float kernels use unaligned accesses, so any offset goes
+
+	std_dsp::interleave(a.data() + 1, a.data() + 1023, 1022, b.data() + 3);
+
+	EXPECT_TRUE(std_dsp::check_is_interleaving(a.data() + 1, a.data() + 1023, 1022, b.data() + 3));
+
+	std_dsp::deinterleave(b.data() + 3, 1022, a.data() + 2, a.data() + 1025);
+
+	EXPECT_TRUE(std_dsp::check_is_interleaving(a.data() + 2, a.data() + 1025, 1022, b.data() + 3));
+
+}
+
 TEST(InterleaveTest, InterleaveInplace) {
 
 	std::array<int, 8> a = { 1, 2, 3, 4, 5, 6, 7, 8 }; //Input
@@ -116,3 +150,26 @@ TEST(InterleaveTest, InterleaveInplace) {
 	}
 
 }
+
+TEST(InterleaveTest, InterleaveMismatchedOffsets) {
+
+	const std::size_t SIZE = 37;
+	std::vector<double> a(SIZE + 1);
+	std::vector<double> b(SIZE + 1);
+	std::vector<double> c(2 * SIZE + 1);
+
+	for (std::size_t i = 0; i < SIZE + 1; ++i) {
+		a[i] = std_dsp::test_signals::alternate_sign_increasing<double>(i);
+		b[i] = -std_dsp::test_signals::alternate_sign_increasing<double>(i);
+	}
+
+	//Odd input offset, even output offset
+	std_dsp::interleave(a.data() + 1, b.data(), SIZE, c.data());
+	EXPECT_TRUE(std_dsp::check_is_interleaving(a.data() + 1, b.data(), SIZE, c.data()));
+
+	std::fill(a.begin(), a.end(), 0.0);
+	std::fill(b.begin(), b.end(), 0.0);
+	std_dsp::deinterleave(c.data() + 1, SIZE - 1, a.data(), b.data() + 1);
+	EXPECT_TRUE(std_dsp::check_is_interleaving(a.data(), b.data() + 1, SIZE - 1, c.data() + 1));
+
+}
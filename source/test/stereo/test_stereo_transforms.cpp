@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <array>
 #include <cstdint>
+#include <vector>
 
 #include "../test_signals.h"
 
@@ -112,3 +113,147 @@ TEST(StereoTransformsTest, MonoInterleaved) {
 	EXPECT_TRUE(std_dsp::compare_interleaved(buf, ref_buf));
 
 }
+
+TEST(StereoTransformsTest, MidSideInterleaved) {
+
+	const std_dsp::integer_t COUNT = 255;
+
+	std_dsp::static_storage<2, COUNT> buf;
+
+	auto buf_it = buf.begin();
+
+	for (std_dsp::integer_t i = 0; i < COUNT; ++i) {
+		*buf_it = 3.0;
+		++buf_it;
+		*buf_it = 1.0;
+		++buf_it;
+	}
+
+	std_dsp::mid_side(buf.begin(), COUNT, buf.begin());
+
+	for (std_dsp::integer_t i = 0; i < COUNT; ++i) {
+		EXPECT_EQ(4.0, buf.begin()[2 * i]);
+		EXPECT_EQ(2.0, buf.begin()[2 * i + 1]);
+	}
+
+	std_dsp::mid_side_inv(buf.begin(), COUNT, buf.begin());
+
+	for (std_dsp::integer_t i = 0; i < COUNT; ++i) {
+		EXPECT_EQ(3.0, buf.begin()[2 * i]);
+		EXPECT_EQ(1.0, buf.begin()[2 * i + 1]);
+	}
+
+}
+
+TEST(StereoTransformsTest, FloatSplit) {
+
+	const std_dsp::integer_t COUNT = 255;
+
+	std::vector<float> left(COUNT);
+	std::vector<float> right(COUNT);
+
+	for (std_dsp::integer_t i = 0; i < COUNT; ++i) {
+		left[i] = 0.0f - i;
+		right[i] = 1.0f + i;
+	}
+
+	std_dsp::swap_channels(left.data(), right.data(), COUNT, left.data(), right.data());
+
+	for (std_dsp::integer_t i = 0; i < COUNT; ++i) {
+		EXPECT_EQ(1.0f + i, left[i]);
+		EXPECT_EQ(0.0f - i, right[i]);
+	}
+
+	std_dsp::mid_side(left.data(), right.data(), COUNT, left.data(), right.data());
+
+	for (std_dsp::integer_t i = 0; i < COUNT; ++i) {
+		EXPECT_EQ(1.0f, left[i]);
+		EXPECT_EQ(1.0f + 2.0f * i, right[i]);
+	}
+
+	std_dsp::mono(left.data(), right.data(), COUNT, left.data(), right.data());
+
+	for (std_dsp::integer_t i = 0; i < COUNT; ++i) {
+		EXPECT_EQ(1.0f + i, left[i]);
+		EXPECT_EQ(1.0f + i, right[i]);
+	}
+
+}
+
+TEST(StereoTransformsTest, FloatInterleaved) {
+
+	const std_dsp::integer_t COUNT = 255;
+
+	//Odd offset, the float kernels do not depend on the alignment
+	std::vector<float> buf(2 * COUNT + 1);
+	float* first = buf.data() + 1;
+
+	for (std_dsp::integer_t i = 0; i < COUNT; ++i) {
+		first[2 * i] = 3.0f + i;
+		first[2 * i + 1] = 1.0f;
+	}
+
+	std_dsp::swap_channels(first, COUNT, first);
+
+	for (std_dsp::integer_t i = 0; i < COUNT; ++i) {
+		EXPECT_EQ(1.0f, first[2 * i]);
+		EXPECT_EQ(3.0f + i, first[2 * i + 1]);
+	}
+
+	std_dsp::mid_side_inv(first, COUNT, first);
+
+	for (std_dsp::integer_t i = 0; i < COUNT; ++i) {
+		EXPECT_EQ(0.5f * (4.0f + i), first[2 * i]);
+		EXPECT_EQ(0.5f * (-2.0f - i), first[2 * i + 1]);
+	}
+
+	std_dsp::mid_side(first, COUNT, first);
+
+	for (std_dsp::integer_t i = 0; i < COUNT; ++i) {
+		EXPECT_EQ(1.0f, first[2 * i]);
+		EXPECT_EQ(3.0f + i, first[2 * i + 1]);
+	}
+
+	std_dsp::duplicate_right(first, COUNT, first);
+
+	for (std_dsp::integer_t i = 0; i < COUNT; ++i) {
+		EXPECT_EQ(3.0f + i, first[2 * i]);
+		EXPECT_EQ(3.0f + i, first[2 * i + 1]);
+	}
+
+}
+
+TEST(StereoTransformsTest, OddOffsetDoubles) {
+
+	const std_dsp::integer_t COUNT = 255;
+
+	//The channels and the interleaved frames start at odd element offsets
+	std::vector<double> left(COUNT + 1);
+	std::vector<double> right(COUNT + 2);
+	std::vector<double> frames(2 * COUNT + 1);
+	double* l = left.data() + 1;
+	double* r = right.data() + 2;
+	double* f = frames.data() + 1;
+
+	for (std_dsp::integer_t i = 0; i < COUNT; ++i) {
+		l[i] = 0.0 - i;
+		r[i] = 1.0 + i;
+		f[2 * i] = 3.0 + i;
+		f[2 * i + 1] = 1.0;
+	}
+
+	std_dsp::swap_channels(l, r, COUNT, l, r);
+
+	for (std_dsp::integer_t i = 0; i < COUNT; ++i) {
+		EXPECT_EQ(1.0 + i, l[i]);
+		EXPECT_EQ(0.0 - i, r[i]);
+	}
+
+	std_dsp::swap_channels(f, COUNT, f);
+
+	for (std_dsp::integer_t i = 0; i < COUNT; ++i) {
+		EXPECT_EQ(1.0, f[2 * i]);
+		EXPECT_EQ(3.0 + i, f[2 * i + 1]);
+	}
+
+}
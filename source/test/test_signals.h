@@ -4,6 +4,9 @@
 
 #include <cstdint>
 #include <cmath>
+#include <vector>
+
+#include "../base/std_dsp_cpu_features.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -53,6 +56,31 @@ namespace std_dsp {
 				sin((x / static_cast<double>(period)) * rad_2_pi)
 			);
 		}
+
+		//Every instruction set level this machine can run, narrowest first
+		inline
+		std::vector<simd_level> available_levels() {
+			std::vector<simd_level> levels;
+			for(int i = 0; i <= static_cast<int>(max_simd_level()); ++i)
+				levels.push_back(static_cast<simd_level>(i));
+			return levels;
+		}
+
+		//Runs a scope at the given level and puts the previous one back on exit
+		class simd_level_scope {
+		private:
+			simd_level previous;
+		public:
+			explicit simd_level_scope(simd_level level) : previous(active_simd_level()) {
+				set_simd_level(level);
+			}
+			~simd_level_scope() {
+				set_simd_level(previous);
+			}
+
+			simd_level_scope(const simd_level_scope&) = delete;
+			simd_level_scope& operator=(const simd_level_scope&) = delete;
+		};
 	}
 }
 